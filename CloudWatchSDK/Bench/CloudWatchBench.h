@@ -0,0 +1,132 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+/** Shortest time a single threaded case runs, in seconds. Scaled by the first command line argument. */
+static double BenchMinSeconds = 0.25;
+
+inline void InitBench(int argc, char** argv)
+{
+	if (argc > 1)
+	{
+		BenchMinSeconds *= std::atof(argv[1]);
+	}
+}
+
+/** Keeps the compiler from dropping work whose result is otherwise unused. */
+static volatile uint8 BenchSink = 0;
+
+inline void KeepResult(const void* Data)
+{
+	BenchSink ^= *static_cast<const volatile uint8*>(Data);
+}
+
+inline double SecondsSince(std::chrono::steady_clock::time_point Start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+}
+
+/**
+* Calls Body in batches until BenchMinSeconds passed, three times over.
+* @return [double] Nanoseconds per call of the fastest round, the one least disturbed by other processes.
+**/
+template<typename TBody>
+inline double MeasureNs(TBody&& Body)
+{
+	// warm up caches and the lazy CPU feature dispatch
+	Body();
+
+	double BestNs = 0.0;
+	for (int32 Round = 0; Round < 3; ++Round)
+	{
+		int64 Calls = 0;
+		int64 Batch = 1;
+		const auto Start = std::chrono::steady_clock::now();
+		double Elapsed = 0.0;
+		do
+		{
+			for (int64 Index = 0; Index < Batch; ++Index)
+			{
+				Body();
+			}
+			Calls += Batch;
+			Batch *= 2;
+			Elapsed = SecondsSince(Start);
+		} while (Elapsed < BenchMinSeconds / 3);
+
+		const double Ns = Elapsed * 1e9 / static_cast<double>(Calls);
+		BestNs = Round == 0 ? Ns : FMath::Min(BestNs, Ns);
+	}
+	return BestNs;
+}
+
+/**
+* Starts Threads threads at once, each calling Body(ThreadIndex) Iterations times.
+* @return [double] Calls per second over all threads.
+**/
+template<typename TBody>
+inline double MeasureThreads(int32 Threads, int64 Iterations, TBody&& Body)
+{
+	std::atomic<int32> Ready(0);
+	std::atomic<bool> bGo(false);
+	std::vector<std::thread> Workers;
+	for (int32 ThreadIndex = 0; ThreadIndex < Threads; ++ThreadIndex)
+	{
+		Workers.emplace_back([&, ThreadIndex]()
+		{
+			Ready.fetch_add(1);
+			while (!bGo.load())
+			{
+				std::this_thread::yield();
+			}
+			for (int64 Index = 0; Index < Iterations; ++Index)
+			{
+				Body(ThreadIndex);
+			}
+		});
+	}
+	while (Ready.load() < Threads)
+	{
+		std::this_thread::yield();
+	}
+
+	const auto Start = std::chrono::steady_clock::now();
+	bGo.store(true);
+	for (std::thread& Worker : Workers)
+	{
+		Worker.join();
+	}
+	return static_cast<double>(Threads) * static_cast<double>(Iterations) / SecondsSince(Start);
+}
+
+/** Thread counts of the contended cases: 1, 2, 4, ... up to twice the hardware threads, or MinMaxThreads if that is more. */
+inline std::vector<int32> GetBenchThreadCounts(int32 MinMaxThreads = 1)
+{
+	const int32 MaxThreads = FMath::Max(MinMaxThreads, 2 * FMath::Max(1, static_cast<int32>(std::thread::hardware_concurrency())));
+	std::vector<int32> Counts;
+	for (int32 Threads = 1; Threads <= MaxThreads; Threads *= 2)
+	{
+		Counts.push_back(Threads);
+	}
+	return Counts;
+}
@@ -0,0 +1,170 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#include "CloudWatchBench.h"
+#include "CloudWatchEncoding.h"
+
+#include <aws/core/utils/memory/stl/AWSString.h>
+
+#include <cstring>
+#include <vector>
+
+// Baselines with the loops of Aws::Utils::HashingUtils and Aws::Utils::Base64, a byte at a time into a new string.
+
+static Aws::String ScalarHexEncode(const uint8* Data, size_t Length)
+{
+	static const char Digits[] = "0123456789abcdef";
+	Aws::String Encoded;
+	Encoded.reserve(2 * Length);
+	for (size_t Index = 0; Index < Length; ++Index)
+	{
+		Encoded.push_back(Digits[Data[Index] >> 4]);
+		Encoded.push_back(Digits[Data[Index] & 0x0f]);
+	}
+	return Encoded;
+}
+
+static int32 HexDigitValue(char Digit)
+{
+	if (Digit >= '0' && Digit <= '9') return Digit - '0';
+	if (Digit >= 'a' && Digit <= 'f') return Digit - 'a' + 10;
+	if (Digit >= 'A' && Digit <= 'F') return Digit - 'A' + 10;
+	return -1;
+}
+
+static std::vector<uint8> ScalarHexDecode(const char* Hex, size_t Length)
+{
+	std::vector<uint8> Decoded(Length / 2);
+	for (size_t Index = 0; Index + 1 < Length; Index += 2)
+	{
+		Decoded[Index / 2] = static_cast<uint8>(HexDigitValue(Hex[Index]) << 4 | HexDigitValue(Hex[Index + 1]));
+	}
+	return Decoded;
+}
+
+static const char Base64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static Aws::String ScalarBase64Encode(const uint8* Data, size_t Length)
+{
+	Aws::String Encoded;
+	Encoded.reserve(FCloudWatchEncoding::Base64EncodedLength(Length));
+	size_t Index = 0;
+	for (; Index + 2 < Length; Index += 3)
+	{
+		const uint32 Group = Data[Index] << 16 | Data[Index + 1] << 8 | Data[Index + 2];
+		Encoded.push_back(Base64Alphabet[Group >> 18 & 0x3f]);
+		Encoded.push_back(Base64Alphabet[Group >> 12 & 0x3f]);
+		Encoded.push_back(Base64Alphabet[Group >> 6 & 0x3f]);
+		Encoded.push_back(Base64Alphabet[Group & 0x3f]);
+	}
+	if (Index < Length)
+	{
+		const uint32 Group = Data[Index] << 16 | (Index + 1 < Length ? Data[Index + 1] << 8 : 0);
+		Encoded.push_back(Base64Alphabet[Group >> 18 & 0x3f]);
+		Encoded.push_back(Base64Alphabet[Group >> 12 & 0x3f]);
+		Encoded.push_back(Index + 1 < Length ? Base64Alphabet[Group >> 6 & 0x3f] : '=');
+		Encoded.push_back('=');
+	}
+	return Encoded;
+}
+
+static std::vector<uint8> ScalarBase64Decode(const char* Text, size_t Length)
+{
+	static const std::vector<uint8> Values = []()
+	{
+		std::vector<uint8> Table(256, 0);
+		for (int32 Index = 0; Index < 64; ++Index)
+		{
+			Table[static_cast<uint8>(Base64Alphabet[Index])] = static_cast<uint8>(Index);
+		}
+		return Table;
+	}();
+
+	std::vector<uint8> Decoded;
+	Decoded.reserve(Length / 4 * 3);
+	uint32 Group = 0;
+	int32 Bits = 0;
+	for (size_t Index = 0; Index < Length && Text[Index] != '='; ++Index)
+	{
+		Group = Group << 6 | Values[static_cast<uint8>(Text[Index])];
+		Bits += 6;
+		if (Bits >= 8)
+		{
+			Bits -= 8;
+			Decoded.push_back(static_cast<uint8>(Group >> Bits));
+		}
+	}
+	return Decoded;
+}
+
+static void Report(const char* Name, size_t Length, double BaselineNs, double Ns)
+{
+	const double GigabytesPerSecond = static_cast<double>(Length) / Ns;
+	printf("%-16s %8zu B %10.1f ns %8.2f GB/s", Name, Length, Ns, GigabytesPerSecond);
+	if (BaselineNs > 0.0)
+	{
+		printf("  %6.1fx scalar", BaselineNs / Ns);
+	}
+	printf("\n");
+}
+
+int main(int argc, char** argv)
+{
+	InitBench(argc, argv);
+	printf("FCloudWatchEncoding: %s\n", FCloudWatchEncoding::GetImplementationName());
+
+	// a SigV4 digest, a typical PutLogEvents body and two large payloads
+	const size_t Lengths[] = { 32, 1024, 64 * 1024, 1024 * 1024 };
+	for (size_t Length : Lengths)
+	{
+		std::vector<uint8> Data(Length);
+		for (size_t Index = 0; Index < Length; ++Index)
+		{
+			Data[Index] = static_cast<uint8>(Index * 131 + 7);
+		}
+
+		Aws::String Hex;
+		FCloudWatchEncoding::HexEncode(Data.data(), Length, Hex);
+		if (Hex != ScalarHexEncode(Data.data(), Length))
+		{
+			printf("hex mismatch at %zu bytes\n", Length);
+			return 1;
+		}
+		const double ScalarHexEncodeNs = MeasureNs([&]() { KeepResult(ScalarHexEncode(Data.data(), Length).data()); });
+		Report("hex encode", Length, ScalarHexEncodeNs, MeasureNs([&]() { FCloudWatchEncoding::HexEncode(Data.data(), Length, &Hex[0]); KeepResult(Hex.data()); }));
+
+		std::vector<uint8> Decoded(Length);
+		const double ScalarHexDecodeNs = MeasureNs([&]() { KeepResult(ScalarHexDecode(Hex.data(), Hex.size()).data()); });
+		Report("hex decode", Length, ScalarHexDecodeNs, MeasureNs([&]() { FCloudWatchEncoding::HexDecode(Hex.data(), Hex.size(), Decoded.data()); KeepResult(Decoded.data()); }));
+
+		Aws::String Text;
+		FCloudWatchEncoding::Base64Encode(Data.data(), Length, Text);
+		if (Text != ScalarBase64Encode(Data.data(), Length))
+		{
+			printf("base64 mismatch at %zu bytes\n", Length);
+			return 1;
+		}
+		const double ScalarBase64EncodeNs = MeasureNs([&]() { KeepResult(ScalarBase64Encode(Data.data(), Length).data()); });
+		Report("base64 encode", Length, ScalarBase64EncodeNs, MeasureNs([&]() { FCloudWatchEncoding::Base64Encode(Data.data(), Length, &Text[0]); KeepResult(Text.data()); }));
+
+		size_t DecodedLength = 0;
+		const double ScalarBase64DecodeNs = MeasureNs([&]() { KeepResult(ScalarBase64Decode(Text.data(), Text.size()).data()); });
+		Report("base64 decode", Length, ScalarBase64DecodeNs, MeasureNs([&]() { FCloudWatchEncoding::Base64Decode(Text.data(), Text.size(), Decoded.data(), DecodedLength); KeepResult(Decoded.data()); }));
+		if (DecodedLength != Length || memcmp(Decoded.data(), Data.data(), Length) != 0)
+		{
+			printf("base64 round trip failed at %zu bytes\n", Length);
+			return 1;
+		}
+	}
+	return 0;
+}
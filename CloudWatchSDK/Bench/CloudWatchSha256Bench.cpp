@@ -0,0 +1,134 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#include "CloudWatchBench.h"
+#include "CloudWatchCryptoFactory.h"
+#include "CloudWatchSha256.h"
+
+#include <aws/core/utils/Array.h>
+#include <aws/core/utils/Outcome.h>
+#include <aws/core/utils/memory/AWSMemory.h>
+
+#include <functional>
+
+#if CLOUDWATCH_BENCH_OPENSSL
+	#include <openssl/evp.h>
+	#include <openssl/hmac.h>
+#endif
+
+// SHA-256 and HMAC-SHA256 with a context reused per thread against a context allocated per call, which is what the
+// SDK's OpenSSL hashes do with their EVP context. The OpenSSL cases are only built when CMake found OpenSSL.
+
+static const char* ALLOCATION_TAG = "CloudWatchSha256Bench";
+
+struct FHashCase
+{
+	const char* Name;
+	std::function<void()> Hash;
+};
+
+int main(int argc, char** argv)
+{
+	InitBench(argc, argv);
+	printf("FCloudWatchSha256: %s\n", FCloudWatchSha256::GetImplementationName());
+
+	// about the size of a PutLogEvents canonical request and of a string to sign
+	const Aws::String CanonicalRequest(512, 'c');
+	const Aws::String StringToSign(128, 's');
+	uint8 Key[FCloudWatchSha256::DigestSize] = {};
+	const Aws::Utils::ByteBuffer KeyBuffer(Key, sizeof(Key));
+	const Aws::Utils::ByteBuffer StringToSignBuffer(reinterpret_cast<const unsigned char*>(StringToSign.data()), StringToSign.size());
+	FCloudWatchSha256Hash HashInterface;
+	FCloudWatchSha256HMAC HmacInterface;
+
+	const FHashCase Cases[] =
+	{
+		{ "sha256, context reused", [&]()
+		{
+			static thread_local FCloudWatchSha256 Sha;
+			uint8 Digest[FCloudWatchSha256::DigestSize];
+			Sha.Reset();
+			Sha.Update(CanonicalRequest.data(), CanonicalRequest.size());
+			Sha.Final(Digest);
+			KeepResult(Digest);
+		} },
+		{ "sha256, context per call", [&]()
+		{
+			FCloudWatchSha256* Sha = Aws::New<FCloudWatchSha256>(ALLOCATION_TAG);
+			uint8 Digest[FCloudWatchSha256::DigestSize];
+			Sha->Update(CanonicalRequest.data(), CanonicalRequest.size());
+			Sha->Final(Digest);
+			Aws::Delete(Sha);
+			KeepResult(Digest);
+		} },
+		{ "sha256, Hash interface", [&]()
+		{
+			KeepResult(HashInterface.Calculate(CanonicalRequest).GetResult().GetUnderlyingData());
+		} },
+		{ "hmac", [&]()
+		{
+			uint8 Digest[FCloudWatchSha256::DigestSize];
+			FCloudWatchSha256::Hmac(Key, sizeof(Key), StringToSign.data(), StringToSign.size(), Digest);
+			KeepResult(Digest);
+		} },
+		{ "hmac, HMAC interface", [&]()
+		{
+			KeepResult(HmacInterface.Calculate(StringToSignBuffer, KeyBuffer).GetResult().GetUnderlyingData());
+		} },
+#if CLOUDWATCH_BENCH_OPENSSL
+		{ "openssl sha256, context reused", [&]()
+		{
+			static thread_local EVP_MD_CTX* Context = EVP_MD_CTX_new();
+			unsigned char Digest[EVP_MAX_MD_SIZE];
+			EVP_DigestInit_ex(Context, EVP_sha256(), nullptr);
+			EVP_DigestUpdate(Context, CanonicalRequest.data(), CanonicalRequest.size());
+			EVP_DigestFinal_ex(Context, Digest, nullptr);
+			KeepResult(Digest);
+		} },
+		{ "openssl sha256, context per call", [&]()
+		{
+			EVP_MD_CTX* Context = EVP_MD_CTX_new();
+			unsigned char Digest[EVP_MAX_MD_SIZE];
+			EVP_DigestInit_ex(Context, EVP_sha256(), nullptr);
+			EVP_DigestUpdate(Context, CanonicalRequest.data(), CanonicalRequest.size());
+			EVP_DigestFinal_ex(Context, Digest, nullptr);
+			EVP_MD_CTX_free(Context);
+			KeepResult(Digest);
+		} },
+		{ "openssl hmac, context per call", [&]()
+		{
+			unsigned char Digest[EVP_MAX_MD_SIZE];
+			unsigned int Length = 0;
+			HMAC(EVP_sha256(), Key, sizeof(Key), reinterpret_cast<const unsigned char*>(StringToSign.data()), StringToSign.size(), Digest, &Length);
+			KeepResult(Digest);
+		} },
+#endif
+	};
+
+	printf("\n%-34s %10s\n", "single thread", "ns/hash");
+	for (const FHashCase& Case : Cases)
+	{
+		printf("%-34s %10.1f\n", Case.Name, MeasureNs(Case.Hash));
+	}
+
+	// allocator and context setup costs grow with contention, so the per core rate is what signing throughput sees
+	printf("\n%-34s %8s %14s\n", "all threads", "threads", "hashes/s/thread");
+	const int32 Threads = FMath::Max(1, static_cast<int32>(std::thread::hardware_concurrency()));
+	const int64 Iterations = static_cast<int64>(200000 * BenchMinSeconds / 0.25) + 1;
+	for (const FHashCase& Case : Cases)
+	{
+		const double PerSecond = MeasureThreads(Threads, Iterations, [&](int32) { Case.Hash(); });
+		printf("%-34s %8d %14.0f\n", Case.Name, Threads, PerSecond / Threads);
+	}
+	return 0;
+}
@@ -0,0 +1,141 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#include "CloudWatchBench.h"
+#include "CloudWatchSha256.h"
+#include "CloudWatchSigningKeyCache.h"
+
+#include <aws/core/utils/memory/stl/AWSString.h>
+
+#include <cstring>
+#include <functional>
+#include <shared_mutex>
+
+// Signing key lookups and the hashing of a SigV4 signature on many threads at once.
+// The baseline keeps a key per client behind a reader-writer lock, keyed by date and secret only, the way each
+// client's AWSAuthV4Signer does. std::shared_timed_mutex stands in for the SDK's ReaderWriterLock, which lives in
+// aws-cpp-sdk-core. The http request side of signing needs the SDK libraries and isn't timed here.
+
+static const Aws::String SecretKey = "wJalrXUtnFEMI/K7MDENG/bPxRfiCYEXAMPLEKEY";
+static const Aws::String Date = "20240101";
+static const Aws::String Region = "us-east-1";
+static const Aws::String Services[] = { "logs", "monitoring" };
+
+/** What one AWSAuthV4Signer keeps: the last key, the date and secret it was derived for, and the lock around them. */
+struct FSignerKey
+{
+	std::shared_timed_mutex Lock;
+	Aws::String Date;
+	Aws::String SecretKey;
+	FCloudWatchSigningKey Key;
+
+	FCloudWatchSigningKey GetKey(const Aws::String& Service)
+	{
+		{
+			std::shared_lock<std::shared_timed_mutex> ReadLock(Lock);
+			if (Date == ::Date && SecretKey == ::SecretKey)
+			{
+				return Key;
+			}
+		}
+		std::unique_lock<std::shared_timed_mutex> WriteLock(Lock);
+		Key = FCloudWatchSigningKeyCache::DeriveKey(::SecretKey, ::Date, Region, Service);
+		Date = ::Date;
+		SecretKey = ::SecretKey;
+		return Key;
+	}
+};
+
+struct FSigningCase
+{
+	const char* Name;
+	std::function<FCloudWatchSigningKey(int32 ThreadIndex, int32 Call)> GetKey;
+};
+
+int main(int argc, char** argv)
+{
+	InitBench(argc, argv);
+
+	// one per client, like the Logs and Monitoring clients' own signers
+	FSignerKey SignerKeys[2];
+	FCloudWatchSigningKeyCache& Cache = FCloudWatchSigningKeyCache::Get();
+
+	// more scopes than a thread keeps for itself but fewer than the cache holds, so lookups go to the shared snapshot
+	Aws::Vector<Aws::String> ManyRegions;
+	for (int32 Index = 0; Index < 6; ++Index)
+	{
+		ManyRegions.push_back("region-" + Aws::String(1, static_cast<char>('a' + Index)));
+	}
+
+	const FSigningCase Cases[] =
+	{
+		{ "derive per call", [&](int32, int32 Call)
+		{
+			return FCloudWatchSigningKeyCache::DeriveKey(SecretKey, Date, Region, Services[Call & 1]);
+		} },
+		{ "locked key per client", [&](int32, int32 Call)
+		{
+			return SignerKeys[Call & 1].GetKey(Services[Call & 1]);
+		} },
+		{ "cache, thread slots", [&](int32, int32 Call)
+		{
+			return Cache.GetKey(SecretKey, Date, Region, Services[Call & 1]);
+		} },
+		{ "cache, shared snapshot", [&](int32 ThreadIndex, int32 Call)
+		{
+			return Cache.GetKey(SecretKey, Date, ManyRegions[(ThreadIndex + Call / 2) % ManyRegions.size()], Services[Call & 1]);
+		} },
+	};
+
+	// a canonical request the size of a small PutLogEvents call, and the string to sign made from its hash
+	const Aws::String CanonicalRequest(512, 'c');
+	const int64 Iterations = static_cast<int64>(100000 * BenchMinSeconds / 0.25) + 1;
+
+	for (bool bSign : { false, true })
+	{
+		printf("\n%-24s %8s %14s\n", bSign ? "key lookup + signature" : "key lookup", "threads", "calls/s");
+		for (int32 Threads : GetBenchThreadCounts(64))
+		{
+			for (const FSigningCase& Case : Cases)
+			{
+				const double PerSecond = MeasureThreads(Threads, Iterations / Threads + 1, [&](int32 ThreadIndex)
+				{
+					thread_local int32 Call = 0;
+					const FCloudWatchSigningKey Key = Case.GetKey(ThreadIndex, ++Call);
+					if (!bSign)
+					{
+						KeepResult(Key.Bytes);
+						return;
+					}
+
+					uint8 RequestHash[FCloudWatchSha256::DigestSize];
+					FCloudWatchSha256 Sha;
+					Sha.Update(CanonicalRequest.data(), CanonicalRequest.size());
+					Sha.Final(RequestHash);
+
+					char StringToSign[160];
+					const int Length = snprintf(StringToSign, sizeof(StringToSign), "AWS4-HMAC-SHA256\n%sT000000Z\n%s/%s/logs/aws4_request\n", Date.c_str(), Date.c_str(), Region.c_str());
+					uint8 Signature[FCloudWatchSha256::DigestSize];
+					FCloudWatchSha256::Hmac(Key.Bytes, sizeof(Key.Bytes), StringToSign, static_cast<size_t>(Length), Signature);
+					KeepResult(Signature);
+					KeepResult(RequestHash);
+				});
+				printf("%-24s %8d %14.0f\n", Case.Name, Threads, PerSecond);
+			}
+		}
+	}
+
+	const FCloudWatchSigningKeyCacheStats Stats = Cache.GetStats();
+	printf("\ncache: %d keys, %llu derivations, %llu shared hits\n", Stats.Keys, static_cast<unsigned long long>(Stats.Derivations), static_cast<unsigned long long>(Stats.SharedHits));
+	return 0;
+}
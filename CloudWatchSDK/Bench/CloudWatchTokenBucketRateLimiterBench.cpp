@@ -0,0 +1,81 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#include "CloudWatchBench.h"
+#include "CloudWatchTokenBucketRateLimiter.h"
+
+#include <aws/core/utils/ratelimiter/DefaultRateLimiter.h>
+
+#include <memory>
+
+// FCloudWatchTokenBucketRateLimiter against the SDK's DefaultRateLimiter, which takes a mutex on every call.
+// Overhead: every thread pays a tiny cost under a rate that is never reached, so only the bookkeeping is timed.
+// Accuracy: the threads together push one second worth of rate past the initial burst, which should take a second.
+
+typedef Aws::Utils::RateLimits::RateLimiterInterface FRateLimiter;
+
+static std::unique_ptr<FRateLimiter> CreateLimiter(bool bTokenBucket, int64 Rate)
+{
+	if (bTokenBucket)
+	{
+		return std::unique_ptr<FRateLimiter>(new FCloudWatchTokenBucketRateLimiter(Rate));
+	}
+	return std::unique_ptr<FRateLimiter>(new Aws::Utils::RateLimits::DefaultRateLimiter<>(Rate));
+}
+
+static const char* GetLimiterName(bool bTokenBucket)
+{
+	return bTokenBucket ? "token bucket" : "DefaultRateLimiter";
+}
+
+int main(int argc, char** argv)
+{
+	InitBench(argc, argv);
+
+	// a billion units per second, far above what the threads pay with a cost of 1
+	const int64 UnreachedRate = 1000000000LL;
+	const int64 Iterations = static_cast<int64>(400000 * BenchMinSeconds / 0.25) + 1;
+	// game servers write from many more threads than they have cores
+	const std::vector<int32> ThreadCounts = GetBenchThreadCounts(64);
+
+	printf("%-20s %8s %14s %12s\n", "overhead", "threads", "calls/s", "ns/call");
+	for (int32 Threads : ThreadCounts)
+	{
+		for (bool bTokenBucket : { false, true })
+		{
+			std::unique_ptr<FRateLimiter> Limiter = CreateLimiter(bTokenBucket, UnreachedRate);
+			const double PerSecond = MeasureThreads(Threads, Iterations / Threads + 1, [&](int32) { Limiter->ApplyAndPayForCost(1); });
+			printf("%-20s %8d %14.0f %12.1f\n", GetLimiterName(bTokenBucket), Threads, PerSecond, 1e9 / PerSecond);
+		}
+	}
+
+	// 4 MB/s paid in 4 KB writes, a body at a time like the http client does
+	const int64 Rate = 4 * 1024 * 1024;
+	const int64 Cost = 4 * 1024;
+	const int64 Writes = 2 * Rate / Cost;
+
+	printf("\n%-20s %8s %14s %12s\n", "accuracy", "threads", "expected s", "took s");
+	for (int32 Threads : { 1, ThreadCounts.back() })
+	{
+		for (bool bTokenBucket : { false, true })
+		{
+			std::unique_ptr<FRateLimiter> Limiter = CreateLimiter(bTokenBucket, Rate);
+			const double PerSecond = MeasureThreads(Threads, Writes / Threads, [&](int32) { Limiter->ApplyAndPayForCost(Cost); });
+			const double Seconds = static_cast<double>(Threads * (Writes / Threads)) / PerSecond;
+			// the full bucket lets the first second worth through at once, and the last write isn't waited for
+			const double Expected = static_cast<double>(Threads * (Writes / Threads) * Cost - Rate - Cost) / static_cast<double>(Rate);
+			printf("%-20s %8d %14.3f %12.3f\n", GetLimiterName(bTokenBucket), Threads, Expected, Seconds);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,31 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#include <aws/core/utils/memory/AWSMemory.h>
+
+#include <cstdlib>
+
+// aws-cpp-sdk-core isn't linked into the benchmarks, the SDK containers only need its allocator
+
+namespace Aws
+{
+	void* Malloc(const char* /*AllocationTag*/, std::size_t AllocationSize)
+	{
+		return std::malloc(AllocationSize);
+	}
+
+	void Free(void* MemoryPtr)
+	{
+		std::free(MemoryPtr);
+	}
+}
@@ -0,0 +1,41 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#pragma once
+
+// The few engine types the plugin sources built by the benchmarks use, so they compile without the engine.
+
+#include <cstdint>
+
+typedef int8_t int8;
+typedef int16_t int16;
+typedef int32_t int32;
+typedef int64_t int64;
+typedef uint8_t uint8;
+typedef uint16_t uint16;
+typedef uint32_t uint32;
+typedef uint64_t uint64;
+
+#define CLOUDWATCHSDK_API
+#define PLATFORM_WINDOWS 0
+
+#ifndef WITH_CLOUDWATCH
+	#define WITH_CLOUDWATCH 1
+#endif
+
+struct FMath
+{
+	template<typename T> static T Min(T A, T B) { return A < B ? A : B; }
+	template<typename T> static T Max(T A, T B) { return A > B ? A : B; }
+	template<typename T> static T Clamp(T Value, T Low, T High) { return Value < Low ? Low : (Value > High ? High : Value); }
+};
@@ -74,10 +74,22 @@ public class CloudWatchSDK : ModuleRules
             PublicAdditionalLibraries.Add(System.IO.Path.Combine(SDKDirectory, "aws-cpp-sdk-logs.lib"));
             PublicDelayLoadDLLs.Add("aws-cpp-sdk-logs.dll");
             RuntimeDependencies.Add(System.IO.Path.Combine(SDKDirectory, "aws-cpp-sdk-logs.dll"));
+
+            // the engine's libcurl backs FCloudWatchCurlHttpClient
+            if (Target.Platform == UnrealTargetPlatform.Win64 || Target.Platform == UnrealTargetPlatform.Linux)
+            {
+                AddEngineThirdPartyPrivateStaticDependencies(Target, "OpenSSL", "libcurl");
+                PublicDefinitions.Add("WITH_CLOUDWATCH_CURL=1");
+            }
+            else
+            {
+                PublicDefinitions.Add("WITH_CLOUDWATCH_CURL=0");
+            }
         }
         else
         {
             PublicDefinitions.Add("WITH_CLOUDWATCH=0");
+            PublicDefinitions.Add("WITH_CLOUDWATCH_CURL=0");
         }
     }
 }
@@ -0,0 +1,307 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#include "CloudWatchAsyncLogSystem.h"
+
+#if WITH_CLOUDWATCH
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <aws/core/utils/DateTime.h>
+#include <aws/core/utils/memory/stl/AWSStringStream.h>
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+using Aws::Utils::Logging::LogLevel;
+
+// records drained before EndBatch is called
+static const int32 WriterBatchSize = 256;
+static const char* GetLevelName(LogLevel Level)
+{
+	switch (Level)
+	{
+	case LogLevel::Fatal: return "FATAL";
+	case LogLevel::Error: return "ERROR";
+	case LogLevel::Warn: return "WARN";
+	case LogLevel::Info: return "INFO";
+	case LogLevel::Debug: return "DEBUG";
+	case LogLevel::Trace: return "TRACE";
+	default: return "";
+	}
+}
+
+FCloudWatchAsyncLogSystem::FCloudWatchAsyncLogSystem(LogLevel InLevel, int32 Capacity)
+	: Level(InLevel)
+	, EnqueuePosition(0)
+	, DequeuePosition(0)
+	, Dropped(0)
+	, bStopWriter(false)
+	, bWriterIdle(false)
+	, FlushRequests(0)
+	, FlushedRequests(0)
+{
+	uint64 Size = 2;
+	while (Size < static_cast<uint64>(FMath::Max(2, Capacity))) Size <<= 1;
+	Mask = Size - 1;
+
+	Slots.reset(new FSlot[Size]);
+	for (uint64 Index = 0; Index < Size; ++Index)
+	{
+		Slots[Index].Sequence.store(Index, std::memory_order_relaxed);
+	}
+}
+
+FCloudWatchAsyncLogSystem::~FCloudWatchAsyncLogSystem()
+{
+	StopWriter();
+}
+
+void FCloudWatchAsyncLogSystem::StartWriter()
+{
+	if (Writer.joinable()) return;
+	Writer = std::thread(&FCloudWatchAsyncLogSystem::WriterLoop, this);
+}
+
+void FCloudWatchAsyncLogSystem::StopWriter()
+{
+	if (!Writer.joinable()) return;
+	{
+		std::lock_guard<std::mutex> Guard(WriterLock);
+		bStopWriter = true;
+	}
+	WriterSignal.notify_one();
+	Writer.join();
+}
+
+FCloudWatchLogRecord* FCloudWatchAsyncLogSystem::BeginRecord(LogLevel InLevel, const char* Tag, uint64& OutPosition)
+{
+	uint64 Position = EnqueuePosition.load(std::memory_order_relaxed);
+	FSlot* Slot = nullptr;
+	while (true)
+	{
+		Slot = &Slots[Position & Mask];
+		const int64 Diff = static_cast<int64>(Slot->Sequence.load(std::memory_order_acquire)) - static_cast<int64>(Position);
+		if (Diff == 0)
+		{
+			if (EnqueuePosition.compare_exchange_weak(Position, Position + 1, std::memory_order_relaxed)) break;
+		}
+		else if (Diff < 0)
+		{
+			// the writer hasn't caught up => drop instead of blocking the caller
+			Dropped.fetch_add(1, std::memory_order_relaxed);
+			return nullptr;
+		}
+		else
+		{
+			Position = EnqueuePosition.load(std::memory_order_relaxed);
+		}
+	}
+
+	FCloudWatchLogRecord& Record = Slot->Record;
+	Record.Level = InLevel;
+	Record.TimestampMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	Record.ThreadId = std::hash<std::thread::id>()(std::this_thread::get_id());
+	Record.MessageLength = 0;
+	strncpy(Record.Tag, Tag ? Tag : "", FCloudWatchLogRecord::MaxTagLength - 1);
+	Record.Tag[FCloudWatchLogRecord::MaxTagLength - 1] = '\0';
+
+	OutPosition = Position;
+	return &Record;
+}
+
+void FCloudWatchAsyncLogSystem::CommitRecord(uint64 Position)
+{
+	Slots[Position & Mask].Sequence.store(Position + 1, std::memory_order_release);
+
+	// the writer only sleeps on an empty ring, so the record that ends it is the one to wake it. Pairs with the fence
+	// in WriterLoop: either the writer sees this record or this sees the writer idle
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (bWriterIdle.load(std::memory_order_relaxed) && bWriterIdle.exchange(false, std::memory_order_relaxed))
+	{
+		// taking the lock orders the notify after the writer's wait began, or after its last check of the ring
+		{
+			std::lock_guard<std::mutex> Guard(WriterLock);
+		}
+		WriterSignal.notify_one();
+	}
+}
+
+bool FCloudWatchAsyncLogSystem::HasPendingRecords() const
+{
+	return Slots[DequeuePosition & Mask].Sequence.load(std::memory_order_acquire) == DequeuePosition + 1;
+}
+
+void FCloudWatchAsyncLogSystem::Log(LogLevel InLevel, const char* Tag, const char* FormatStr, ...)
+{
+	if (InLevel > GetLogLevel()) return;
+
+	uint64 Position = 0;
+	FCloudWatchLogRecord* Record = BeginRecord(InLevel, Tag, Position);
+	if (!Record) return;
+
+	// format directly into the slot, no intermediate string
+	va_list Args;
+	va_start(Args, FormatStr);
+	const int Written = vsnprintf(Record->Message, FCloudWatchLogRecord::MaxMessageLength, FormatStr, Args);
+	va_end(Args);
+	Record->MessageLength = FMath::Clamp(Written, 0, FCloudWatchLogRecord::MaxMessageLength - 1);
+
+	CommitRecord(Position);
+}
+
+void FCloudWatchAsyncLogSystem::LogStream(LogLevel InLevel, const char* Tag, const Aws::OStringStream& MessageStream)
+{
+	if (InLevel > GetLogLevel()) return;
+
+	uint64 Position = 0;
+	FCloudWatchLogRecord* Record = BeginRecord(InLevel, Tag, Position);
+	if (!Record) return;
+
+	// str() is the only standard way to read an ostringstream before C++20's view(), the SDK's own log systems pay the same copy
+	const Aws::String Message = MessageStream.str();
+	const int32 Length = FMath::Min(static_cast<int32>(Message.length()), FCloudWatchLogRecord::MaxMessageLength - 1);
+	memcpy(Record->Message, Message.c_str(), Length);
+	Record->Message[Length] = '\0';
+	Record->MessageLength = Length;
+
+	CommitRecord(Position);
+}
+
+void FCloudWatchAsyncLogSystem::Flush()
+{
+	std::unique_lock<std::mutex> Lock(WriterLock);
+	if (bStopWriter) return;
+
+	const uint64 Target = ++FlushRequests;
+	WriterSignal.notify_one();
+	FlushedSignal.wait(Lock, [this, Target]() { return FlushedRequests >= Target || bStopWriter; });
+}
+
+int32 FCloudWatchAsyncLogSystem::Drain()
+{
+	int32 Count = 0;
+	while (Count < WriterBatchSize)
+	{
+		FSlot& Slot = Slots[DequeuePosition & Mask];
+		if (Slot.Sequence.load(std::memory_order_acquire) != DequeuePosition + 1) break;
+
+		WriteRecord(Slot.Record);
+
+		// hand the slot back to the producers for the next lap
+		Slot.Sequence.store(DequeuePosition + Mask + 1, std::memory_order_release);
+		++DequeuePosition;
+		++Count;
+	}
+	return Count;
+}
+
+void FCloudWatchAsyncLogSystem::WriterLoop()
+{
+	bool bStop = false;
+	while (!bStop)
+	{
+		uint64 PendingFlush = 0;
+		{
+			std::unique_lock<std::mutex> Lock(WriterLock);
+			WriterSignal.wait(Lock, [this]()
+			{
+				bWriterIdle.store(true, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				return bStopWriter || FlushRequests != FlushedRequests || HasPendingRecords();
+			});
+			bWriterIdle.store(false, std::memory_order_relaxed);
+			PendingFlush = FlushRequests;
+			bStop = bStopWriter;
+		}
+
+		while (Drain() > 0)
+		{
+			EndBatch();
+		}
+
+		{
+			std::lock_guard<std::mutex> Guard(WriterLock);
+			FlushedRequests = PendingFlush;
+		}
+		FlushedSignal.notify_all();
+	}
+}
+
+int32 FCloudWatchAsyncLogSystem::FormatPrefix(const FCloudWatchLogRecord& Record, char* Buffer, int32 BufferSize)
+{
+	const Aws::Utils::DateTime Timestamp(static_cast<int64_t>(Record.TimestampMs));
+	const int Written = snprintf(Buffer, BufferSize, "[%s] %s.%03d %s [%llu] ", GetLevelName(Record.Level), Timestamp.ToGmtString("%Y-%m-%d %H:%M:%S").c_str(),
+		static_cast<int32>(Record.TimestampMs % 1000), Record.Tag, static_cast<unsigned long long>(Record.ThreadId));
+	return FMath::Clamp(Written, 0, BufferSize - 1);
+}
+
+static const int64 MillisPerHour = 3600 * 1000;
+
+FCloudWatchFileLogSystem::FCloudWatchFileLogSystem(LogLevel InLevel, const Aws::String& InFilenamePrefix, int32 Capacity /*= 8192*/)
+	: FCloudWatchAsyncLogSystem(InLevel, Capacity)
+	, FilenamePrefix(InFilenamePrefix)
+{
+	OpenFile(Aws::Utils::DateTime::Now().Millis());
+	StartWriter();
+}
+
+void FCloudWatchFileLogSystem::OpenFile(int64 TimestampMs)
+{
+	// one file per hour like DefaultLogSystem, named after the hour of the first record written to it
+	const Aws::String FileName = FilenamePrefix + Aws::Utils::DateTime(static_cast<int64_t>(TimestampMs)).ToGmtString("%Y-%m-%d-%H") + ".log";
+	LogFile = std::make_shared<Aws::OFStream>(FileName.c_str(), std::ios_base::out | std::ios_base::app);
+	FileHour = TimestampMs / MillisPerHour;
+}
+
+FCloudWatchFileLogSystem::~FCloudWatchFileLogSystem()
+{
+	StopWriter();
+}
+
+void FCloudWatchFileLogSystem::WriteRecord(const FCloudWatchLogRecord& Record)
+{
+	if (Record.TimestampMs / MillisPerHour > FileHour)
+	{
+		OpenFile(Record.TimestampMs);
+	}
+
+	char Prefix[160];
+	const int32 PrefixLength = FormatPrefix(Record, Prefix, sizeof(Prefix));
+	LogFile->write(Prefix, PrefixLength);
+	LogFile->write(Record.Message, Record.MessageLength);
+	LogFile->put('\n');
+}
+
+void FCloudWatchFileLogSystem::EndBatch()
+{
+	const uint64 TotalDropped = GetDroppedCount();
+	if (TotalDropped != ReportedDropped)
+	{
+		*LogFile << "[WARN] " << (TotalDropped - ReportedDropped) << " log records dropped, ring buffer was full\n";
+		ReportedDropped = TotalDropped;
+	}
+	LogFile->flush();
+}
+
+#endif
@@ -0,0 +1,199 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#include "CloudWatchBufferPool.h"
+
+#if WITH_CLOUDWATCH
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <aws/core/utils/memory/AWSMemory.h>
+
+#include <cstring>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+static const char* ALLOCATION_TAG = "CloudWatchBufferPool";
+
+FCloudWatchBufferPool& FCloudWatchBufferPool::Get()
+{
+	static FCloudWatchBufferPool Instance;
+	return Instance;
+}
+
+FCloudWatchBufferPool::FCloudWatchBufferPool()
+	: MaxFreeBuffers(16)
+	, MaxBufferBytes(2 * 1024 * 1024)
+{
+}
+
+void FCloudWatchBufferPool::SetLimits(int32 InMaxFreeBuffers, int32 InMaxBufferBytes)
+{
+	Aws::Vector<Aws::String*> Dropped;
+	{
+		std::lock_guard<std::mutex> Guard(Lock);
+		MaxFreeBuffers = FMath::Max(0, InMaxFreeBuffers);
+		MaxBufferBytes = static_cast<size_t>(FMath::Max(0, InMaxBufferBytes));
+		while (Free.size() > static_cast<size_t>(MaxFreeBuffers))
+		{
+			Dropped.push_back(Free.back());
+			Stats.FreeBytes -= Free.back()->capacity();
+			Free.pop_back();
+		}
+		Stats.FreeBuffers = static_cast<int32>(Free.size());
+	}
+
+	for (Aws::String* Buffer : Dropped)
+	{
+		Aws::Delete(Buffer);
+	}
+}
+
+std::shared_ptr<Aws::String> FCloudWatchBufferPool::Acquire(size_t MinCapacity)
+{
+	Aws::String* Buffer = nullptr;
+	{
+		std::lock_guard<std::mutex> Guard(Lock);
+		++Stats.Acquires;
+		if (!Free.empty())
+		{
+			// most recently released first, its pages are the likeliest to still be resident
+			Buffer = Free.back();
+			Free.pop_back();
+			++Stats.Reuses;
+			Stats.FreeBuffers = static_cast<int32>(Free.size());
+			Stats.FreeBytes -= Buffer->capacity();
+		}
+	}
+
+	if (!Buffer)
+	{
+		Buffer = Aws::New<Aws::String>(ALLOCATION_TAG);
+	}
+	Buffer->reserve(MinCapacity);
+	return std::shared_ptr<Aws::String>(Buffer, [](Aws::String* Released) { FCloudWatchBufferPool::Get().Release(Released); });
+}
+
+void FCloudWatchBufferPool::Release(Aws::String* Buffer)
+{
+	// clear keeps the capacity
+	Buffer->clear();
+	{
+		std::lock_guard<std::mutex> Guard(Lock);
+		if (Free.size() < static_cast<size_t>(MaxFreeBuffers) && Buffer->capacity() <= MaxBufferBytes)
+		{
+			Free.push_back(Buffer);
+			Stats.FreeBuffers = static_cast<int32>(Free.size());
+			Stats.FreeBytes += Buffer->capacity();
+			return;
+		}
+	}
+	Aws::Delete(Buffer);
+}
+
+FCloudWatchBufferPoolStats FCloudWatchBufferPool::GetStats() const
+{
+	std::lock_guard<std::mutex> Guard(Lock);
+	return Stats;
+}
+
+FCloudWatchPooledBufferStream::FCloudWatchPooledBufferStream(const std::shared_ptr<Aws::String>& InBuffer, const char* InPayloadHash)
+	: Aws::IOStream(nullptr)
+	, Buffer(InBuffer)
+	, StreamBuf(reinterpret_cast<unsigned char*>(&(*InBuffer)[0]), InBuffer->size())
+	, bHasPayloadHash(InPayloadHash != nullptr)
+{
+	rdbuf(&StreamBuf);
+	if (bHasPayloadHash)
+	{
+		std::memcpy(PayloadHash, InPayloadHash, sizeof(PayloadHash));
+	}
+}
+
+FCloudWatchGrowableStreamBuf::FCloudWatchGrowableStreamBuf(const std::shared_ptr<Aws::String>& InBuffer)
+	: Buffer(InBuffer)
+{
+	ResetGetArea(0);
+}
+
+void FCloudWatchGrowableStreamBuf::Reserve(size_t Bytes)
+{
+	const size_t ReadOffset = static_cast<size_t>(gptr() - eback());
+	Buffer->reserve(Bytes);
+	ResetGetArea(ReadOffset);
+}
+
+void FCloudWatchGrowableStreamBuf::ResetGetArea(size_t ReadOffset)
+{
+	char* Base = &(*Buffer)[0];
+	setg(Base, Base + ReadOffset, Base + Buffer->size());
+}
+
+FCloudWatchGrowableStreamBuf::int_type FCloudWatchGrowableStreamBuf::overflow(int_type Char)
+{
+	if (traits_type::eq_int_type(Char, traits_type::eof())) return traits_type::not_eof(Char);
+
+	const char_type Value = traits_type::to_char_type(Char);
+	xsputn(&Value, 1);
+	return Char;
+}
+
+std::streamsize FCloudWatchGrowableStreamBuf::xsputn(const char_type* Data, std::streamsize Count)
+{
+	const size_t ReadOffset = static_cast<size_t>(gptr() - eback());
+	Buffer->append(Data, static_cast<size_t>(Count));
+	ResetGetArea(ReadOffset);
+	return Count;
+}
+
+FCloudWatchGrowableStreamBuf::int_type FCloudWatchGrowableStreamBuf::underflow()
+{
+	// everything written is always inside the get area
+	return gptr() < egptr() ? traits_type::to_int_type(*gptr()) : traits_type::eof();
+}
+
+FCloudWatchGrowableStreamBuf::pos_type FCloudWatchGrowableStreamBuf::seekoff(off_type Offset, std::ios_base::seekdir Direction, std::ios_base::openmode Which)
+{
+	// writes always append, only the read position moves
+	if ((Which & std::ios_base::in) == 0)
+	{
+		return Direction == std::ios_base::cur || Direction == std::ios_base::end ? pos_type(static_cast<off_type>(Buffer->size())) : pos_type(off_type(-1));
+	}
+
+	off_type Base = 0;
+	if (Direction == std::ios_base::cur) Base = gptr() - eback();
+	else if (Direction == std::ios_base::end) Base = static_cast<off_type>(Buffer->size());
+
+	const off_type Target = Base + Offset;
+	if (Target < 0 || Target > static_cast<off_type>(Buffer->size())) return pos_type(off_type(-1));
+	ResetGetArea(static_cast<size_t>(Target));
+	return pos_type(Target);
+}
+
+FCloudWatchGrowableStreamBuf::pos_type FCloudWatchGrowableStreamBuf::seekpos(pos_type Position, std::ios_base::openmode Which)
+{
+	return seekoff(off_type(Position), std::ios_base::beg, Which);
+}
+
+FCloudWatchPooledResponseStream::FCloudWatchPooledResponseStream(const std::shared_ptr<Aws::String>& InBuffer)
+	: Aws::IOStream(nullptr)
+	, StreamBuf(InBuffer)
+{
+	rdbuf(&StreamBuf);
+}
+
+#endif
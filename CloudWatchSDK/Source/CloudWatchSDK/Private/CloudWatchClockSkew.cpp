@@ -0,0 +1,137 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#include "CloudWatchClockSkew.h"
+#include "CloudWatchGlobals.h"
+
+#if WITH_CLOUDWATCH
+
+#include <cmath>
+#include <cstring>
+
+// the Date header has whole seconds, taking more than one a second adds nothing
+static const int64 SampleIntervalMillis = 1000;
+// weight of a new sample in the smoothed offset
+static const double SmoothingFactor = 0.125;
+// a sample this far off the estimate means the local clock was set, the estimate restarts from it
+static const int64 ClockJumpMillis = 60 * 1000;
+// below this the offset is the header's resolution plus the response latency, not skew
+static const int64 MinAppliedOffsetMillis = 2000;
+
+static bool ParseDigits(const char* Text, int32 Digits, int32& Out)
+{
+	Out = 0;
+	for (int32 Index = 0; Index < Digits; ++Index)
+	{
+		if (Text[Index] < '0' || Text[Index] > '9') return false;
+		Out = Out * 10 + (Text[Index] - '0');
+	}
+	return true;
+}
+
+// days since 1970-01-01 of a proleptic Gregorian date, the inverse of the signer's civil date computation
+static int64 DaysFromCivil(int32 Year, int32 Month, int32 Day)
+{
+	const int64 ShiftedYear = Year - (Month <= 2 ? 1 : 0);
+	const int64 Era = ShiftedYear / 400;
+	const int64 YearOfEra = ShiftedYear - Era * 400;
+	const int64 DayOfYear = (153 * (Month + (Month > 2 ? -3 : 9)) + 2) / 5 + Day - 1;
+	const int64 DayOfEra = YearOfEra * 365 + YearOfEra / 4 - YearOfEra / 100 + DayOfYear;
+	return Era * 146097 + DayOfEra - 719468;
+}
+
+FCloudWatchClockSkewEstimator::FCloudWatchClockSkewEstimator()
+	: NextSampleMillis(0)
+	, bHasEstimate(false)
+	, EstimateMillis(0.0)
+	, EstimatedOffsetMillis(0)
+	, AppliedOffsetMillis(0)
+	, Samples(0)
+{
+}
+
+bool FCloudWatchClockSkewEstimator::ParseHttpDate(const char* Text, size_t Length, int64& OutMillis)
+{
+	static const char* Months = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+	// "Sun, 06 Nov 1994 08:49:37 GMT", fixed width
+	if (Length != 29 || Text[3] != ',' || Text[4] != ' ' || Text[7] != ' ' || Text[11] != ' ' || Text[16] != ' '
+		|| Text[19] != ':' || Text[22] != ':' || std::memcmp(Text + 25, " GMT", 4) != 0)
+	{
+		return false;
+	}
+
+	int32 Month = 0;
+	while (Month < 12 && std::memcmp(Months + Month * 3, Text + 8, 3) != 0)
+	{
+		++Month;
+	}
+
+	int32 Day, Year, Hour, Minute, Second;
+	if (Month == 12 || !ParseDigits(Text + 5, 2, Day) || !ParseDigits(Text + 12, 4, Year) || !ParseDigits(Text + 17, 2, Hour)
+		|| !ParseDigits(Text + 20, 2, Minute) || !ParseDigits(Text + 23, 2, Second) || Day < 1 || Day > 31 || Hour > 23 || Minute > 59 || Second > 60)
+	{
+		return false;
+	}
+
+	OutMillis = ((DaysFromCivil(Year, Month + 1, Day) * 24 + Hour) * 60 + Minute) * 60000 + int64(Second) * 1000;
+	return true;
+}
+
+void FCloudWatchClockSkewEstimator::AddSample(const char* DateHeader, size_t Length, int64 ReceivedMillis)
+{
+	std::unique_lock<std::mutex> Guard(SampleLock, std::try_to_lock);
+	if (!Guard.owns_lock())
+	{
+		return;
+	}
+	NextSampleMillis.store(ReceivedMillis + SampleIntervalMillis, std::memory_order_relaxed);
+
+	int64 ServerMillis;
+	if (!ParseHttpDate(DateHeader, Length, ServerMillis))
+	{
+		return;
+	}
+
+	// the header is truncated to the second, the middle of it is the best guess
+	const double Offset = double(ServerMillis + 500 - ReceivedMillis);
+	if (!bHasEstimate || std::fabs(Offset - EstimateMillis) > double(ClockJumpMillis))
+	{
+		EstimateMillis = Offset;
+		bHasEstimate = true;
+	}
+	else
+	{
+		EstimateMillis += SmoothingFactor * (Offset - EstimateMillis);
+	}
+	Samples.fetch_add(1, std::memory_order_relaxed);
+
+	const int64 Estimate = static_cast<int64>(std::llround(EstimateMillis));
+	const int64 Applied = Estimate >= MinAppliedOffsetMillis || Estimate <= -MinAppliedOffsetMillis ? Estimate : 0;
+	EstimatedOffsetMillis.store(Estimate, std::memory_order_relaxed);
+	if (AppliedOffsetMillis.exchange(Applied, std::memory_order_relaxed) == 0 && Applied != 0)
+	{
+		LOG_WARNING(FString::Printf(TEXT("Service clock is %lld ms ahead of the local one, signing with the service's time."), static_cast<long long>(Applied)));
+	}
+}
+
+FCloudWatchClockSkewStats FCloudWatchClockSkewEstimator::GetStats() const
+{
+	FCloudWatchClockSkewStats Stats;
+	Stats.Samples = Samples.load(std::memory_order_relaxed);
+	Stats.EstimatedOffsetMillis = EstimatedOffsetMillis.load(std::memory_order_relaxed);
+	Stats.AppliedOffsetMillis = AppliedOffsetMillis.load(std::memory_order_relaxed);
+	return Stats;
+}
+
+#endif
@@ -0,0 +1,231 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#include "CloudWatchConcurrencyLimiter.h"
+#include "CloudWatchGlobals.h"
+
+#if WITH_CLOUDWATCH
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <aws/core/utils/memory/stl/AWSMap.h>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+// latency above MinLatency * Tolerance is treated as queueing on the endpoint
+static const double LatencyTolerance = 2.0;
+// multiplicative decrease applied on throttling
+static const double ThrottleBackoffRatio = 0.7;
+// weight of a new sample in the smoothed latency
+static const double LatencySmoothing = 0.1;
+// the minimum latency is re-probed after this many samples so it can follow route changes
+static const uint32 MinLatencyResetSamples = 500;
+
+struct FConcurrencyLimiterRegistry
+{
+	std::mutex Lock;
+	Aws::Map<Aws::String, std::weak_ptr<FCloudWatchConcurrencyLimiter>> Limiters;
+};
+
+static FConcurrencyLimiterRegistry& GetRegistry()
+{
+	static FConcurrencyLimiterRegistry Registry;
+	return Registry;
+}
+
+FCloudWatchConcurrencyLimiter::FCloudWatchConcurrencyLimiter(const std::shared_ptr<Aws::Utils::Threading::Executor>& InnerExecutor, int32 InitialLimit, int32 InMinLimit, int32 InMaxLimit, int32 InMaxQueued)
+	: MinLimit(FMath::Max(1, InMinLimit))
+	, MaxLimit(FMath::Max(FMath::Max(1, InMinLimit), InMaxLimit))
+	, MaxQueued(FMath::Max(0, InMaxQueued))
+	, LastDecrease(std::chrono::steady_clock::now())
+	, Inner(InnerExecutor)
+{
+	Limit = FMath::Clamp(static_cast<double>(InitialLimit), MinLimit, MaxLimit);
+}
+
+FCloudWatchConcurrencyLimiter::~FCloudWatchConcurrencyLimiter()
+{
+	{
+		std::lock_guard<std::mutex> Guard(Lock);
+		bStopping = true;
+		Pending.clear();
+	}
+	// joins the workers, the requests they are running still report to this object
+	Inner.reset();
+}
+
+bool FCloudWatchConcurrencyLimiter::SubmitToThread(std::function<void()>&& Task)
+{
+	{
+		std::lock_guard<std::mutex> Guard(Lock);
+		if (bStopping) return false;
+		if (InFlight >= static_cast<int32>(Limit))
+		{
+			// above the limit => queue or shed
+			if (MaxQueued > 0 && Pending.size() >= static_cast<size_t>(MaxQueued))
+			{
+				++ShedCount;
+				return false;
+			}
+			Pending.push_back(std::move(Task));
+			return true;
+		}
+		++InFlight;
+	}
+
+	Dispatch(std::move(Task));
+	return true;
+}
+
+void FCloudWatchConcurrencyLimiter::Dispatch(std::function<void()>&& Task)
+{
+	// the task's latency includes retry backoff and rate limiter waits, samples come per attempt from OnAttemptLatency
+	auto Wrapped = [this, Task]()
+	{
+		Task();
+		OnTaskFinished();
+	};
+
+	if (!Inner->Submit(std::move(Wrapped)))
+	{
+		LOG_WARNING("Inner executor rejected a request.");
+		std::lock_guard<std::mutex> Guard(Lock);
+		--InFlight;
+		++ShedCount;
+	}
+}
+
+void FCloudWatchConcurrencyLimiter::OnTaskFinished()
+{
+	std::deque<std::function<void()>> Admitted;
+	{
+		std::lock_guard<std::mutex> Guard(Lock);
+		--InFlight;
+
+		while (!bStopping && !Pending.empty() && InFlight < static_cast<int32>(Limit))
+		{
+			Admitted.push_back(std::move(Pending.front()));
+			Pending.pop_front();
+			++InFlight;
+		}
+	}
+
+	for (auto& Task : Admitted)
+	{
+		Dispatch(std::move(Task));
+	}
+}
+
+void FCloudWatchConcurrencyLimiter::OnAttemptLatency(double LatencyMs)
+{
+	std::deque<std::function<void()>> Admitted;
+	{
+		std::lock_guard<std::mutex> Guard(Lock);
+
+		// track the no-load latency and a smoothed current latency
+		if (MinLatencyMs <= 0.0 || LatencyMs < MinLatencyMs || ++SamplesSinceMinReset >= MinLatencyResetSamples)
+		{
+			MinLatencyMs = LatencyMs;
+			SamplesSinceMinReset = 0;
+		}
+		SmoothedLatencyMs = SmoothedLatencyMs <= 0.0 ? LatencyMs : SmoothedLatencyMs + LatencySmoothing * (LatencyMs - SmoothedLatencyMs);
+
+		const double Gradient = FMath::Clamp(MinLatencyMs * LatencyTolerance / FMath::Max(SmoothedLatencyMs, 1.0), 0.5, 1.0);
+		if (Gradient < 1.0)
+		{
+			// requests are queueing on the endpoint => shrink with the gradient, once per round trip like a throttle
+			const auto Now = std::chrono::steady_clock::now();
+			const std::chrono::duration<double, std::milli> SinceDecrease = Now - LastDecrease;
+			if (SinceDecrease.count() >= SmoothedLatencyMs)
+			{
+				Limit = FMath::Max(MinLimit, Limit * Gradient);
+				LastDecrease = Now;
+			}
+		}
+		else if (InFlight * 2 >= static_cast<int32>(Limit))
+		{
+			// additive increase, roughly +1 per round trip, only while the limit is actually used
+			Limit = FMath::Min(MaxLimit, Limit + 1.0 / Limit);
+
+			while (!bStopping && !Pending.empty() && InFlight < static_cast<int32>(Limit))
+			{
+				Admitted.push_back(std::move(Pending.front()));
+				Pending.pop_front();
+				++InFlight;
+			}
+		}
+	}
+
+	for (auto& Task : Admitted)
+	{
+		Dispatch(std::move(Task));
+	}
+}
+
+void FCloudWatchConcurrencyLimiter::OnThrottled()
+{
+	std::lock_guard<std::mutex> Guard(Lock);
+	const auto Now = std::chrono::steady_clock::now();
+	const std::chrono::duration<double, std::milli> SinceDecrease = Now - LastDecrease;
+	if (SinceDecrease.count() < SmoothedLatencyMs) return;
+
+	Limit = FMath::Max(MinLimit, Limit * ThrottleBackoffRatio);
+	LastDecrease = Now;
+	LOG_VERBOSE(FString::Printf(TEXT("Throttled. Concurrency limit is now %d"), static_cast<int32>(Limit)));
+}
+
+int32 FCloudWatchConcurrencyLimiter::GetLimit() const
+{
+	std::lock_guard<std::mutex> Guard(Lock);
+	return static_cast<int32>(Limit);
+}
+
+int32 FCloudWatchConcurrencyLimiter::GetInFlight() const
+{
+	std::lock_guard<std::mutex> Guard(Lock);
+	return InFlight;
+}
+
+int32 FCloudWatchConcurrencyLimiter::GetQueued() const
+{
+	std::lock_guard<std::mutex> Guard(Lock);
+	return static_cast<int32>(Pending.size());
+}
+
+uint64 FCloudWatchConcurrencyLimiter::GetShedCount() const
+{
+	std::lock_guard<std::mutex> Guard(Lock);
+	return ShedCount;
+}
+
+void FCloudWatchConcurrencyLimiter::Register(const Aws::String& ServiceName, const std::shared_ptr<FCloudWatchConcurrencyLimiter>& Limiter)
+{
+	FConcurrencyLimiterRegistry& Registry = GetRegistry();
+	std::lock_guard<std::mutex> Guard(Registry.Lock);
+	if (Limiter) Registry.Limiters[ServiceName] = Limiter;
+	else Registry.Limiters.erase(ServiceName);
+}
+
+std::shared_ptr<FCloudWatchConcurrencyLimiter> FCloudWatchConcurrencyLimiter::Find(const Aws::String& ServiceName)
+{
+	FConcurrencyLimiterRegistry& Registry = GetRegistry();
+	std::lock_guard<std::mutex> Guard(Registry.Lock);
+	auto It = Registry.Limiters.find(ServiceName);
+	return It != Registry.Limiters.end() ? It->second.lock() : nullptr;
+}
+
+#endif
@@ -0,0 +1,112 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#include "CloudWatchConnectionWarmer.h"
+#include "CloudWatchGlobals.h"
+
+#if WITH_CLOUDWATCH && WITH_CLOUDWATCH_CURL
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <aws/core/http/HttpClientFactory.h>
+#include <aws/core/http/HttpRequest.h>
+#include <aws/core/utils/stream/ResponseStream.h>
+
+#include <chrono>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+FCloudWatchConnectionWarmer::FCloudWatchConnectionWarmer(const std::shared_ptr<FCloudWatchCurlHttpClient>& InClient, const Aws::Vector<Aws::String>& InEndpoints, int32 InConnectionsPerEndpoint, int32 InKeepAliveIntervalSeconds)
+	: Client(InClient)
+	, Endpoints(InEndpoints)
+	, ConnectionsPerEndpoint(FMath::Max(1, InConnectionsPerEndpoint))
+	, KeepAliveIntervalSeconds(FMath::Max(0, InKeepAliveIntervalSeconds))
+	, bStop(false)
+	, PendingPings(0)
+	, Pings(0)
+	, FailedPings(0)
+{
+	if (KeepAliveIntervalSeconds > 0)
+	{
+		KeepAliveThread = std::thread(&FCloudWatchConnectionWarmer::KeepAliveLoop, this);
+	}
+}
+
+FCloudWatchConnectionWarmer::~FCloudWatchConnectionWarmer()
+{
+	{
+		std::lock_guard<std::mutex> Guard(Lock);
+		bStop = true;
+	}
+	Signal.notify_all();
+	if (KeepAliveThread.joinable()) KeepAliveThread.join();
+
+	// ping callbacks still reference this, they are bounded by the client's timeouts
+	std::unique_lock<std::mutex> Guard(Lock);
+	Signal.wait(Guard, [this]() { return PendingPings == 0; });
+}
+
+void FCloudWatchConnectionWarmer::Warm()
+{
+	{
+		std::lock_guard<std::mutex> Guard(Lock);
+		if (bStop || PendingPings > 0) return;
+		PendingPings = static_cast<int32>(Endpoints.size()) * ConnectionsPerEndpoint;
+	}
+
+	for (const Aws::String& Endpoint : Endpoints)
+	{
+		for (int32 Index = 0; Index < ConnectionsPerEndpoint; ++Index)
+		{
+			// sent together so HTTP/1.1 needs one connection per ping; HTTP/2 multiplexes them over one
+			auto Request = Aws::Http::CreateHttpRequest(Endpoint + "/", Aws::Http::HttpMethod::HTTP_GET, Aws::Utils::Stream::DefaultResponseStreamFactoryMethod);
+			Client->MakeRequestAsync(Request, [this](const std::shared_ptr<Aws::Http::HttpResponse>& Response)
+			{
+				Pings.fetch_add(1, std::memory_order_relaxed);
+				if (Response->HasClientError())
+				{
+					FailedPings.fetch_add(1, std::memory_order_relaxed);
+				}
+
+				std::lock_guard<std::mutex> Guard(Lock);
+				if (--PendingPings == 0) Signal.notify_all();
+			});
+		}
+	}
+}
+
+void FCloudWatchConnectionWarmer::KeepAliveLoop()
+{
+	uint64 ReportedFailures = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> Guard(Lock);
+			if (Signal.wait_for(Guard, std::chrono::seconds(KeepAliveIntervalSeconds), [this]() { return bStop; })) break;
+		}
+
+		const uint64 Failures = GetFailedPings();
+		if (Failures != ReportedFailures)
+		{
+			LOG_VERBOSE(FString::Printf(TEXT("%llu keep-alive pings failed, their connections were closed."), static_cast<unsigned long long>(Failures - ReportedFailures)));
+			ReportedFailures = Failures;
+		}
+		Warm();
+	}
+}
+
+#endif
@@ -0,0 +1,81 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#include "CloudWatchCpuFeatures.h"
+
+#if WITH_CLOUDWATCH
+
+#if CLOUDWATCH_X64
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#else
+		#include <cpuid.h>
+	#endif
+#endif
+
+#if CLOUDWATCH_X64
+static void ReadCpuid(int32 Leaf, int32 SubLeaf, uint32 (&OutRegisters)[4])
+{
+#if defined(_MSC_VER)
+	int Registers[4];
+	__cpuidex(Registers, Leaf, SubLeaf);
+	for (int32 Index = 0; Index < 4; ++Index) OutRegisters[Index] = static_cast<uint32>(Registers[Index]);
+#else
+	__cpuid_count(Leaf, SubLeaf, OutRegisters[0], OutRegisters[1], OutRegisters[2], OutRegisters[3]);
+#endif
+}
+
+static uint64 ReadXcr0()
+{
+#if defined(_MSC_VER)
+	return _xgetbv(0);
+#else
+	uint32 Low, High;
+	__asm__ volatile("xgetbv" : "=a"(Low), "=d"(High) : "c"(0));
+	return (static_cast<uint64>(High) << 32) | Low;
+#endif
+}
+#endif
+
+static FCloudWatchCpuFeatures DetectCpuFeatures()
+{
+	FCloudWatchCpuFeatures Features;
+#if CLOUDWATCH_X64
+	uint32 Registers[4];
+	ReadCpuid(0, 0, Registers);
+	const uint32 MaxLeaf = Registers[0];
+
+	ReadCpuid(1, 0, Registers);
+	// SSE2 is part of x64
+	Features.bSse2 = true;
+	Features.bSsse3 = (Registers[2] & (1u << 9)) != 0;
+	Features.bSse41 = (Registers[2] & (1u << 19)) != 0;
+	const bool bOsSavesYmm = (Registers[2] & (1u << 27)) != 0 && (ReadXcr0() & 0x6) == 0x6;
+
+	if (MaxLeaf >= 7)
+	{
+		ReadCpuid(7, 0, Registers);
+		Features.bAvx2 = bOsSavesYmm && (Registers[1] & (1u << 5)) != 0;
+		Features.bSha = (Registers[1] & (1u << 29)) != 0;
+	}
+#endif
+	return Features;
+}
+
+const FCloudWatchCpuFeatures& FCloudWatchCpuFeatures::Get()
+{
+	static const FCloudWatchCpuFeatures Features = DetectCpuFeatures();
+	return Features;
+}
+
+#endif
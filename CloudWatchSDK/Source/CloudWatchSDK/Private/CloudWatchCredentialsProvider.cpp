@@ -0,0 +1,342 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#include "CloudWatchCredentialsProvider.h"
+#include "CloudWatchGlobals.h"
+#include "CloudWatchProfileConfig.h"
+
+#if WITH_CLOUDWATCH
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <aws/core/platform/Environment.h>
+#include <aws/core/utils/DateTime.h>
+#include <aws/core/utils/StringUtils.h>
+#include <aws/core/utils/memory/AWSMemory.h>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+static const char* ALLOCATION_TAG = "CloudWatchCredentialsProvider";
+
+// retry delay after a refresh that returned nothing
+static const std::chrono::seconds FailedRefreshDelay(10);
+// keeps credentials that are already inside the refresh window from spinning the thread
+static const std::chrono::seconds MinRefreshDelay(1);
+// how long FCloudWatchCachedCredentialsChain serves credentials without asking the winning provider again
+static const std::chrono::seconds CachedCredentialsTtl(30);
+// cached credentials are renewed this long before they expire
+static const std::chrono::seconds CachedCredentialsExpiryMargin(60);
+
+FCloudWatchRefreshingCredentialsProvider::FCloudWatchRefreshingCredentialsProvider(const std::shared_ptr<Aws::Auth::AWSCredentialsProvider>& InProvider, int32 RefreshIntervalSeconds, int32 RefreshAheadSeconds)
+	: Provider(InProvider)
+	, RefreshInterval(FMath::Max(1, RefreshIntervalSeconds))
+	, RefreshAhead(FMath::Max(0, RefreshAheadSeconds))
+	, Current(Aws::New<FSnapshot>(ALLOCATION_TAG))
+	, Readers(0)
+	, bFirstRefreshDone(false)
+	, bStop(false)
+	, Refreshes(0)
+	, FailedRefreshes(0)
+{
+	// the first fetch can wait for an instance metadata timeout, so it runs on the thread too and the caller, usually
+	// the game thread in SetupClient, returns at once
+	RefreshThread = std::thread([this]()
+	{
+		std::chrono::steady_clock::time_point Due = Refresh();
+		std::unique_lock<std::mutex> Guard(RefreshLock);
+		bFirstRefreshDone.store(true);
+		FirstRefreshSignal.notify_all();
+		while (!bStop)
+		{
+			if (std::chrono::steady_clock::now() < Due)
+			{
+				RefreshSignal.wait_until(Guard, Due);
+				continue;
+			}
+			Guard.unlock();
+			Due = Refresh();
+			Guard.lock();
+		}
+	});
+}
+
+FCloudWatchRefreshingCredentialsProvider::~FCloudWatchRefreshingCredentialsProvider()
+{
+	{
+		std::lock_guard<std::mutex> Guard(RefreshLock);
+		bStop = true;
+	}
+	RefreshSignal.notify_one();
+	RefreshThread.join();
+
+	Aws::Delete(const_cast<FSnapshot*>(Current.load()));
+	for (const FSnapshot* Snapshot : Retired)
+	{
+		Aws::Delete(const_cast<FSnapshot*>(Snapshot));
+	}
+}
+
+Aws::Auth::AWSCredentials FCloudWatchRefreshingCredentialsProvider::GetAWSCredentials()
+{
+	// only requests sent before the first fetch finished wait, on their worker thread
+	if (!bFirstRefreshDone.load())
+	{
+		std::unique_lock<std::mutex> Guard(RefreshLock);
+		FirstRefreshSignal.wait(Guard, [this]() { return bFirstRefreshDone.load(); });
+	}
+
+	Readers.fetch_add(1);
+	const Aws::Auth::AWSCredentials Credentials = Current.load()->Credentials;
+	Readers.fetch_sub(1);
+	return Credentials;
+}
+
+std::chrono::steady_clock::time_point FCloudWatchRefreshingCredentialsProvider::Refresh()
+{
+	// the wrapped provider reloads by itself once its credentials get close to expiring
+	const Aws::Auth::AWSCredentials Credentials = Provider->GetAWSCredentials();
+	const auto Now = std::chrono::steady_clock::now();
+	if (Credentials.IsEmpty())
+	{
+		FailedRefreshes.fetch_add(1, std::memory_order_relaxed);
+		LOG_WARNING("Credentials refresh returned no credentials. Keeping the previous ones.");
+		return Now + FMath::Min(FailedRefreshDelay, RefreshInterval);
+	}
+
+	Publish(Credentials);
+	Refreshes.fetch_add(1, std::memory_order_relaxed);
+
+	// renew ahead of the expiration, but never later than the interval
+	const int64 MillisToExpiration = Credentials.GetExpiration().Millis() - Aws::Utils::DateTime::CurrentTimeMillis();
+	const std::chrono::milliseconds UntilRenewal(MillisToExpiration - std::chrono::duration_cast<std::chrono::milliseconds>(RefreshAhead).count());
+	if (UntilRenewal < RefreshInterval)
+	{
+		return Now + FMath::Max(UntilRenewal, std::chrono::milliseconds(MinRefreshDelay));
+	}
+	return Now + RefreshInterval;
+}
+
+void FCloudWatchRefreshingCredentialsProvider::Publish(const Aws::Auth::AWSCredentials& Credentials)
+{
+	FSnapshot* Next = Aws::New<FSnapshot>(ALLOCATION_TAG);
+	Next->Credentials = Credentials;
+
+	// only the refresh thread publishes, Retired needs no lock
+	Retired.push_back(Current.exchange(Next));
+
+	// a reader that could still hold a replaced snapshot was counted before the exchange, so none are left at zero
+	if (Readers.load() == 0)
+	{
+		for (const FSnapshot* Snapshot : Retired)
+		{
+			Aws::Delete(const_cast<FSnapshot*>(Snapshot));
+		}
+		Retired.clear();
+	}
+}
+
+FCloudWatchCredentialsRefreshStats FCloudWatchRefreshingCredentialsProvider::GetStats() const
+{
+	FCloudWatchCredentialsRefreshStats Stats;
+	Stats.Refreshes = Refreshes.load(std::memory_order_relaxed);
+	Stats.FailedRefreshes = FailedRefreshes.load(std::memory_order_relaxed);
+
+	Readers.fetch_add(1);
+	const Aws::Utils::DateTime Expiration = Current.load()->Credentials.GetExpiration();
+	Readers.fetch_sub(1);
+
+	// credentials without an expiration carry the largest representable time
+	const int64 MillisToExpiration = Expiration.Millis() - Aws::Utils::DateTime::CurrentTimeMillis();
+	if (MillisToExpiration < int64(365) * 24 * 3600 * 1000)
+	{
+		Stats.SecondsToExpiration = FMath::Max<int64>(0, MillisToExpiration / 1000);
+	}
+	return Stats;
+}
+
+FCloudWatchCachedCredentialsChain::FCloudWatchCachedCredentialsChain(int32 RetryIntervalSeconds)
+	: RetryInterval(FMath::Max(1, RetryIntervalSeconds))
+	, Cached(nullptr)
+	, Readers(0)
+	, bResolvedOnce(false)
+	, bResolving(false)
+	, Winner{ nullptr, nullptr }
+{
+	std::lock_guard<std::mutex> Guard(Lock);
+	StartResolveLocked();
+}
+
+FCloudWatchCachedCredentialsChain::~FCloudWatchCachedCredentialsChain()
+{
+	// a metadata probe still running ends with its connect timeout
+	if (ResolveThread.joinable())
+	{
+		ResolveThread.join();
+	}
+
+	Aws::Delete(const_cast<FSnapshot*>(Cached.load()));
+	for (const FSnapshot* Snapshot : Retired)
+	{
+		Aws::Delete(const_cast<FSnapshot*>(Snapshot));
+	}
+}
+
+void FCloudWatchCachedCredentialsChain::StartResolveLocked()
+{
+	// the previous resolution is over once bResolving dropped, its thread only needs the join
+	if (ResolveThread.joinable())
+	{
+		ResolveThread.join();
+	}
+	bResolving = true;
+	LastResolve = std::chrono::steady_clock::now();
+	ResolveThread = std::thread(&FCloudWatchCachedCredentialsChain::Resolve, this);
+}
+
+void FCloudWatchCachedCredentialsChain::Resolve()
+{
+	// same order as DefaultAWSCredentialsProviderChain, with the profile files read by the mapped loader
+	Aws::Vector<FCandidate> Candidates;
+	Candidates.push_back({ "EnvironmentAWSCredentialsProvider", Aws::MakeShared<Aws::Auth::EnvironmentAWSCredentialsProvider>(ALLOCATION_TAG) });
+	Candidates.push_back({ "FCloudWatchProfileCredentialsProvider", Aws::MakeShared<FCloudWatchProfileCredentialsProvider>(ALLOCATION_TAG) });
+	Candidates.push_back({ "ProcessCredentialsProvider", Aws::MakeShared<Aws::Auth::ProcessCredentialsProvider>(ALLOCATION_TAG) });
+
+	const Aws::String RelativeUri = Aws::Environment::GetEnv("AWS_CONTAINER_CREDENTIALS_RELATIVE_URI");
+	const Aws::String AbsoluteUri = Aws::Environment::GetEnv("AWS_CONTAINER_CREDENTIALS_FULL_URI");
+	if (!RelativeUri.empty())
+	{
+		Candidates.push_back({ "TaskRoleCredentialsProvider", Aws::MakeShared<Aws::Auth::TaskRoleCredentialsProvider>(ALLOCATION_TAG, RelativeUri.c_str()) });
+	}
+	else if (!AbsoluteUri.empty())
+	{
+		const Aws::String Token = Aws::Environment::GetEnv("AWS_CONTAINER_AUTHORIZATION_TOKEN");
+		Candidates.push_back({ "TaskRoleCredentialsProvider", Aws::MakeShared<Aws::Auth::TaskRoleCredentialsProvider>(ALLOCATION_TAG, AbsoluteUri.c_str(), Token.c_str()) });
+	}
+	else if (Aws::Utils::StringUtils::ToLower(Aws::Environment::GetEnv("AWS_EC2_METADATA_DISABLED").c_str()) != "true")
+	{
+		Candidates.push_back({ "InstanceProfileCredentialsProvider", Aws::MakeShared<Aws::Auth::InstanceProfileCredentialsProvider>(ALLOCATION_TAG) });
+	}
+
+	FCandidate Found{ nullptr, nullptr };
+	for (const FCandidate& Candidate : Candidates)
+	{
+		if (!Candidate.Provider->GetAWSCredentials().IsEmpty())
+		{
+			Found = Candidate;
+			break;
+		}
+	}
+
+	if (Found.Provider)
+	{
+		LOG_NORMAL(FString::Printf(TEXT("Credentials resolved from %s."), UTF8_TO_TCHAR(Found.Name)));
+	}
+	else
+	{
+		LOG_WARNING("No provider of the default credentials chain has credentials.");
+	}
+
+	{
+		std::lock_guard<std::mutex> Guard(Lock);
+		Winner = Found;
+		bResolving = false;
+		bResolvedOnce.store(true);
+	}
+	Resolved.notify_all();
+}
+
+Aws::Auth::AWSCredentials FCloudWatchCachedCredentialsChain::GetAWSCredentials()
+{
+	if (bResolvedOnce.load())
+	{
+		Readers.fetch_add(1);
+		const FSnapshot* Snapshot = Cached.load();
+		if (Snapshot && std::chrono::steady_clock::now() < Snapshot->RenewAt)
+		{
+			const Aws::Auth::AWSCredentials Credentials = Snapshot->Credentials;
+			Readers.fetch_sub(1);
+			return Credentials;
+		}
+		Readers.fetch_sub(1);
+	}
+
+	std::unique_lock<std::mutex> Guard(Lock);
+	// only the first resolution is waited for, a retry runs while callers keep getting empty credentials
+	if (!bResolvedOnce.load())
+	{
+		Resolved.wait(Guard, [this]() { return bResolvedOnce.load(); });
+	}
+
+	// another caller may have renewed while this one waited for the lock
+	const FSnapshot* Snapshot = Cached.load();
+	if (Snapshot && std::chrono::steady_clock::now() < Snapshot->RenewAt)
+	{
+		return Snapshot->Credentials;
+	}
+
+	if (!Winner.Provider)
+	{
+		if (!bResolving && std::chrono::steady_clock::now() - LastResolve >= RetryInterval)
+		{
+			StartResolveLocked();
+		}
+		return Aws::Auth::AWSCredentials();
+	}
+
+	const Aws::Auth::AWSCredentials Credentials = Winner.Provider->GetAWSCredentials();
+	if (!Credentials.IsEmpty())
+	{
+		PublishLocked(Credentials);
+	}
+	return Credentials;
+}
+
+void FCloudWatchCachedCredentialsChain::PublishLocked(const Aws::Auth::AWSCredentials& Credentials)
+{
+	// kept until shortly before they expire, and no longer than CachedCredentialsTtl so the winner's own reloads,
+	// like a changed profile file, are still picked up
+	const auto Now = std::chrono::steady_clock::now();
+	const std::chrono::milliseconds UntilExpiration(Credentials.GetExpiration().Millis() - Aws::Utils::DateTime::CurrentTimeMillis() - CachedCredentialsExpiryMargin.count() * 1000);
+
+	FSnapshot* Next = Aws::New<FSnapshot>(ALLOCATION_TAG);
+	Next->Credentials = Credentials;
+	Next->RenewAt = Now + FMath::Max(std::chrono::milliseconds(0), FMath::Min(UntilExpiration, std::chrono::milliseconds(CachedCredentialsTtl)));
+
+	const FSnapshot* Previous = Cached.exchange(Next);
+	if (Previous)
+	{
+		Retired.push_back(Previous);
+	}
+
+	// same reclamation as FCloudWatchRefreshingCredentialsProvider::Publish, Lock keeps the writers apart
+	if (Readers.load() == 0)
+	{
+		for (const FSnapshot* Snapshot : Retired)
+		{
+			Aws::Delete(const_cast<FSnapshot*>(Snapshot));
+		}
+		Retired.clear();
+	}
+}
+
+Aws::String FCloudWatchCachedCredentialsChain::GetResolvedProviderName() const
+{
+	std::lock_guard<std::mutex> Guard(Lock);
+	return Winner.Name ? Winner.Name : "";
+}
+
+#endif
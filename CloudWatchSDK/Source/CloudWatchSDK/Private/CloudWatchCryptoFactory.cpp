@@ -0,0 +1,87 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#include "CloudWatchCryptoFactory.h"
+#include "CloudWatchSha256.h"
+
+#if WITH_CLOUDWATCH
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <aws/core/utils/Array.h>
+#include <aws/core/utils/Outcome.h>
+#include <aws/core/utils/memory/AWSMemory.h>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+using Aws::Utils::ByteBuffer;
+using Aws::Utils::Crypto::HashResult;
+
+static const char* ALLOCATION_TAG = "CloudWatchCryptoFactory";
+
+static const size_t StreamChunkSize = 4096;
+
+HashResult FCloudWatchSha256Hash::Calculate(const Aws::String& Str)
+{
+	FCloudWatchSha256 Sha;
+	Sha.Update(Str.c_str(), Str.size());
+
+	uint8 Digest[FCloudWatchSha256::DigestSize];
+	Sha.Final(Digest);
+	return HashResult(ByteBuffer(Digest, sizeof(Digest)));
+}
+
+HashResult FCloudWatchSha256Hash::Calculate(Aws::IStream& Stream)
+{
+	// same contract as the SDK's hashes: the whole stream, with the read position restored afterwards
+	Stream.clear();
+	const auto Position = Stream.tellg();
+	Stream.seekg(0, Stream.beg);
+
+	FCloudWatchSha256 Sha;
+	char Chunk[StreamChunkSize];
+	while (Stream.good())
+	{
+		Stream.read(Chunk, StreamChunkSize);
+		Sha.Update(Chunk, static_cast<size_t>(Stream.gcount()));
+	}
+	Stream.clear();
+	Stream.seekg(Position, Stream.beg);
+
+	uint8 Digest[FCloudWatchSha256::DigestSize];
+	Sha.Final(Digest);
+	return HashResult(ByteBuffer(Digest, sizeof(Digest)));
+}
+
+HashResult FCloudWatchSha256HMAC::Calculate(const ByteBuffer& ToSign, const ByteBuffer& Secret)
+{
+	uint8 Digest[FCloudWatchSha256::DigestSize];
+	FCloudWatchSha256::Hmac(Secret.GetUnderlyingData(), Secret.GetLength(), ToSign.GetUnderlyingData(), ToSign.GetLength(), Digest);
+	return HashResult(ByteBuffer(Digest, sizeof(Digest)));
+}
+
+FCloudWatchSha256Factory::FCloudWatchSha256Factory()
+	: Instance(Aws::MakeShared<FCloudWatchSha256Hash>(ALLOCATION_TAG))
+{
+}
+
+FCloudWatchSha256HMACFactory::FCloudWatchSha256HMACFactory()
+	: Instance(Aws::MakeShared<FCloudWatchSha256HMAC>(ALLOCATION_TAG))
+{
+}
+
+#endif
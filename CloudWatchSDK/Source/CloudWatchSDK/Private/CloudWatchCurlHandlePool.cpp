@@ -0,0 +1,186 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#include "CloudWatchCurlHandlePool.h"
+
+#if WITH_CLOUDWATCH && WITH_CLOUDWATCH_CURL
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <curl/curl.h>
+
+#include <chrono>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+template<typename T>
+static void AtomicMax(std::atomic<T>& Target, T Value)
+{
+	T Current = Target.load(std::memory_order_relaxed);
+	while (Current < Value && !Target.compare_exchange_weak(Current, Value, std::memory_order_relaxed))
+	{
+	}
+}
+
+FCloudWatchCurlHandlePool::FCloudWatchCurlHandlePool(int32 InCapacity, int32 InAcquireTimeoutMs)
+	: Capacity(FMath::Max(1, InCapacity))
+	, AcquireTimeoutMs(FMath::Max(0, InAcquireTimeoutMs))
+	, FreeHead(0)
+	, Waiters(0)
+	, InUse(0)
+	, PeakInUse(0)
+	, Acquires(0)
+	, Waits(0)
+	, Timeouts(0)
+	, TotalWaitUs(0)
+	, MaxWaitUs(0)
+{
+	Slots.reset(new FSlot[Capacity]);
+	for (int32 Index = Capacity - 1; Index >= 0; --Index)
+	{
+		Push(Index);
+	}
+}
+
+FCloudWatchCurlHandlePool::~FCloudWatchCurlHandlePool()
+{
+	for (int32 Index = 0; Index < Capacity; ++Index)
+	{
+		if (Slots[Index].Handle) curl_easy_cleanup(static_cast<CURL*>(Slots[Index].Handle));
+	}
+}
+
+int32 FCloudWatchCurlHandlePool::Pop()
+{
+	uint64 Head = FreeHead.load(std::memory_order_acquire);
+	while (true)
+	{
+		const uint32 Top = static_cast<uint32>(Head);
+		if (Top == 0) return INDEX_NONE;
+
+		// the tag changes on every push and pop, so a slot popped and pushed back in between fails the exchange
+		const uint32 Next = Slots[Top - 1].Next.load(std::memory_order_relaxed);
+		const uint64 NewHead = (((Head >> 32) + 1) << 32) | Next;
+		if (FreeHead.compare_exchange_weak(Head, NewHead, std::memory_order_acq_rel, std::memory_order_acquire))
+		{
+			return static_cast<int32>(Top - 1);
+		}
+	}
+}
+
+void FCloudWatchCurlHandlePool::Push(int32 Index)
+{
+	uint64 Head = FreeHead.load(std::memory_order_relaxed);
+	uint64 NewHead = 0;
+	do
+	{
+		Slots[Index].Next.store(static_cast<uint32>(Head), std::memory_order_relaxed);
+		NewHead = (((Head >> 32) + 1) << 32) | static_cast<uint32>(Index + 1);
+	}
+	// seq_cst pairs with the Waiters check so a release can't miss a thread about to sleep
+	while (!FreeHead.compare_exchange_weak(Head, NewHead, std::memory_order_seq_cst, std::memory_order_relaxed));
+}
+
+int32 FCloudWatchCurlHandlePool::Acquire(void*& OutHandle)
+{
+	OutHandle = nullptr;
+	Acquires.fetch_add(1, std::memory_order_relaxed);
+
+	int32 Index = Pop();
+	if (Index == INDEX_NONE)
+	{
+		// pool exhausted => wait for a release, bounded by the timeout
+		Waits.fetch_add(1, std::memory_order_relaxed);
+		const auto Start = std::chrono::steady_clock::now();
+
+		Waiters.fetch_add(1, std::memory_order_seq_cst);
+		{
+			std::unique_lock<std::mutex> Lock(WaitLock);
+			WaitSignal.wait_until(Lock, Start + std::chrono::milliseconds(AcquireTimeoutMs), [this, &Index]()
+			{
+				Index = Pop();
+				return Index != INDEX_NONE;
+			});
+		}
+		Waiters.fetch_sub(1, std::memory_order_seq_cst);
+
+		const uint64 WaitUs = static_cast<uint64>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - Start).count());
+		TotalWaitUs.fetch_add(WaitUs, std::memory_order_relaxed);
+		AtomicMax(MaxWaitUs, WaitUs);
+
+		if (Index == INDEX_NONE)
+		{
+			Timeouts.fetch_add(1, std::memory_order_relaxed);
+			return INDEX_NONE;
+		}
+	}
+
+	FSlot& Slot = Slots[Index];
+	if (!Slot.Handle)
+	{
+		Slot.Handle = curl_easy_init();
+		if (!Slot.Handle)
+		{
+			Push(Index);
+			return INDEX_NONE;
+		}
+	}
+
+	AtomicMax(PeakInUse, InUse.fetch_add(1, std::memory_order_relaxed) + 1);
+	OutHandle = Slot.Handle;
+	return Index;
+}
+
+void FCloudWatchCurlHandlePool::Release(int32 Index, bool bDiscard)
+{
+	FSlot& Slot = Slots[Index];
+	if (bDiscard)
+	{
+		curl_easy_cleanup(static_cast<CURL*>(Slot.Handle));
+		Slot.Handle = nullptr;
+	}
+	else
+	{
+		// keeps the handle's caches, drops every option of the last request
+		curl_easy_reset(static_cast<CURL*>(Slot.Handle));
+	}
+
+	InUse.fetch_sub(1, std::memory_order_relaxed);
+	Push(Index);
+
+	if (Waiters.load(std::memory_order_seq_cst) > 0)
+	{
+		std::lock_guard<std::mutex> Lock(WaitLock);
+		WaitSignal.notify_one();
+	}
+}
+
+FCloudWatchCurlPoolStats FCloudWatchCurlHandlePool::GetStats() const
+{
+	FCloudWatchCurlPoolStats Stats;
+	Stats.Capacity = Capacity;
+	Stats.InUse = InUse.load(std::memory_order_relaxed);
+	Stats.PeakInUse = PeakInUse.load(std::memory_order_relaxed);
+	Stats.Acquires = Acquires.load(std::memory_order_relaxed);
+	Stats.Waits = Waits.load(std::memory_order_relaxed);
+	Stats.Timeouts = Timeouts.load(std::memory_order_relaxed);
+	Stats.TotalWaitMs = TotalWaitUs.load(std::memory_order_relaxed) / 1000.0;
+	Stats.MaxWaitMs = MaxWaitUs.load(std::memory_order_relaxed) / 1000.0;
+	return Stats;
+}
+
+#endif
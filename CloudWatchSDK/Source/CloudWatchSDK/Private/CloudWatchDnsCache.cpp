@@ -0,0 +1,279 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#include "CloudWatchDnsCache.h"
+#include "CloudWatchGlobals.h"
+
+#if WITH_CLOUDWATCH && WITH_CLOUDWATCH_CURL
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <aws/core/utils/memory/AWSMemory.h>
+#include <aws/core/utils/memory/stl/AWSStringStream.h>
+
+#include <curl/curl.h>
+
+#if PLATFORM_WINDOWS
+	#include <winsock2.h>
+	#include <ws2tcpip.h>
+#else
+	#include <arpa/inet.h>
+	#include <netdb.h>
+	#include <netinet/in.h>
+	#include <sys/socket.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+static const char* ALLOCATION_TAG = "CloudWatchDnsCache";
+
+// a failed resolve is retried sooner than a TTL, the old addresses are used meanwhile
+static const std::chrono::seconds FailedResolveRetry(5);
+// hosts nobody asked for during this many TTLs are dropped
+static const int32 EvictAfterTtls = 10;
+
+FCloudWatchDnsRecord::~FCloudWatchDnsRecord()
+{
+	for (void* List : ResolveLists)
+	{
+		curl_slist_free_all(static_cast<curl_slist*>(List));
+	}
+}
+
+FCloudWatchDnsCache::FCloudWatchDnsCache(int32 TtlSeconds)
+	: Ttl(FMath::Max(1, TtlSeconds))
+	, bStop(false)
+	, Rotation(0)
+	, Hits(0)
+	, Misses(0)
+	, Resolves(0)
+	, FailedResolves(0)
+{
+	RefreshThread = std::thread(&FCloudWatchDnsCache::RefreshLoop, this);
+}
+
+FCloudWatchDnsCache::~FCloudWatchDnsCache()
+{
+	{
+		std::lock_guard<std::mutex> Guard(Lock);
+		bStop = true;
+	}
+	Signal.notify_all();
+	// a resolve in progress is bounded by the system resolver's own timeout
+	RefreshThread.join();
+}
+
+Aws::String FCloudWatchDnsCache::MakeKey(const Aws::String& Host, uint16 Port)
+{
+	Aws::StringStream Key;
+	Key << Host << ':' << Port;
+	return Key.str();
+}
+
+std::shared_ptr<const FCloudWatchDnsRecord> FCloudWatchDnsCache::Find(const Aws::Http::URI& Uri, void*& OutResolveList)
+{
+	OutResolveList = nullptr;
+	const Aws::String Key = MakeKey(Uri.GetAuthority(), Uri.GetPort());
+
+	std::shared_ptr<const FCloudWatchDnsRecord> Record;
+	{
+		std::lock_guard<std::mutex> Guard(Lock);
+		FEntry& Entry = Entries[Key];
+		Entry.LastUsed = std::chrono::steady_clock::now();
+		Record = Entry.Record;
+		// a host that failed to resolve is retried by the refresh thread
+		if (!Record && !Entry.bQueued && Entry.RefreshAt <= Entry.LastUsed)
+		{
+			Queue(Uri.GetAuthority(), Uri.GetPort(), Entry);
+		}
+	}
+
+	if (!Record)
+	{
+		Misses.fetch_add(1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	Hits.fetch_add(1, std::memory_order_relaxed);
+	const uint32 Index = Rotation.fetch_add(1, std::memory_order_relaxed) % static_cast<uint32>(Record->ResolveLists.size());
+	OutResolveList = Record->ResolveLists[Index];
+	return Record;
+}
+
+void FCloudWatchDnsCache::Prime(const Aws::Http::URI& Uri)
+{
+	const Aws::String Key = MakeKey(Uri.GetAuthority(), Uri.GetPort());
+
+	std::lock_guard<std::mutex> Guard(Lock);
+	FEntry& Entry = Entries[Key];
+	Entry.LastUsed = std::chrono::steady_clock::now();
+	if (!Entry.Record && !Entry.bQueued && Entry.RefreshAt <= Entry.LastUsed)
+	{
+		Queue(Uri.GetAuthority(), Uri.GetPort(), Entry);
+	}
+}
+
+void FCloudWatchDnsCache::Queue(const Aws::String& Host, uint16 Port, FEntry& Entry)
+{
+	Entry.Host = Host;
+	Entry.Port = Port;
+	Entry.bQueued = true;
+	Pending.emplace_back(Host, Port);
+	Signal.notify_one();
+}
+
+FCloudWatchDnsCacheStats FCloudWatchDnsCache::GetStats() const
+{
+	FCloudWatchDnsCacheStats Stats;
+	{
+		std::lock_guard<std::mutex> Guard(Lock);
+		Stats.Hosts = static_cast<int32>(Entries.size());
+	}
+	Stats.Hits = Hits.load(std::memory_order_relaxed);
+	Stats.Misses = Misses.load(std::memory_order_relaxed);
+	Stats.Resolves = Resolves.load(std::memory_order_relaxed);
+	Stats.FailedResolves = FailedResolves.load(std::memory_order_relaxed);
+	return Stats;
+}
+
+void FCloudWatchDnsCache::RefreshLoop()
+{
+	Aws::Vector<std::pair<Aws::String, uint16>> Due;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> Guard(Lock);
+			auto Now = std::chrono::steady_clock::now();
+			auto Wakeup = Now + Ttl;
+			for (auto It = Entries.begin(); It != Entries.end();)
+			{
+				FEntry& Entry = It->second;
+				if (Now - Entry.LastUsed > Ttl * EvictAfterTtls)
+				{
+					It = Entries.erase(It);
+					continue;
+				}
+				if (!Entry.bQueued && Entry.RefreshAt != std::chrono::steady_clock::time_point())
+				{
+					// lookups keep getting the current addresses until the new ones are in
+					if (Entry.RefreshAt <= Now) Queue(Entry.Host, Entry.Port, Entry);
+					else Wakeup = std::min(Wakeup, Entry.RefreshAt);
+				}
+				++It;
+			}
+
+			Signal.wait_until(Guard, Wakeup, [this]() { return bStop || !Pending.empty(); });
+			if (bStop) break;
+			Due.swap(Pending);
+		}
+
+		for (const auto& Host : Due)
+		{
+			std::shared_ptr<const FCloudWatchDnsRecord> Record = Resolve(Host.first, Host.second);
+			Resolves.fetch_add(1, std::memory_order_relaxed);
+			if (!Record)
+			{
+				FailedResolves.fetch_add(1, std::memory_order_relaxed);
+				LOG_WARNING(FString::Printf(TEXT("Resolving %s failed, retrying in %d seconds."), UTF8_TO_TCHAR(Host.first.c_str()), static_cast<int32>(FailedResolveRetry.count())));
+			}
+
+			std::lock_guard<std::mutex> Guard(Lock);
+			auto It = Entries.find(MakeKey(Host.first, Host.second));
+			if (It == Entries.end()) continue;
+
+			FEntry& Entry = It->second;
+			Entry.bQueued = false;
+			Entry.RefreshAt = std::chrono::steady_clock::now() + (Record ? std::chrono::seconds(Ttl) : FailedResolveRetry);
+			if (Record) Entry.Record = std::move(Record);
+		}
+		Due.clear();
+	}
+}
+
+std::shared_ptr<const FCloudWatchDnsRecord> FCloudWatchDnsCache::Resolve(const Aws::String& Host, uint16 Port)
+{
+	addrinfo Hints;
+	memset(&Hints, 0, sizeof(Hints));
+	Hints.ai_family = AF_UNSPEC;
+	Hints.ai_socktype = SOCK_STREAM;
+
+	addrinfo* Result = nullptr;
+	if (getaddrinfo(Host.c_str(), nullptr, &Hints, &Result) != 0 || !Result)
+	{
+		return nullptr;
+	}
+
+	auto Record = Aws::MakeShared<FCloudWatchDnsRecord>(ALLOCATION_TAG);
+	Record->Host = Host;
+	Record->Port = Port;
+	for (const addrinfo* Info = Result; Info; Info = Info->ai_next)
+	{
+		char Address[INET6_ADDRSTRLEN] = { 0 };
+		if (Info->ai_family == AF_INET)
+		{
+			inet_ntop(AF_INET, &reinterpret_cast<const sockaddr_in*>(Info->ai_addr)->sin_addr, Address, sizeof(Address));
+			Record->Addresses.push_back(Address);
+		}
+		else if (Info->ai_family == AF_INET6)
+		{
+			inet_ntop(AF_INET6, &reinterpret_cast<const sockaddr_in6*>(Info->ai_addr)->sin6_addr, Address, sizeof(Address));
+			Record->Addresses.push_back(Aws::String("[") + Address + "]");
+		}
+	}
+	freeaddrinfo(Result);
+
+	auto Last = std::unique(Record->Addresses.begin(), Record->Addresses.end());
+	Record->Addresses.erase(Last, Record->Addresses.end());
+	if (Record->Addresses.empty()) return nullptr;
+
+	const size_t Count = Record->Addresses.size();
+	for (size_t First = 0; First < Count; ++First)
+	{
+		Aws::StringStream Entry;
+#if LIBCURL_VERSION_NUM >= 0x074B00
+		// lets curl's own copy expire when this host isn't requested anymore
+		Entry << '+';
+#endif
+		Entry << Host << ':' << Port << ':';
+#if LIBCURL_VERSION_NUM >= 0x073B00
+		for (size_t Offset = 0; Offset < Count; ++Offset)
+		{
+			if (Offset > 0) Entry << ',';
+			Entry << Record->Addresses[(First + Offset) % Count];
+		}
+#else
+		// one address per entry before 7.59
+		Entry << Record->Addresses[First];
+#endif
+#if LIBCURL_VERSION_NUM >= 0x074B00
+		Record->ResolveLists.push_back(curl_slist_append(nullptr, Entry.str().c_str()));
+#else
+		// before 7.75 CURLOPT_RESOLVE entries stay in curl's cache for good and a second entry for the same host
+		// is ignored, so drop the one an earlier transfer loaded before adding the current addresses
+		Aws::StringStream Removal;
+		Removal << '-' << Host << ':' << Port;
+		curl_slist* List = curl_slist_append(nullptr, Removal.str().c_str());
+		Record->ResolveLists.push_back(curl_slist_append(List, Entry.str().c_str()));
+#endif
+	}
+	return Record;
+}
+
+#endif
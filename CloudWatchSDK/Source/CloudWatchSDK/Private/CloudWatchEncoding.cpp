@@ -0,0 +1,408 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#include "CloudWatchEncoding.h"
+#include "CloudWatchCpuFeatures.h"
+
+#if WITH_CLOUDWATCH
+
+#if CLOUDWATCH_X64
+	#include <immintrin.h>
+#endif
+
+#include <cstring>
+
+enum class ECodecLevel : uint8
+{
+	Scalar,
+	Sse2,
+	Ssse3,
+	Avx2
+};
+
+static ECodecLevel GetCodecLevel()
+{
+	static const ECodecLevel Level = []()
+	{
+		const FCloudWatchCpuFeatures& Cpu = FCloudWatchCpuFeatures::Get();
+		if (Cpu.bAvx2 && Cpu.bSsse3) return ECodecLevel::Avx2;
+		if (Cpu.bSsse3) return ECodecLevel::Ssse3;
+		return Cpu.bSse2 ? ECodecLevel::Sse2 : ECodecLevel::Scalar;
+	}();
+	return Level;
+}
+
+static const char HexDigits[] = "0123456789abcdef";
+static const char Base64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// 0-15 for hex digits of either case, 0xFF otherwise
+static const uint8* GetHexValues()
+{
+	struct FTable
+	{
+		uint8 Values[256];
+		FTable()
+		{
+			std::memset(Values, 0xFF, sizeof(Values));
+			for (int32 Index = 0; Index < 10; ++Index) Values['0' + Index] = static_cast<uint8>(Index);
+			for (int32 Index = 0; Index < 6; ++Index)
+			{
+				Values['a' + Index] = static_cast<uint8>(10 + Index);
+				Values['A' + Index] = static_cast<uint8>(10 + Index);
+			}
+		}
+	};
+	static const FTable Table;
+	return Table.Values;
+}
+
+// 0-63 for the alphabet, 0xFF otherwise
+static const uint8* GetBase64Values()
+{
+	struct FTable
+	{
+		uint8 Values[256];
+		FTable()
+		{
+			std::memset(Values, 0xFF, sizeof(Values));
+			for (int32 Index = 0; Index < 64; ++Index) Values[static_cast<uint8>(Base64Alphabet[Index])] = static_cast<uint8>(Index);
+		}
+	};
+	static const FTable Table;
+	return Table.Values;
+}
+
+static void HexEncodeScalar(const uint8* Data, size_t Length, char* OutHex)
+{
+	for (size_t Index = 0; Index < Length; ++Index)
+	{
+		OutHex[2 * Index] = HexDigits[Data[Index] >> 4];
+		OutHex[2 * Index + 1] = HexDigits[Data[Index] & 0x0F];
+	}
+}
+
+static bool HexDecodeScalar(const char* Hex, size_t Length, uint8* OutData)
+{
+	const uint8* Values = GetHexValues();
+	for (size_t Index = 0; Index < Length; Index += 2)
+	{
+		const uint8 High = Values[static_cast<uint8>(Hex[Index])];
+		const uint8 Low = Values[static_cast<uint8>(Hex[Index + 1])];
+		if ((High | Low) & 0xF0) return false;
+		OutData[Index / 2] = static_cast<uint8>((High << 4) | Low);
+	}
+	return true;
+}
+
+static void Base64EncodeScalar(const uint8* Data, size_t Length, char* OutText)
+{
+	size_t Index = 0;
+	for (; Index + 3 <= Length; Index += 3, OutText += 4)
+	{
+		const uint32 Triple = (uint32(Data[Index]) << 16) | (uint32(Data[Index + 1]) << 8) | Data[Index + 2];
+		OutText[0] = Base64Alphabet[Triple >> 18];
+		OutText[1] = Base64Alphabet[(Triple >> 12) & 0x3F];
+		OutText[2] = Base64Alphabet[(Triple >> 6) & 0x3F];
+		OutText[3] = Base64Alphabet[Triple & 0x3F];
+	}
+
+	const size_t Remaining = Length - Index;
+	if (Remaining > 0)
+	{
+		const uint32 Triple = (uint32(Data[Index]) << 16) | (Remaining > 1 ? uint32(Data[Index + 1]) << 8 : 0);
+		OutText[0] = Base64Alphabet[Triple >> 18];
+		OutText[1] = Base64Alphabet[(Triple >> 12) & 0x3F];
+		OutText[2] = Remaining > 1 ? Base64Alphabet[(Triple >> 6) & 0x3F] : '=';
+		OutText[3] = '=';
+	}
+}
+
+static bool Base64DecodeScalar(const char* Text, size_t Length, uint8* OutData, size_t& OutLength)
+{
+	const uint8* Values = GetBase64Values();
+	size_t Written = 0;
+	for (size_t Index = 0; Index < Length; Index += 4)
+	{
+		const bool bLast = Index + 4 == Length;
+		const size_t Padding = bLast ? (Text[Index + 3] == '=') + (Text[Index + 3] == '=' && Text[Index + 2] == '=') : 0;
+
+		uint32 Quad = 0;
+		for (size_t Offset = 0; Offset < 4 - Padding; ++Offset)
+		{
+			const uint8 Value = Values[static_cast<uint8>(Text[Index + Offset])];
+			if (Value == 0xFF) return false;
+			Quad |= uint32(Value) << (18 - 6 * Offset);
+		}
+
+		OutData[Written++] = static_cast<uint8>(Quad >> 16);
+		if (Padding < 2) OutData[Written++] = static_cast<uint8>(Quad >> 8);
+		if (Padding < 1) OutData[Written++] = static_cast<uint8>(Quad);
+	}
+	OutLength = Written;
+	return true;
+}
+
+#if CLOUDWATCH_X64
+
+// nibbles to '0'-'9' and 'a'-'f': add '0', and 39 more past 9
+static inline __m128i NibblesToHexSse2(__m128i Nibbles)
+{
+	const __m128i Letters = _mm_and_si128(_mm_cmpgt_epi8(Nibbles, _mm_set1_epi8(9)), _mm_set1_epi8('a' - '0' - 10));
+	return _mm_add_epi8(_mm_add_epi8(Nibbles, _mm_set1_epi8('0')), Letters);
+}
+
+static size_t HexEncodeSse2(const uint8* Data, size_t Length, char* OutHex)
+{
+	const __m128i LowMask = _mm_set1_epi8(0x0F);
+	size_t Index = 0;
+	for (; Index + 16 <= Length; Index += 16)
+	{
+		const __m128i Bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Data + Index));
+		const __m128i High = NibblesToHexSse2(_mm_and_si128(_mm_srli_epi16(Bytes, 4), LowMask));
+		const __m128i Low = NibblesToHexSse2(_mm_and_si128(Bytes, LowMask));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(OutHex + 2 * Index), _mm_unpacklo_epi8(High, Low));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(OutHex + 2 * Index + 16), _mm_unpackhi_epi8(High, Low));
+	}
+	return Index;
+}
+
+CLOUDWATCH_TARGET("avx2")
+static size_t HexEncodeAvx2(const uint8* Data, size_t Length, char* OutHex)
+{
+	const __m256i LowMask = _mm256_set1_epi8(0x0F);
+	const __m256i Nine = _mm256_set1_epi8(9);
+	const __m256i Zero = _mm256_set1_epi8('0');
+	const __m256i LetterOffset = _mm256_set1_epi8('a' - '0' - 10);
+	size_t Index = 0;
+	for (; Index + 32 <= Length; Index += 32)
+	{
+		const __m256i Bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Data + Index));
+		__m256i High = _mm256_and_si256(_mm256_srli_epi16(Bytes, 4), LowMask);
+		__m256i Low = _mm256_and_si256(Bytes, LowMask);
+		High = _mm256_add_epi8(_mm256_add_epi8(High, Zero), _mm256_and_si256(_mm256_cmpgt_epi8(High, Nine), LetterOffset));
+		Low = _mm256_add_epi8(_mm256_add_epi8(Low, Zero), _mm256_and_si256(_mm256_cmpgt_epi8(Low, Nine), LetterOffset));
+
+		// unpacks stay within 128 bit lanes, the permutes put the halves back in order
+		const __m256i First = _mm256_unpacklo_epi8(High, Low);
+		const __m256i Second = _mm256_unpackhi_epi8(High, Low);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(OutHex + 2 * Index), _mm256_permute2x128_si256(First, Second, 0x20));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(OutHex + 2 * Index + 32), _mm256_permute2x128_si256(First, Second, 0x31));
+	}
+	return Index;
+}
+
+// hex chars to nibbles. Sets Invalid lanes for chars that aren't hex digits
+static inline __m128i HexToNibblesSse2(__m128i Chars, __m128i& Invalid)
+{
+	const __m128i Digits = _mm_sub_epi8(Chars, _mm_set1_epi8('0'));
+	// setting 0x20 lower cases letters and leaves digits alone
+	const __m128i Letters = _mm_sub_epi8(_mm_or_si128(Chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a' - 10));
+
+	// unsigned range checks through the sign flip
+	const __m128i Flip = _mm_set1_epi8(static_cast<char>(0x80));
+	const __m128i bDigit = _mm_cmplt_epi8(_mm_xor_si128(Digits, Flip), _mm_set1_epi8(static_cast<char>(10 ^ 0x80)));
+	const __m128i LetterOffset = _mm_sub_epi8(Letters, _mm_set1_epi8(10));
+	const __m128i bLetter = _mm_cmplt_epi8(_mm_xor_si128(LetterOffset, Flip), _mm_set1_epi8(static_cast<char>(6 ^ 0x80)));
+
+	Invalid = _mm_or_si128(Invalid, _mm_andnot_si128(_mm_or_si128(bDigit, bLetter), _mm_set1_epi8(static_cast<char>(0xFF))));
+	return _mm_or_si128(_mm_and_si128(bDigit, Digits), _mm_and_si128(bLetter, Letters));
+}
+
+static size_t HexDecodeSse2(const char* Hex, size_t Length, uint8* OutData, bool& bValid)
+{
+	const __m128i LowByte = _mm_set1_epi16(0x00FF);
+	size_t Index = 0;
+	for (; Index + 32 <= Length; Index += 32)
+	{
+		__m128i Invalid = _mm_setzero_si128();
+		const __m128i First = HexToNibblesSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Hex + Index)), Invalid);
+		const __m128i Second = HexToNibblesSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Hex + Index + 16)), Invalid);
+		if (_mm_movemask_epi8(Invalid) != 0)
+		{
+			bValid = false;
+			return Index;
+		}
+
+		// each 16 bit lane holds the high nibble in its low byte and the low nibble in its high byte
+		const __m128i FirstBytes = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(First, LowByte), 4), _mm_srli_epi16(First, 8));
+		const __m128i SecondBytes = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(Second, LowByte), 4), _mm_srli_epi16(Second, 8));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(OutData + Index / 2), _mm_packus_epi16(FirstBytes, SecondBytes));
+	}
+	return Index;
+}
+
+// 16 input bytes, of which the first 12 are encoded, to 16 chars
+CLOUDWATCH_TARGET("ssse3")
+static inline __m128i Base64EncodeBlockSsse3(__m128i Bytes)
+{
+	// split 3 bytes into 4 six bit indices, one per byte
+	Bytes = _mm_shuffle_epi8(Bytes, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+	const __m128i Shifted1 = _mm_mulhi_epu16(_mm_and_si128(Bytes, _mm_set1_epi32(0x0FC0FC00)), _mm_set1_epi32(0x04000040));
+	const __m128i Shifted2 = _mm_mullo_epi16(_mm_and_si128(Bytes, _mm_set1_epi32(0x003F03F0)), _mm_set1_epi32(0x01000010));
+	const __m128i Indices = _mm_or_si128(Shifted1, Shifted2);
+
+	// map each index range of the alphabet to the offset that turns it into its char
+	__m128i Range = _mm_subs_epu8(Indices, _mm_set1_epi8(51));
+	Range = _mm_or_si128(Range, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), Indices), _mm_set1_epi8(13)));
+	const __m128i Offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+		'0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+	return _mm_add_epi8(_mm_shuffle_epi8(Offsets, Range), Indices);
+}
+
+CLOUDWATCH_TARGET("ssse3")
+static size_t Base64EncodeSsse3(const uint8* Data, size_t Length, char* OutText)
+{
+	// loads read 16 bytes to encode 12
+	size_t Index = 0;
+	for (; Index + 16 <= Length; Index += 12, OutText += 16)
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(OutText), Base64EncodeBlockSsse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Data + Index))));
+	}
+	return Index;
+}
+
+// 16 chars to 12 bytes. Stops at the first block holding a char outside the alphabet, padding included
+CLOUDWATCH_TARGET("ssse3")
+static void Base64DecodeSsse3(const char* Text, size_t Length, uint8* OutData, size_t& OutConsumed, size_t& OutWritten)
+{
+	const __m128i LowLookup = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+	const __m128i HighLookup = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+	const __m128i RollLookup = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+	const __m128i Mask2F = _mm_set1_epi8(0x2F);
+
+	size_t Index = 0;
+	size_t Written = 0;
+	// the store writes 16 bytes for 12, so 8 more chars must follow
+	for (; Index + 24 <= Length; Index += 16, Written += 12)
+	{
+		__m128i Chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Text + Index));
+		const __m128i HighNibbles = _mm_and_si128(_mm_srli_epi32(Chars, 4), Mask2F);
+		const __m128i LowNibbles = _mm_and_si128(Chars, Mask2F);
+		const __m128i High = _mm_shuffle_epi8(HighLookup, HighNibbles);
+		const __m128i Low = _mm_shuffle_epi8(LowLookup, LowNibbles);
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(Low, High), _mm_setzero_si128())) != 0xFFFF) break;
+
+		// chars to their six bit values; '/' shares its high nibble with '+' and is told apart by the compare
+		const __m128i Slash = _mm_cmpeq_epi8(Chars, Mask2F);
+		Chars = _mm_add_epi8(Chars, _mm_shuffle_epi8(RollLookup, _mm_add_epi8(Slash, HighNibbles)));
+
+		// pack four six bit values into three bytes, then drop the gaps
+		const __m128i Pairs = _mm_maddubs_epi16(Chars, _mm_set1_epi32(0x01400140));
+		const __m128i Quads = _mm_madd_epi16(Pairs, _mm_set1_epi32(0x00011000));
+		const __m128i Bytes = _mm_shuffle_epi8(Quads, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(OutData + Written), Bytes);
+	}
+	OutConsumed = Index;
+	OutWritten = Written;
+}
+
+#endif
+
+void FCloudWatchEncoding::HexEncode(const uint8* Data, size_t Length, char* OutHex)
+{
+	size_t Done = 0;
+#if CLOUDWATCH_X64
+	const ECodecLevel Level = GetCodecLevel();
+	if (Level == ECodecLevel::Avx2)
+	{
+		Done = HexEncodeAvx2(Data, Length, OutHex);
+	}
+	if (Level >= ECodecLevel::Sse2)
+	{
+		Done += HexEncodeSse2(Data + Done, Length - Done, OutHex + 2 * Done);
+	}
+#endif
+	HexEncodeScalar(Data + Done, Length - Done, OutHex + 2 * Done);
+}
+
+void FCloudWatchEncoding::HexEncode(const uint8* Data, size_t Length, Aws::String& Out)
+{
+	Out.resize(2 * Length);
+	HexEncode(Data, Length, &Out[0]);
+}
+
+bool FCloudWatchEncoding::HexDecode(const char* Hex, size_t Length, uint8* OutData)
+{
+	if (Length % 2 != 0) return false;
+
+	size_t Done = 0;
+#if CLOUDWATCH_X64
+	if (GetCodecLevel() >= ECodecLevel::Sse2)
+	{
+		bool bValid = true;
+		Done = HexDecodeSse2(Hex, Length, OutData, bValid);
+		if (!bValid) return false;
+	}
+#endif
+	return HexDecodeScalar(Hex + Done, Length - Done, OutData + Done / 2);
+}
+
+void FCloudWatchEncoding::Base64Encode(const uint8* Data, size_t Length, char* OutText)
+{
+	size_t Done = 0;
+#if CLOUDWATCH_X64
+	if (GetCodecLevel() >= ECodecLevel::Ssse3)
+	{
+		Done = Base64EncodeSsse3(Data, Length, OutText);
+	}
+#endif
+	Base64EncodeScalar(Data + Done, Length - Done, OutText + Done / 3 * 4);
+}
+
+void FCloudWatchEncoding::Base64Encode(const uint8* Data, size_t Length, Aws::String& Out)
+{
+	Out.resize(Base64EncodedLength(Length));
+	if (Length > 0)
+	{
+		Base64Encode(Data, Length, &Out[0]);
+	}
+}
+
+size_t FCloudWatchEncoding::Base64DecodedLength(const char* Text, size_t Length)
+{
+	if (Length < 4) return 0;
+	return Length / 4 * 3 - (Text[Length - 1] == '=') - (Text[Length - 2] == '=');
+}
+
+bool FCloudWatchEncoding::Base64Decode(const char* Text, size_t Length, uint8* OutData, size_t& OutLength)
+{
+	OutLength = 0;
+	if (Length % 4 != 0) return false;
+
+	size_t Consumed = 0;
+	size_t Written = 0;
+#if CLOUDWATCH_X64
+	if (GetCodecLevel() >= ECodecLevel::Ssse3)
+	{
+		// an invalid char ends the vector loop early and is reported by the scalar one
+		Base64DecodeSsse3(Text, Length, OutData, Consumed, Written);
+	}
+#endif
+	size_t Tail = 0;
+	if (!Base64DecodeScalar(Text + Consumed, Length - Consumed, OutData + Written, Tail)) return false;
+	OutLength = Written + Tail;
+	return true;
+}
+
+const char* FCloudWatchEncoding::GetImplementationName()
+{
+	switch (GetCodecLevel())
+	{
+	case ECodecLevel::Avx2: return "avx2";
+	case ECodecLevel::Ssse3: return "ssse3";
+	case ECodecLevel::Sse2: return "sse2";
+	default: return "scalar";
+	}
+}
+
+#endif
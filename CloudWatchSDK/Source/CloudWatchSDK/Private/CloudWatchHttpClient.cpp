@@ -0,0 +1,931 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#include "CloudWatchHttpClient.h"
+#include "CloudWatchGlobals.h"
+#include "CloudWatchRequestHedger.h"
+
+#if WITH_CLOUDWATCH && WITH_CLOUDWATCH_CURL
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <aws/core/http/standard/StandardHttpRequest.h>
+#include <aws/core/http/standard/StandardHttpResponse.h>
+#include <aws/core/monitoring/HttpClientMetrics.h>
+#include <aws/core/utils/StringUtils.h>
+#include <aws/core/utils/memory/stl/AWSStringStream.h>
+#include <aws/core/utils/ratelimiter/RateLimiterInterface.h>
+#include <aws/core/utils/stream/ResponseStream.h>
+#if PLATFORM_WINDOWS
+	#include <aws/core/http/windows/WinHttpSyncHttpClient.h>
+	#include <aws/core/http/windows/WinINetSyncHttpClient.h>
+#endif
+
+#include <curl/curl.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+using namespace Aws::Http;
+using Aws::Utils::RateLimits::RateLimiterInterface;
+
+static const char* ALLOCATION_TAG = "CloudWatchHttpClient";
+
+// response buffers are pre-sized from Content-Length up to this, larger bodies grow as they arrive
+static const size_t MaxResponseReserveBytes = 64 * 1024 * 1024;
+
+// curl_multi_poll/curl_multi_wakeup let a new request interrupt the wait; older libcurl has to poll with a short timeout
+#if LIBCURL_VERSION_NUM >= 0x074400
+	#define CLOUDWATCH_CURL_HAS_WAKEUP 1
+	static const long MaxPollWaitMs = 1000;
+#else
+	#define CLOUDWATCH_CURL_HAS_WAKEUP 0
+	static const long MaxPollWaitMs = 5;
+#endif
+
+struct FCloudWatchCurlTransfer
+{
+	FCloudWatchCurlMulti* Owner = nullptr;
+	const FCloudWatchCurlHttpClient* Client = nullptr;
+	FCloudWatchCurlHandlePool* Pool = nullptr;
+	int32 PoolSlot = INDEX_NONE;
+	CURL* Handle = nullptr;
+	curl_slist* Headers = nullptr;
+	std::shared_ptr<HttpRequest> Request;
+	std::shared_ptr<Standard::StandardHttpResponse> Response;
+	// body stream of Response when it was switched to a pooled buffer
+	FCloudWatchPooledResponseStream* PooledBody = nullptr;
+	// owns the CURLOPT_RESOLVE list
+	std::shared_ptr<const FCloudWatchDnsRecord> DnsRecord;
+	RateLimiterInterface* ReadLimiter = nullptr;
+	RateLimiterInterface* WriteLimiter = nullptr;
+	FCloudWatchHttpCallback Callback;
+
+	// set from the transfer callbacks when a limiter asks to back off; the I/O thread pauses the transfer until ResumeAt
+	std::chrono::steady_clock::time_point ResumeAt;
+	bool bThrottled = false;
+	bool bPaused = false;
+	size_t RunningIndex = 0;
+
+	char ErrorBuffer[CURL_ERROR_SIZE];
+
+	bool ShouldContinue() const
+	{
+		return Client->ContinueRequest(*Request) && Client->IsProcessingEnabled();
+	}
+
+	void Throttle(RateLimiterInterface::DelayType Delay)
+	{
+		if (Delay.count() <= 0) return;
+
+		const auto Until = std::chrono::steady_clock::now() + Delay;
+		ResumeAt = bThrottled ? std::max(ResumeAt, Until) : Until;
+		if (!bThrottled)
+		{
+			bThrottled = true;
+			Owner->Throttled.push_back(this);
+		}
+	}
+
+	void Complete(CURLcode Result)
+	{
+		if (Result != CURLE_OK && !ShouldContinue())
+		{
+			Cancel(true);
+			return;
+		}
+		if (Result != CURLE_OK)
+		{
+			Aws::StringStream Message;
+			Message << "curlCode: " << Result << ", " << (ErrorBuffer[0] ? ErrorBuffer : curl_easy_strerror(Result));
+			Fail(Message.str());
+			return;
+		}
+
+		long ResponseCode = 0;
+		curl_easy_getinfo(Handle, CURLINFO_RESPONSE_CODE, &ResponseCode);
+		Response->SetResponseCode(static_cast<HttpResponseCode>(ResponseCode));
+
+		char* ContentType = nullptr;
+		if (curl_easy_getinfo(Handle, CURLINFO_CONTENT_TYPE, &ContentType) == CURLE_OK && ContentType)
+		{
+			Response->SetContentType(ContentType);
+		}
+
+		// same metrics the SDK's curl client reports to the monitoring interfaces
+		double Seconds = 0.0;
+		if (curl_easy_getinfo(Handle, CURLINFO_NAMELOOKUP_TIME, &Seconds) == CURLE_OK && Seconds > 0.0)
+		{
+			Request->AddRequestMetric(Aws::Monitoring::GetHttpClientMetricNameByType(Aws::Monitoring::HttpClientMetricsType::DnsLatency), static_cast<int64_t>(Seconds * 1000));
+		}
+		if (curl_easy_getinfo(Handle, CURLINFO_CONNECT_TIME, &Seconds) == CURLE_OK && Seconds > 0.0)
+		{
+			Request->AddRequestMetric(Aws::Monitoring::GetHttpClientMetricNameByType(Aws::Monitoring::HttpClientMetricsType::ConnectLatency), static_cast<int64_t>(Seconds * 1000));
+		}
+		if (curl_easy_getinfo(Handle, CURLINFO_APPCONNECT_TIME, &Seconds) == CURLE_OK && Seconds > 0.0)
+		{
+			Request->AddRequestMetric(Aws::Monitoring::GetHttpClientMetricNameByType(Aws::Monitoring::HttpClientMetricsType::SslLatency), static_cast<int64_t>(Seconds * 1000));
+		}
+
+		Finish(false);
+	}
+
+	// NETWORK_CONNECTION is retryable, so the SDK's retry strategy gets a say
+	void Fail(const Aws::String& Message)
+	{
+		Response->SetClientErrorType(Aws::Client::CoreErrors::NETWORK_CONNECTION);
+		Response->SetClientErrorMessage(Message);
+		Finish(true);
+	}
+
+	// aborted through ContinueRequest, not worth a retry
+	void Cancel(bool bDiscardHandle)
+	{
+		Response->SetClientErrorType(Aws::Client::CoreErrors::USER_CANCELLED);
+		Response->SetClientErrorMessage("Request cancelled.");
+		Finish(bDiscardHandle);
+	}
+
+	void Finish(bool bDiscardHandle)
+	{
+		if (Handle) Pool->Release(PoolSlot, bDiscardHandle);
+		if (Headers) curl_slist_free_all(Headers);
+		Handle = nullptr;
+		Headers = nullptr;
+
+		FCloudWatchHttpCallback Done = std::move(Callback);
+		const std::shared_ptr<HttpResponse> Result = Response;
+		Aws::Delete(this);
+		Done(Result);
+	}
+};
+
+static size_t WriteBody(char* Ptr, size_t Size, size_t Count, void* UserData)
+{
+	FCloudWatchCurlTransfer* Transfer = static_cast<FCloudWatchCurlTransfer*>(UserData);
+	if (!Transfer->ShouldContinue()) return 0;
+
+	const size_t Length = Size * Count;
+	Transfer->Response->GetResponseBody().write(Ptr, static_cast<std::streamsize>(Length));
+	if (Transfer->ReadLimiter)
+	{
+		Transfer->Throttle(Transfer->ReadLimiter->ApplyCost(static_cast<int64_t>(Length)));
+	}
+
+	const auto& OnReceived = Transfer->Request->GetDataReceivedEventHandler();
+	if (OnReceived) OnReceived(Transfer->Request.get(), Transfer->Response.get(), static_cast<long long>(Length));
+	return Length;
+}
+
+static size_t WriteHeader(char* Ptr, size_t Size, size_t Count, void* UserData)
+{
+	FCloudWatchCurlTransfer* Transfer = static_cast<FCloudWatchCurlTransfer*>(UserData);
+	const size_t Length = Size * Count;
+
+	const Aws::String Line(Ptr, Length);
+	const size_t Colon = Line.find(':');
+	if (Colon != Aws::String::npos)
+	{
+		const Aws::String Name = Aws::Utils::StringUtils::Trim(Line.substr(0, Colon).c_str());
+		const Aws::String Value = Aws::Utils::StringUtils::Trim(Line.substr(Colon + 1).c_str());
+		if (Transfer->PooledBody && Aws::Utils::StringUtils::CaselessCompare(Name.c_str(), CONTENT_LENGTH_HEADER))
+		{
+			// one allocation for the whole body instead of doubling as it arrives
+			const unsigned long long ContentLength = strtoull(Value.c_str(), nullptr, 10);
+			Transfer->PooledBody->Reserve(static_cast<size_t>(std::min<unsigned long long>(ContentLength, MaxResponseReserveBytes)));
+		}
+		Transfer->Response->AddHeader(Name, Value);
+	}
+	return Length;
+}
+
+static size_t ReadBody(char* Ptr, size_t Size, size_t Count, void* UserData)
+{
+	FCloudWatchCurlTransfer* Transfer = static_cast<FCloudWatchCurlTransfer*>(UserData);
+	if (!Transfer->ShouldContinue()) return CURL_READFUNC_ABORT;
+
+	const std::shared_ptr<Aws::IOStream>& Body = Transfer->Request->GetContentBody();
+	if (!Body) return 0;
+
+	Body->read(Ptr, static_cast<std::streamsize>(Size * Count));
+	const size_t Read = static_cast<size_t>(Body->gcount());
+	if (Transfer->WriteLimiter)
+	{
+		Transfer->Throttle(Transfer->WriteLimiter->ApplyCost(static_cast<int64_t>(Read)));
+	}
+
+	const auto& OnSent = Transfer->Request->GetDataSentEventHandler();
+	if (OnSent) OnSent(Transfer->Request.get(), static_cast<long long>(Read));
+	return Read;
+}
+
+static int SeekBody(void* UserData, curl_off_t Offset, int Origin)
+{
+	FCloudWatchCurlTransfer* Transfer = static_cast<FCloudWatchCurlTransfer*>(UserData);
+	const std::shared_ptr<Aws::IOStream>& Body = Transfer->Request->GetContentBody();
+	if (!Body) return CURL_SEEKFUNC_FAIL;
+
+	Body->clear();
+	switch (Origin)
+	{
+	case SEEK_SET: Body->seekg(Offset, std::ios_base::beg); break;
+	case SEEK_CUR: Body->seekg(Offset, std::ios_base::cur); break;
+	case SEEK_END: Body->seekg(Offset, std::ios_base::end); break;
+	default: return CURL_SEEKFUNC_FAIL;
+	}
+	return Body->fail() ? CURL_SEEKFUNC_FAIL : CURL_SEEKFUNC_OK;
+}
+
+static int OnProgress(void* UserData, curl_off_t, curl_off_t, curl_off_t, curl_off_t)
+{
+	// a non zero result aborts the transfer
+	return static_cast<FCloudWatchCurlTransfer*>(UserData)->ShouldContinue() ? 0 : 1;
+}
+
+static void LockShare(CURL*, curl_lock_data Data, curl_lock_access, void* UserData)
+{
+	static_cast<std::mutex*>(UserData)[Data].lock();
+}
+
+static void UnlockShare(CURL*, curl_lock_data Data, void* UserData)
+{
+	static_cast<std::mutex*>(UserData)[Data].unlock();
+}
+
+static Aws::IOStream* CreatePooledResponseStream()
+{
+	return Aws::New<FCloudWatchPooledResponseStream>(ALLOCATION_TAG, FCloudWatchBufferPool::Get().Acquire(0));
+}
+
+static std::shared_ptr<Standard::StandardHttpResponse> CreateResponse(const std::shared_ptr<HttpRequest>& Request, FCloudWatchPooledResponseStream*& OutPooledBody)
+{
+	OutPooledBody = nullptr;
+
+	// only the SDK's default string stream is replaced; a request asking for its own stream, e.g. a file, keeps it
+	typedef Aws::IOStream* (*FStreamFactoryFunction)();
+	const FStreamFactoryFunction* Factory = Request->GetResponseStreamFactory().target<FStreamFactoryFunction>();
+	if (!Factory || *Factory != &Aws::Utils::Stream::DefaultResponseStreamFactoryMethod)
+	{
+		return Aws::MakeShared<Standard::StandardHttpResponse>(ALLOCATION_TAG, Request);
+	}
+
+	// the response creates its body from the request's factory; nothing else reads the request while it's being sent
+	const Aws::IOStreamFactory Original = Request->GetResponseStreamFactory();
+	Request->SetResponseStreamFactory(CreatePooledResponseStream);
+	auto Response = Aws::MakeShared<Standard::StandardHttpResponse>(ALLOCATION_TAG, Request);
+	Request->SetResponseStreamFactory(Original);
+
+	OutPooledBody = static_cast<FCloudWatchPooledResponseStream*>(&Response->GetResponseBody());
+	return Response;
+}
+
+static void SetMethod(CURL* Handle, const HttpRequest& Request)
+{
+	const bool bHasBody = Request.GetContentBody() && !(Request.HasHeader(CONTENT_LENGTH_HEADER) && Request.GetHeaderValue(CONTENT_LENGTH_HEADER) == "0");
+	switch (Request.GetMethod())
+	{
+	case HttpMethod::HTTP_GET:
+		curl_easy_setopt(Handle, CURLOPT_HTTPGET, 1L);
+		break;
+	case HttpMethod::HTTP_POST:
+		if (bHasBody) curl_easy_setopt(Handle, CURLOPT_POST, 1L);
+		else curl_easy_setopt(Handle, CURLOPT_CUSTOMREQUEST, "POST");
+		break;
+	case HttpMethod::HTTP_PUT:
+		if (bHasBody) curl_easy_setopt(Handle, CURLOPT_UPLOAD, 1L);
+		else curl_easy_setopt(Handle, CURLOPT_CUSTOMREQUEST, "PUT");
+		break;
+	case HttpMethod::HTTP_HEAD:
+		curl_easy_setopt(Handle, CURLOPT_HTTPGET, 1L);
+		curl_easy_setopt(Handle, CURLOPT_NOBODY, 1L);
+		break;
+	case HttpMethod::HTTP_PATCH:
+		if (bHasBody) curl_easy_setopt(Handle, CURLOPT_UPLOAD, 1L);
+		curl_easy_setopt(Handle, CURLOPT_CUSTOMREQUEST, "PATCH");
+		break;
+	case HttpMethod::HTTP_DELETE:
+		curl_easy_setopt(Handle, CURLOPT_CUSTOMREQUEST, "DELETE");
+		break;
+	default:
+		curl_easy_setopt(Handle, CURLOPT_CUSTOMREQUEST, "GET");
+		break;
+	}
+}
+
+FCloudWatchCurlMulti::FCloudWatchCurlMulti(int32 MaxHostConnections /*= 0*/, bool bMultiplex /*= false*/, int32 MaxStreamsPerConnection /*= 100*/)
+	: MultiHandle(curl_multi_init())
+	, ShareHandle(curl_share_init())
+	, ShareLocks(new std::mutex[CURL_LOCK_DATA_LAST])
+	, bStop(false)
+	, ActiveTransfers(0)
+	, CompletedTransfers(0)
+	, Http2Transfers(0)
+{
+	// resumed TLS sessions skip the full handshake on every new connection; connections are already shared through the multi handle
+	CURLSH* Share = static_cast<CURLSH*>(ShareHandle);
+	curl_share_setopt(Share, CURLSHOPT_LOCKFUNC, LockShare);
+	curl_share_setopt(Share, CURLSHOPT_UNLOCKFUNC, UnlockShare);
+	curl_share_setopt(Share, CURLSHOPT_USERDATA, ShareLocks.get());
+	curl_share_setopt(Share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+	curl_share_setopt(Share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+
+	CURLM* Multi = static_cast<CURLM*>(MultiHandle);
+	if (MaxHostConnections > 0)
+	{
+		curl_multi_setopt(Multi, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(MaxHostConnections));
+	}
+#ifdef CURLPIPE_MULTIPLEX
+	if (bMultiplex)
+	{
+		curl_multi_setopt(Multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+	#if LIBCURL_VERSION_NUM >= 0x074300
+		curl_multi_setopt(Multi, CURLMOPT_MAX_CONCURRENT_STREAMS, static_cast<long>(FMath::Max(1, MaxStreamsPerConnection)));
+	#endif
+	}
+#endif
+	IoThread = std::thread(&FCloudWatchCurlMulti::IoLoop, this);
+}
+
+bool FCloudWatchCurlMulti::SupportsHttp2()
+{
+#if defined(CURLPIPE_MULTIPLEX) && LIBCURL_VERSION_NUM >= 0x072F00
+	const curl_version_info_data* Info = curl_version_info(CURLVERSION_NOW);
+	return Info && (Info->features & CURL_VERSION_HTTP2) != 0;
+#else
+	return false;
+#endif
+}
+
+FCloudWatchCurlMulti::~FCloudWatchCurlMulti()
+{
+	Shutdown();
+	curl_multi_cleanup(static_cast<CURLM*>(MultiHandle));
+	// pooled handles are gone by now, they belong to the clients holding this loop
+	curl_share_cleanup(static_cast<CURLSH*>(ShareHandle));
+}
+
+void FCloudWatchCurlMulti::Submit(FCloudWatchCurlTransfer* Transfer)
+{
+	Transfer->Owner = this;
+	{
+		std::lock_guard<std::mutex> Guard(Lock);
+		if (!bStop)
+		{
+			ActiveTransfers.fetch_add(1, std::memory_order_relaxed);
+			Incoming.push_back(Transfer);
+			Transfer = nullptr;
+		}
+	}
+
+	if (Transfer)
+	{
+		Transfer->Fail("Http client is shutting down.");
+		return;
+	}
+
+	Signal.notify_one();
+#if CLOUDWATCH_CURL_HAS_WAKEUP
+	curl_multi_wakeup(static_cast<CURLM*>(MultiHandle));
+#endif
+}
+
+void FCloudWatchCurlMulti::Shutdown()
+{
+	{
+		std::lock_guard<std::mutex> Guard(Lock);
+		if (bStop) return;
+		bStop = true;
+	}
+	Signal.notify_one();
+#if CLOUDWATCH_CURL_HAS_WAKEUP
+	curl_multi_wakeup(static_cast<CURLM*>(MultiHandle));
+#endif
+	IoThread.join();
+}
+
+void FCloudWatchCurlMulti::IoLoop()
+{
+	CURLM* Multi = static_cast<CURLM*>(MultiHandle);
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> Guard(Lock);
+			if (Running.empty())
+			{
+				Signal.wait(Guard, [this]() { return bStop || !Incoming.empty(); });
+			}
+			if (bStop) break;
+		}
+		AddIncoming();
+
+		int StillRunning = 0;
+		curl_multi_perform(Multi, &StillRunning);
+		CompleteFinished();
+		if (Running.empty()) continue;
+
+		long WaitMs = -1;
+		curl_multi_timeout(Multi, &WaitMs);
+		if (WaitMs < 0 || WaitMs > MaxPollWaitMs) WaitMs = MaxPollWaitMs;
+		UpdateThrottled(WaitMs);
+		if (WaitMs > 0) WaitForActivity(WaitMs);
+	}
+
+	// nothing completes after shutdown, fail whatever is left
+	AddIncoming();
+	while (!Running.empty())
+	{
+		FCloudWatchCurlTransfer* Transfer = Running.back();
+		Running.pop_back();
+		curl_multi_remove_handle(Multi, Transfer->Handle);
+		ActiveTransfers.fetch_sub(1, std::memory_order_relaxed);
+		Transfer->Fail("Http client is shutting down.");
+	}
+	Throttled.clear();
+}
+
+void FCloudWatchCurlMulti::AddIncoming()
+{
+	std::vector<FCloudWatchCurlTransfer*> Added;
+	{
+		std::lock_guard<std::mutex> Guard(Lock);
+		Added.swap(Incoming);
+	}
+
+	for (FCloudWatchCurlTransfer* Transfer : Added)
+	{
+		Transfer->RunningIndex = Running.size();
+		Running.push_back(Transfer);
+		curl_multi_add_handle(static_cast<CURLM*>(MultiHandle), Transfer->Handle);
+	}
+}
+
+void FCloudWatchCurlMulti::CompleteFinished()
+{
+	CURLM* Multi = static_cast<CURLM*>(MultiHandle);
+	int Remaining = 0;
+	while (CURLMsg* Message = curl_multi_info_read(Multi, &Remaining))
+	{
+		if (Message->msg != CURLMSG_DONE) continue;
+
+		// the message is invalid once the handle is removed
+		CURL* Handle = Message->easy_handle;
+		const CURLcode Result = Message->data.result;
+
+		char* Private = nullptr;
+		curl_easy_getinfo(Handle, CURLINFO_PRIVATE, &Private);
+		FCloudWatchCurlTransfer* Transfer = reinterpret_cast<FCloudWatchCurlTransfer*>(Private);
+
+#if LIBCURL_VERSION_NUM >= 0x073200
+		long HttpVersion = 0;
+		if (curl_easy_getinfo(Handle, CURLINFO_HTTP_VERSION, &HttpVersion) == CURLE_OK && HttpVersion == CURL_HTTP_VERSION_2_0)
+		{
+			Http2Transfers.fetch_add(1, std::memory_order_relaxed);
+		}
+#endif
+
+		curl_multi_remove_handle(Multi, Handle);
+		RemoveRunning(Transfer);
+		ActiveTransfers.fetch_sub(1, std::memory_order_relaxed);
+		CompletedTransfers.fetch_add(1, std::memory_order_relaxed);
+		Transfer->Complete(Result);
+	}
+}
+
+void FCloudWatchCurlMulti::UpdateThrottled(long& InOutWaitMs)
+{
+	const auto Now = std::chrono::steady_clock::now();
+	size_t Index = 0;
+	while (Index < Throttled.size())
+	{
+		FCloudWatchCurlTransfer* Transfer = Throttled[Index];
+		if (Now >= Transfer->ResumeAt)
+		{
+			Throttled[Index] = Throttled.back();
+			Throttled.pop_back();
+			Transfer->bThrottled = false;
+			if (Transfer->bPaused)
+			{
+				// may call the transfer callbacks right away, which can throttle it again
+				Transfer->bPaused = false;
+				curl_easy_pause(Transfer->Handle, CURLPAUSE_CONT);
+			}
+			continue;
+		}
+
+		if (!Transfer->bPaused)
+		{
+			Transfer->bPaused = true;
+			curl_easy_pause(Transfer->Handle, CURLPAUSE_ALL);
+		}
+
+		const long UntilResumeMs = static_cast<long>(std::chrono::duration_cast<std::chrono::milliseconds>(Transfer->ResumeAt - Now).count()) + 1;
+		InOutWaitMs = std::min(InOutWaitMs, UntilResumeMs);
+		++Index;
+	}
+}
+
+void FCloudWatchCurlMulti::WaitForActivity(long WaitMs)
+{
+	CURLM* Multi = static_cast<CURLM*>(MultiHandle);
+	int Ready = 0;
+#if CLOUDWATCH_CURL_HAS_WAKEUP
+	curl_multi_poll(Multi, nullptr, 0, static_cast<int>(WaitMs), &Ready);
+#else
+	const auto Start = std::chrono::steady_clock::now();
+	curl_multi_wait(Multi, nullptr, 0, static_cast<int>(WaitMs), &Ready);
+
+	// curl_multi_wait returns right away when there is no socket to wait on (resolving, every transfer paused)
+	const auto Deadline = Start + std::chrono::milliseconds(WaitMs);
+	if (Ready == 0 && std::chrono::steady_clock::now() < Deadline)
+	{
+		std::unique_lock<std::mutex> Guard(Lock);
+		Signal.wait_until(Guard, Deadline, [this]() { return bStop || !Incoming.empty(); });
+	}
+#endif
+}
+
+void FCloudWatchCurlMulti::RemoveRunning(FCloudWatchCurlTransfer* Transfer)
+{
+	const size_t Index = Transfer->RunningIndex;
+	Running[Index] = Running.back();
+	Running[Index]->RunningIndex = Index;
+	Running.pop_back();
+
+	if (Transfer->bThrottled)
+	{
+		Throttled.erase(std::remove(Throttled.begin(), Throttled.end(), Transfer), Throttled.end());
+	}
+}
+
+FCloudWatchCurlHttpClient::FCloudWatchCurlHttpClient(const Aws::Client::ClientConfiguration& ClientConfig, const std::shared_ptr<FCloudWatchCurlMulti>& InMulti, const FCloudWatchCurlOptions& Options,
+	const std::shared_ptr<FCloudWatchDnsCache>& InDnsCache /*= nullptr*/)
+	: Multi(InMulti)
+	, DnsCache(InDnsCache)
+	, OuterClient(nullptr)
+	, bUseHttp2(Options.bEnableHttp2 && FCloudWatchCurlMulti::SupportsHttp2())
+	, HandlePool(static_cast<int32>(FMath::Max(1u, ClientConfig.maxConnections)) * (bUseHttp2 ? FMath::Max(1, Options.MaxStreamsPerConnection) : 1), Options.HandleAcquireTimeoutMs)
+	, ConnectTimeoutMs(ClientConfig.connectTimeoutMs)
+	, RequestTimeoutMs(ClientConfig.requestTimeoutMs)
+	, HttpRequestTimeoutMs(ClientConfig.httpRequestTimeoutMs)
+	, LowSpeedLimit(ClientConfig.lowSpeedLimit)
+	, bEnableTcpKeepAlive(ClientConfig.enableTcpKeepAlive)
+	, TcpKeepAliveIntervalMs(ClientConfig.tcpKeepAliveIntervalMs)
+	, bVerifySSL(ClientConfig.verifySSL)
+	, CaPath(ClientConfig.caPath)
+	, CaFile(ClientConfig.caFile)
+	, bDisableExpectHeader(ClientConfig.disableExpectHeader)
+	, bFollowRedirects(ClientConfig.followRedirects)
+	, MaxConnectionIdleSeconds(FMath::Max(0, Options.MaxConnectionIdleSeconds))
+	, bUseProxy(!ClientConfig.proxyHost.empty())
+	, ProxyScheme(SchemeMapper::ToString(ClientConfig.proxyScheme))
+	, ProxyHost(ClientConfig.proxyHost)
+	, ProxyPort(ClientConfig.proxyPort)
+	, ProxyUserName(ClientConfig.proxyUserName)
+	, ProxyPassword(ClientConfig.proxyPassword)
+	, ProxySSLCertPath(ClientConfig.proxySSLCertPath)
+	, ProxySSLCertType(ClientConfig.proxySSLCertType)
+	, ProxySSLKeyPath(ClientConfig.proxySSLKeyPath)
+	, ProxySSLKeyType(ClientConfig.proxySSLKeyType)
+	, ProxyKeyPassword(ClientConfig.proxySSLKeyPassword)
+{
+}
+
+std::shared_ptr<HttpResponse> FCloudWatchCurlHttpClient::MakeRequest(HttpRequest& Request, RateLimiterInterface* ReadLimiter, RateLimiterInterface* WriteLimiter) const
+{
+	// the request outlives the call since we wait for it
+	const std::shared_ptr<HttpRequest> Borrowed(&Request, [](HttpRequest*) {});
+	return MakeRequest(Borrowed, ReadLimiter, WriteLimiter);
+}
+
+std::shared_ptr<HttpResponse> FCloudWatchCurlHttpClient::MakeRequest(const std::shared_ptr<HttpRequest>& Request, RateLimiterInterface* ReadLimiter, RateLimiterInterface* WriteLimiter) const
+{
+	std::mutex DoneLock;
+	std::condition_variable DoneSignal;
+	std::shared_ptr<HttpResponse> Result;
+
+	MakeRequestAsync(Request, [&](const std::shared_ptr<HttpResponse>& Response)
+	{
+		std::lock_guard<std::mutex> Guard(DoneLock);
+		Result = Response;
+		DoneSignal.notify_one();
+	}, ReadLimiter, WriteLimiter);
+
+	std::unique_lock<std::mutex> Guard(DoneLock);
+	DoneSignal.wait(Guard, [&Result]() { return Result != nullptr; });
+	return Result;
+}
+
+void FCloudWatchCurlHttpClient::MakeRequestAsync(const std::shared_ptr<HttpRequest>& Request, FCloudWatchHttpCallback&& Callback, RateLimiterInterface* ReadLimiter, RateLimiterInterface* WriteLimiter) const
+{
+	FCloudWatchCurlTransfer* Transfer = CreateTransfer(Request, std::move(Callback), ReadLimiter, WriteLimiter);
+	if (!Transfer->ShouldContinue())
+	{
+		// e.g. a hedge whose call was already answered, the handle was never used
+		Transfer->Cancel(false);
+		return;
+	}
+	if (!Transfer->Handle)
+	{
+		Transfer->Fail("Timed out waiting for a free curl handle.");
+		return;
+	}
+	Multi->Submit(Transfer);
+}
+
+FCloudWatchCurlTransfer* FCloudWatchCurlHttpClient::CreateTransfer(const std::shared_ptr<HttpRequest>& Request, FCloudWatchHttpCallback&& Callback,
+	RateLimiterInterface* ReadLimiter, RateLimiterInterface* WriteLimiter) const
+{
+	FCloudWatchCurlTransfer* Transfer = Aws::New<FCloudWatchCurlTransfer>(ALLOCATION_TAG);
+	Transfer->Owner = Multi.get();
+	Transfer->Client = this;
+	Transfer->Pool = &HandlePool;
+	Transfer->Request = Request;
+	Transfer->Response = CreateResponse(Request, Transfer->PooledBody);
+	Transfer->ReadLimiter = ReadLimiter;
+	Transfer->WriteLimiter = WriteLimiter;
+	Transfer->Callback = std::move(Callback);
+	Transfer->ErrorBuffer[0] = '\0';
+
+	void* PooledHandle = nullptr;
+	Transfer->PoolSlot = HandlePool.Acquire(PooledHandle);
+	CURL* Handle = static_cast<CURL*>(PooledHandle);
+	Transfer->Handle = Handle;
+	if (!Handle) return Transfer;
+
+	const HeaderValueCollection RequestHeaders = Request->GetHeaders();
+	for (const auto& Header : RequestHeaders)
+	{
+		const Aws::String Line = Header.first + ": " + Header.second;
+		Transfer->Headers = curl_slist_append(Transfer->Headers, Line.c_str());
+	}
+	// curl would otherwise add its own defaults
+	if (!Request->HasHeader(TRANSFER_ENCODING_HEADER)) Transfer->Headers = curl_slist_append(Transfer->Headers, "transfer-encoding:");
+	if (!Request->HasHeader(CONTENT_LENGTH_HEADER)) Transfer->Headers = curl_slist_append(Transfer->Headers, "content-length:");
+	if (bDisableExpectHeader) Transfer->Headers = curl_slist_append(Transfer->Headers, "Expect:");
+
+	const Aws::String Url = Request->GetURIString();
+	curl_easy_setopt(Handle, CURLOPT_URL, Url.c_str());
+	curl_easy_setopt(Handle, CURLOPT_HTTPHEADER, Transfer->Headers);
+	SetMethod(Handle, *Request);
+
+	curl_easy_setopt(Handle, CURLOPT_PRIVATE, Transfer);
+	curl_easy_setopt(Handle, CURLOPT_SHARE, Multi->GetShareHandle());
+	// a hedge must not queue behind the stalled stream it is racing
+	const FCloudWatchHedgeContinue* Hedge = Request->GetContinueRequestHandler().target<FCloudWatchHedgeContinue>();
+	curl_easy_setopt(Handle, CURLOPT_FRESH_CONNECT, Hedge && Hedge->bFreshConnection ? 1L : 0L);
+	if (DnsCache && !bUseProxy)
+	{
+		// loaded into the shared DNS cache when the transfer starts, so curl connects without calling the resolver
+		void* ResolveList = nullptr;
+		Transfer->DnsRecord = DnsCache->Find(Request->GetUri(), ResolveList);
+		if (ResolveList) curl_easy_setopt(Handle, CURLOPT_RESOLVE, static_cast<curl_slist*>(ResolveList));
+	}
+	curl_easy_setopt(Handle, CURLOPT_ERRORBUFFER, Transfer->ErrorBuffer);
+	curl_easy_setopt(Handle, CURLOPT_WRITEFUNCTION, WriteBody);
+	curl_easy_setopt(Handle, CURLOPT_WRITEDATA, Transfer);
+	curl_easy_setopt(Handle, CURLOPT_HEADERFUNCTION, WriteHeader);
+	curl_easy_setopt(Handle, CURLOPT_HEADERDATA, Transfer);
+	if (Request->GetContentBody())
+	{
+		curl_easy_setopt(Handle, CURLOPT_READFUNCTION, ReadBody);
+		curl_easy_setopt(Handle, CURLOPT_READDATA, Transfer);
+		curl_easy_setopt(Handle, CURLOPT_SEEKFUNCTION, SeekBody);
+		curl_easy_setopt(Handle, CURLOPT_SEEKDATA, Transfer);
+	}
+	curl_easy_setopt(Handle, CURLOPT_XFERINFOFUNCTION, OnProgress);
+	curl_easy_setopt(Handle, CURLOPT_XFERINFODATA, Transfer);
+	curl_easy_setopt(Handle, CURLOPT_NOPROGRESS, 0L);
+
+	// signals can't be used to time out resolves from a worker thread
+	curl_easy_setopt(Handle, CURLOPT_NOSIGNAL, 1L);
+	curl_easy_setopt(Handle, CURLOPT_CONNECTTIMEOUT_MS, ConnectTimeoutMs);
+	curl_easy_setopt(Handle, CURLOPT_TIMEOUT_MS, HttpRequestTimeoutMs);
+	curl_easy_setopt(Handle, CURLOPT_LOW_SPEED_LIMIT, static_cast<long>(LowSpeedLimit));
+	curl_easy_setopt(Handle, CURLOPT_LOW_SPEED_TIME, RequestTimeoutMs < 1000 ? (RequestTimeoutMs == 0 ? 0L : 1L) : RequestTimeoutMs / 1000);
+	curl_easy_setopt(Handle, CURLOPT_TCP_KEEPALIVE, bEnableTcpKeepAlive ? 1L : 0L);
+	if (bEnableTcpKeepAlive)
+	{
+		const long IntervalSeconds = static_cast<long>(FMath::Max(1UL, TcpKeepAliveIntervalMs / 1000));
+		curl_easy_setopt(Handle, CURLOPT_TCP_KEEPIDLE, IntervalSeconds);
+		curl_easy_setopt(Handle, CURLOPT_TCP_KEEPINTVL, IntervalSeconds);
+	}
+
+	curl_easy_setopt(Handle, CURLOPT_SSL_VERIFYPEER, bVerifySSL ? 1L : 0L);
+	curl_easy_setopt(Handle, CURLOPT_SSL_VERIFYHOST, bVerifySSL ? 2L : 0L);
+	if (!CaPath.empty()) curl_easy_setopt(Handle, CURLOPT_CAPATH, CaPath.c_str());
+	if (!CaFile.empty()) curl_easy_setopt(Handle, CURLOPT_CAINFO, CaFile.c_str());
+	curl_easy_setopt(Handle, CURLOPT_FOLLOWLOCATION, bFollowRedirects ? 1L : 0L);
+#if LIBCURL_VERSION_NUM >= 0x074100
+	// NATs drop idle connections silently; don't hand out one that has probably been dropped
+	if (MaxConnectionIdleSeconds > 0) curl_easy_setopt(Handle, CURLOPT_MAXAGE_CONN, MaxConnectionIdleSeconds);
+#endif
+
+#if defined(CURLPIPE_MULTIPLEX) && LIBCURL_VERSION_NUM >= 0x072F00
+	if (bUseHttp2)
+	{
+		// offered through ALPN, the server may still answer with HTTP/1.1
+		curl_easy_setopt(Handle, CURLOPT_HTTP_VERSION, static_cast<long>(CURL_HTTP_VERSION_2TLS));
+		// wait for a connection that can take another stream instead of opening a new one
+		curl_easy_setopt(Handle, CURLOPT_PIPEWAIT, 1L);
+	}
+	else
+	{
+		curl_easy_setopt(Handle, CURLOPT_HTTP_VERSION, static_cast<long>(CURL_HTTP_VERSION_1_1));
+	}
+#endif
+
+	if (bUseProxy)
+	{
+		const Aws::String ProxyUrl = ProxyScheme + "://" + ProxyHost;
+		curl_easy_setopt(Handle, CURLOPT_PROXY, ProxyUrl.c_str());
+		curl_easy_setopt(Handle, CURLOPT_PROXYPORT, static_cast<long>(ProxyPort));
+		if (!ProxyUserName.empty()) curl_easy_setopt(Handle, CURLOPT_PROXYUSERNAME, ProxyUserName.c_str());
+		if (!ProxyPassword.empty()) curl_easy_setopt(Handle, CURLOPT_PROXYPASSWORD, ProxyPassword.c_str());
+#if LIBCURL_VERSION_NUM >= 0x073400
+		if (!ProxySSLCertPath.empty()) curl_easy_setopt(Handle, CURLOPT_PROXY_SSLCERT, ProxySSLCertPath.c_str());
+		if (!ProxySSLCertType.empty()) curl_easy_setopt(Handle, CURLOPT_PROXY_SSLCERTTYPE, ProxySSLCertType.c_str());
+		if (!ProxySSLKeyPath.empty()) curl_easy_setopt(Handle, CURLOPT_PROXY_SSLKEY, ProxySSLKeyPath.c_str());
+		if (!ProxySSLKeyType.empty()) curl_easy_setopt(Handle, CURLOPT_PROXY_SSLKEYTYPE, ProxySSLKeyType.c_str());
+		if (!ProxyKeyPassword.empty()) curl_easy_setopt(Handle, CURLOPT_PROXY_KEYPASSWD, ProxyKeyPassword.c_str());
+#endif
+	}
+	else
+	{
+		curl_easy_setopt(Handle, CURLOPT_PROXY, "");
+	}
+
+	return Transfer;
+}
+
+// FSignedClientScope instances alive on this thread
+static thread_local int32 SignedClientScopes = 0;
+
+FCloudWatchHttpClientFactory::FSignedClientScope::FSignedClientScope()
+{
+	++SignedClientScopes;
+}
+
+FCloudWatchHttpClientFactory::FSignedClientScope::~FSignedClientScope()
+{
+	--SignedClientScopes;
+}
+
+std::shared_ptr<HttpClient> FCloudWatchHttpClientFactory::CreateHttpClient(const Aws::Client::ClientConfiguration& ClientConfig) const
+{
+	std::shared_ptr<HttpClient> Client;
+	std::shared_ptr<FCloudWatchSigV4Signer> ClientSigner;
+	{
+		std::lock_guard<std::mutex> Guard(Lock);
+		ClientSigner = Signer;
+	}
+
+#if PLATFORM_WINDOWS
+	// keep the SDK's own choice unless curl was asked for explicitly
+	if (ClientConfig.httpLibOverride == TransferLibType::WIN_INET_CLIENT)
+	{
+		Client = Aws::MakeShared<WinINetSyncHttpClient>(ALLOCATION_TAG, ClientConfig);
+	}
+	else if (ClientConfig.httpLibOverride != TransferLibType::CURL_CLIENT)
+	{
+		Client = Aws::MakeShared<WinHttpSyncHttpClient>(ALLOCATION_TAG, ClientConfig);
+	}
+#endif
+
+	std::shared_ptr<FCloudWatchCurlHttpClient> CurlClient;
+	if (!Client)
+	{
+		std::lock_guard<std::mutex> Guard(Lock);
+		CurlClient = CreateCurlHttpClientLocked(ClientConfig);
+		Clients.erase(std::remove_if(Clients.begin(), Clients.end(), [](const std::weak_ptr<FCloudWatchCurlHttpClient>& Existing) { return Existing.expired(); }), Clients.end());
+		Clients.push_back(CurlClient);
+		Client = CurlClient;
+	}
+
+	if (ClientSigner && SignedClientScopes > 0)
+	{
+		auto SigningClient = Aws::MakeShared<FCloudWatchSigningHttpClient>(ALLOCATION_TAG, Client, ClientSigner);
+		// the service client disables the wrapper, in-flight transfers have to see it too
+		if (CurlClient) CurlClient->SetOuterClient(SigningClient.get());
+		return SigningClient;
+	}
+	return Client;
+}
+
+std::shared_ptr<FCloudWatchCurlHttpClient> FCloudWatchHttpClientFactory::CreateCurlHttpClient(const Aws::Client::ClientConfiguration& ClientConfig) const
+{
+	std::lock_guard<std::mutex> Guard(Lock);
+	return CreateCurlHttpClientLocked(ClientConfig);
+}
+
+std::shared_ptr<FCloudWatchCurlHttpClient> FCloudWatchHttpClientFactory::CreateCurlHttpClientLocked(const Aws::Client::ClientConfiguration& ClientConfig) const
+{
+	const bool bHttp2 = Options.bEnableHttp2 && FCloudWatchCurlMulti::SupportsHttp2();
+	if (Options.bEnableHttp2 && !bHttp2)
+	{
+		LOG_WARNING("libcurl was built without HTTP/2 support. Using HTTP/1.1.");
+	}
+	if (!Multi)
+	{
+		Multi = Aws::MakeShared<FCloudWatchCurlMulti>(ALLOCATION_TAG, static_cast<int32>(ClientConfig.maxConnections), bHttp2, Options.MaxStreamsPerConnection);
+	}
+	if (!DnsCache && Options.DnsCacheTtlSeconds > 0)
+	{
+		DnsCache = Aws::MakeShared<FCloudWatchDnsCache>(ALLOCATION_TAG, Options.DnsCacheTtlSeconds);
+	}
+	return Aws::MakeShared<FCloudWatchCurlHttpClient>(ALLOCATION_TAG, ClientConfig, Multi, Options, Options.DnsCacheTtlSeconds > 0 ? DnsCache : nullptr);
+}
+
+void FCloudWatchHttpClientFactory::SetOptions(const FCloudWatchCurlOptions& InOptions)
+{
+	std::lock_guard<std::mutex> Guard(Lock);
+	Options = InOptions;
+}
+
+void FCloudWatchHttpClientFactory::SetSigner(const std::shared_ptr<FCloudWatchSigV4Signer>& InSigner)
+{
+	std::lock_guard<std::mutex> Guard(Lock);
+	Signer = InSigner;
+}
+
+std::shared_ptr<FCloudWatchSigV4Signer> FCloudWatchHttpClientFactory::GetSigner() const
+{
+	std::lock_guard<std::mutex> Guard(Lock);
+	return Signer;
+}
+
+FCloudWatchCurlPoolStats FCloudWatchHttpClientFactory::GetHandlePoolStats() const
+{
+	FCloudWatchCurlPoolStats Total;
+	std::lock_guard<std::mutex> Guard(Lock);
+	for (const auto& Entry : Clients)
+	{
+		const std::shared_ptr<FCloudWatchCurlHttpClient> Client = Entry.lock();
+		if (!Client) continue;
+
+		const FCloudWatchCurlPoolStats Stats = Client->GetHandlePoolStats();
+		Total.Capacity += Stats.Capacity;
+		Total.InUse += Stats.InUse;
+		Total.PeakInUse += Stats.PeakInUse;
+		Total.Acquires += Stats.Acquires;
+		Total.Waits += Stats.Waits;
+		Total.Timeouts += Stats.Timeouts;
+		Total.TotalWaitMs += Stats.TotalWaitMs;
+		Total.MaxWaitMs = FMath::Max(Total.MaxWaitMs, Stats.MaxWaitMs);
+	}
+	return Total;
+}
+
+std::shared_ptr<FCloudWatchDnsCache> FCloudWatchHttpClientFactory::GetDnsCache() const
+{
+	std::lock_guard<std::mutex> Guard(Lock);
+	return DnsCache;
+}
+
+std::shared_ptr<HttpRequest> FCloudWatchHttpClientFactory::CreateHttpRequest(const Aws::String& Uri, HttpMethod Method, const Aws::IOStreamFactory& StreamFactory) const
+{
+	return CreateHttpRequest(URI(Uri), Method, StreamFactory);
+}
+
+std::shared_ptr<HttpRequest> FCloudWatchHttpClientFactory::CreateHttpRequest(const URI& Uri, HttpMethod Method, const Aws::IOStreamFactory& StreamFactory) const
+{
+	auto Request = Aws::MakeShared<Standard::StandardHttpRequest>(ALLOCATION_TAG, Uri, Method);
+	Request->SetResponseStreamFactory(StreamFactory);
+	return Request;
+}
+
+void FCloudWatchHttpClientFactory::InitStaticState()
+{
+	curl_global_init(CURL_GLOBAL_ALL);
+}
+
+void FCloudWatchHttpClientFactory::CleanupStaticState()
+{
+	// clients may still hold the multi handle, make sure its thread is gone before curl is torn down
+	std::lock_guard<std::mutex> Guard(Lock);
+	if (Multi)
+	{
+		Multi->Shutdown();
+		Multi.reset();
+	}
+	DnsCache.reset();
+	curl_global_cleanup();
+}
+
+#endif
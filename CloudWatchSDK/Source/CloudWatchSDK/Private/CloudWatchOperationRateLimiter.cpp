@@ -0,0 +1,282 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#include "CloudWatchOperationRateLimiter.h"
+#include "CloudWatchGlobals.h"
+
+#if WITH_CLOUDWATCH
+
+#include <algorithm>
+
+static int64 NowNs()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static Aws::String MakeOperationKey(const Aws::String& ServiceName, const Aws::String& OperationName)
+{
+	return ServiceName + ":" + OperationName;
+}
+
+// set on the thread running a submitted call until its first attempt starts
+static thread_local bool bHoldsSubmittedSlot = false;
+
+FCloudWatchOperationRateLimiter::FOperation::FOperation(bool bInPerResource)
+	: IntervalNs(0)
+	, BurstNs(0)
+	, bPerResource(bInPerResource)
+	, Requests(0)
+	, DelayedRequests(0)
+	, OverLimitRequests(0)
+	, TotalWaitNs(0)
+	, MaxWaitNs(0)
+{
+}
+
+FCloudWatchOperationRateLimiter& FCloudWatchOperationRateLimiter::Get()
+{
+	static FCloudWatchOperationRateLimiter Instance;
+	return Instance;
+}
+
+FCloudWatchOperationRateLimiter::~FCloudWatchOperationRateLimiter()
+{
+	Shutdown();
+}
+
+FCloudWatchOperationRateLimiter::FShard& FCloudWatchOperationRateLimiter::GetShard(const Aws::String& Key) const
+{
+	// FNV-1a, Aws::String has no std::hash with the SDK's allocator
+	uint32 Hash = 2166136261u;
+	for (const char Char : Key)
+	{
+		Hash = (Hash ^ static_cast<uint8>(Char)) * 16777619u;
+	}
+	return Shards[Hash % ShardCount];
+}
+
+std::shared_ptr<FCloudWatchOperationRateLimiter::FOperation> FCloudWatchOperationRateLimiter::FindOperation(const Aws::String& OperationKey) const
+{
+	FShard& Shard = GetShard(OperationKey);
+	std::lock_guard<std::mutex> Guard(Shard.Lock);
+	auto It = Shard.Operations.find(OperationKey);
+	return It == Shard.Operations.end() ? nullptr : It->second;
+}
+
+void FCloudWatchOperationRateLimiter::SetOperationRate(const Aws::String& ServiceName, const Aws::String& OperationName, double RequestsPerSecond, int32 Burst /*= 1*/, bool bPerResource /*= false*/)
+{
+	const Aws::String Key = MakeOperationKey(ServiceName, OperationName);
+	FShard& Shard = GetShard(Key);
+	std::lock_guard<std::mutex> Guard(Shard.Lock);
+	if (RequestsPerSecond <= 0.0)
+	{
+		Shard.Operations.erase(Key);
+		return;
+	}
+
+	std::shared_ptr<FOperation>& Operation = Shard.Operations[Key];
+	if (!Operation || Operation->bPerResource != bPerResource)
+	{
+		Operation = std::make_shared<FOperation>(bPerResource);
+	}
+	const int64 IntervalNs = static_cast<int64>(1000000000.0 / RequestsPerSecond);
+	Operation->IntervalNs = IntervalNs;
+	Operation->BurstNs = IntervalNs * FMath::Max(1, Burst);
+}
+
+void FCloudWatchOperationRateLimiter::SetMaxWait(int32 MaxWaitMs)
+{
+	MaxWaitNs = static_cast<int64>(FMath::Max(0, MaxWaitMs)) * 1000000;
+}
+
+int64 FCloudWatchOperationRateLimiter::Reserve(FOperation& Operation, const Aws::String& BucketKey, int64 MaxAllowedWaitNs)
+{
+	const int64 IntervalNs = Operation.IntervalNs;
+	const int64 BurstNs = Operation.BurstNs;
+	Operation.Requests++;
+
+	int64 WaitNs = 0;
+	{
+		FShard& Shard = GetShard(BucketKey);
+		std::lock_guard<std::mutex> Guard(Shard.Lock);
+		int64& TheoreticalArrivalNs = Shard.Buckets[BucketKey];
+
+		// reserve the next slot; an idle bucket lets up to Burst requests through back to back
+		const int64 Now = NowNs();
+		const int64 Arrival = FMath::Max(TheoreticalArrivalNs, Now);
+		WaitNs = FMath::Max<int64>(0, Arrival - (BurstNs - IntervalNs) - Now);
+		if (WaitNs > MaxAllowedWaitNs)
+		{
+			// no slot is taken so the call doesn't delay the ones behind it
+			Operation.OverLimitRequests++;
+			return -1;
+		}
+		TheoreticalArrivalNs = Arrival + IntervalNs;
+	}
+
+	if (WaitNs > 0)
+	{
+		Operation.DelayedRequests++;
+		Operation.TotalWaitNs += WaitNs;
+		int64 MaxSeen = Operation.MaxWaitNs;
+		while (MaxSeen < WaitNs && !Operation.MaxWaitNs.compare_exchange_weak(MaxSeen, WaitNs)) {}
+	}
+	return WaitNs;
+}
+
+void FCloudWatchOperationRateLimiter::Submit(const Aws::String& ServiceName, const Aws::String& OperationName, const Aws::String& Resource, const std::shared_ptr<Aws::Utils::Threading::Executor>& Executor,
+	std::function<void()>&& Call, std::function<void()>&& OnRejected)
+{
+	const Aws::String Key = MakeOperationKey(ServiceName, OperationName);
+	FDelayedCall Submitted;
+	Submitted.Executor = Executor;
+	Submitted.OnRejected = std::move(OnRejected);
+
+	const std::shared_ptr<FOperation> Operation = FindOperation(Key);
+	if (!Operation)
+	{
+		Submitted.Call = std::move(Call);
+		Dispatch(std::move(Submitted));
+		return;
+	}
+
+	const int64 WaitNs = Reserve(*Operation, Operation->bPerResource ? Key + ":" + Resource : Key, MaxWaitNs);
+	if (WaitNs < 0)
+	{
+		Submitted.OnRejected();
+		return;
+	}
+
+	Submitted.Call = [Inner = std::move(Call)]()
+	{
+		bHoldsSubmittedSlot = true;
+		Inner();
+		bHoldsSubmittedSlot = false;
+	};
+	if (WaitNs == 0)
+	{
+		Dispatch(std::move(Submitted));
+		return;
+	}
+
+	// wait in the delay queue instead of on an executor thread
+	Submitted.Due = std::chrono::steady_clock::now() + std::chrono::nanoseconds(WaitNs);
+	{
+		std::lock_guard<std::mutex> Guard(DelayLock);
+		if (!DelayThread.joinable())
+		{
+			DelayThread = std::thread(&FCloudWatchOperationRateLimiter::DelayLoop, this);
+		}
+		Delayed.push_back(std::move(Submitted));
+		std::push_heap(Delayed.begin(), Delayed.end(), [](const FDelayedCall& A, const FDelayedCall& B) { return A.Due > B.Due; });
+	}
+	DelaySignal.notify_one();
+}
+
+bool FCloudWatchOperationRateLimiter::TryAcquire(const Aws::String& ServiceName, const Aws::String& OperationName)
+{
+	const Aws::String Key = MakeOperationKey(ServiceName, OperationName);
+	const std::shared_ptr<FOperation> Operation = FindOperation(Key);
+	if (!Operation || Operation->bPerResource) return true;
+	return Reserve(*Operation, Key, 0) == 0;
+}
+
+bool FCloudWatchOperationRateLimiter::TakeSubmittedSlot()
+{
+	const bool bHeld = bHoldsSubmittedSlot;
+	bHoldsSubmittedSlot = false;
+	return bHeld;
+}
+
+void FCloudWatchOperationRateLimiter::Dispatch(FDelayedCall&& Submitted)
+{
+	if (!Submitted.Executor || !Submitted.Executor->Submit(std::move(Submitted.Call)))
+	{
+		Submitted.OnRejected();
+	}
+}
+
+void FCloudWatchOperationRateLimiter::DelayLoop()
+{
+	const auto LaterDue = [](const FDelayedCall& A, const FDelayedCall& B) { return A.Due > B.Due; };
+	std::unique_lock<std::mutex> Guard(DelayLock);
+	while (!bStopDelayThread)
+	{
+		if (Delayed.empty())
+		{
+			DelaySignal.wait(Guard);
+			continue;
+		}
+		// a copy, Submit may grow the heap while this waits
+		const std::chrono::steady_clock::time_point NextDue = Delayed.front().Due;
+		if (std::chrono::steady_clock::now() < NextDue)
+		{
+			DelaySignal.wait_until(Guard, NextDue);
+			continue;
+		}
+
+		std::pop_heap(Delayed.begin(), Delayed.end(), LaterDue);
+		FDelayedCall Due = std::move(Delayed.back());
+		Delayed.pop_back();
+		Guard.unlock();
+		Dispatch(std::move(Due));
+		Guard.lock();
+	}
+}
+
+void FCloudWatchOperationRateLimiter::Shutdown()
+{
+	for (FShard& Shard : Shards)
+	{
+		std::lock_guard<std::mutex> Guard(Shard.Lock);
+		Shard.Operations.clear();
+		Shard.Buckets.clear();
+	}
+
+	std::thread Stopped;
+	size_t Dropped = 0;
+	{
+		std::lock_guard<std::mutex> Guard(DelayLock);
+		bStopDelayThread = true;
+		Dropped = Delayed.size();
+		Delayed.clear();
+		Stopped = std::move(DelayThread);
+	}
+	DelaySignal.notify_all();
+	if (Stopped.joinable()) Stopped.join();
+
+	{
+		std::lock_guard<std::mutex> Guard(DelayLock);
+		bStopDelayThread = false;
+	}
+	if (Dropped > 0)
+	{
+		LOG_WARNING(FString::Printf(TEXT("Dropped %d calls waiting for their operation rate limit."), static_cast<int32>(Dropped)));
+	}
+}
+
+FCloudWatchOperationWaitStats FCloudWatchOperationRateLimiter::GetWaitStats(const Aws::String& ServiceName, const Aws::String& OperationName) const
+{
+	FCloudWatchOperationWaitStats Stats;
+	const std::shared_ptr<FOperation> Operation = FindOperation(MakeOperationKey(ServiceName, OperationName));
+	if (!Operation) return Stats;
+
+	Stats.Requests = Operation->Requests;
+	Stats.DelayedRequests = Operation->DelayedRequests;
+	Stats.OverLimitRequests = Operation->OverLimitRequests;
+	Stats.TotalWaitMs = Operation->TotalWaitNs / 1000000.0;
+	Stats.MaxWaitMs = Operation->MaxWaitNs / 1000000.0;
+	return Stats;
+}
+
+#endif
@@ -0,0 +1,353 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#include "CloudWatchProfileConfig.h"
+#include "CloudWatchGlobals.h"
+
+#if WITH_CLOUDWATCH
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <aws/core/platform/Environment.h>
+#include <aws/core/platform/FileSystem.h>
+#include <aws/core/utils/DateTime.h>
+#include <aws/core/utils/memory/AWSMemory.h>
+
+#if PLATFORM_WINDOWS
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+static const char* ALLOCATION_TAG = "CloudWatchProfileConfig";
+
+// credentials and config files are a few hundred bytes, larger ones spill over to the heap
+static const size_t InlineFileBytes = 8192;
+
+/**
+* Contents of a whole file, read with one or a few read calls into a stack buffer. Empty when the file is missing,
+* unreadable or empty. A file truncated or rewritten while it is read just yields what was read, it is a snapshot.
+**/
+class FCloudWatchProfileFile
+{
+public:
+	explicit FCloudWatchProfileFile(const Aws::String& Path)
+		: Data(Inline)
+		, Size(0)
+	{
+	#if PLATFORM_WINDOWS
+		const HANDLE File = CreateFileA(Path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (File == INVALID_HANDLE_VALUE)
+		{
+			return;
+		}
+		for (;;)
+		{
+			char* const Free = Reserve();
+			DWORD Read = 0;
+			if (!ReadFile(File, Free, static_cast<DWORD>(Capacity() - Size), &Read, nullptr) || Read == 0)
+			{
+				break;
+			}
+			Size += Read;
+		}
+		CloseHandle(File);
+	#else
+		const int Descriptor = open(Path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (Descriptor < 0)
+		{
+			return;
+		}
+		struct stat Status;
+		if (fstat(Descriptor, &Status) == 0 && S_ISREG(Status.st_mode))
+		{
+			for (;;)
+			{
+				char* const Free = Reserve();
+				const ssize_t Read = read(Descriptor, Free, Capacity() - Size);
+				if (Read < 0 && errno == EINTR)
+				{
+					continue;
+				}
+				if (Read <= 0)
+				{
+					break;
+				}
+				Size += static_cast<size_t>(Read);
+			}
+		}
+		close(Descriptor);
+	#endif
+	}
+
+	FCloudWatchProfileFile(const FCloudWatchProfileFile&) = delete;
+	FCloudWatchProfileFile& operator=(const FCloudWatchProfileFile&) = delete;
+
+	const char* Begin() const { return Data; }
+	const char* End() const { return Data + Size; }
+
+private:
+	size_t Capacity() const { return Data == Inline ? InlineFileBytes : Heap.size(); }
+
+	/** Start of the free space, grown once the current buffer is full. */
+	char* Reserve()
+	{
+		if (Size == Capacity())
+		{
+			Heap.resize(Capacity() * 2);
+			if (Data == Inline)
+			{
+				memcpy(Heap.data(), Inline, Size);
+			}
+			Data = Heap.data();
+		}
+		return Data + Size;
+	}
+
+	char Inline[InlineFileBytes];
+	Aws::Vector<char> Heap;
+	char* Data;
+	size_t Size;
+};
+
+// a range of the file buffer, nothing is copied until a value of the active profile is kept
+struct FProfileToken
+{
+	const char* Begin;
+	const char* End;
+
+	bool IsEmpty() const { return Begin == End; }
+	bool Equals(const char* Literal, size_t Length) const { return size_t(End - Begin) == Length && memcmp(Begin, Literal, Length) == 0; }
+	Aws::String ToString() const { return Aws::String(Begin, End); }
+};
+
+static FProfileToken Trim(const char* Begin, const char* End)
+{
+	while (Begin < End && (*Begin == ' ' || *Begin == '\t'))
+	{
+		++Begin;
+	}
+	while (End > Begin && (End[-1] == ' ' || End[-1] == '\t' || End[-1] == '\r'))
+	{
+		--End;
+	}
+	return { Begin, End };
+}
+
+static FCloudWatchProfileFileIdentity StatFile(const Aws::String& Path)
+{
+	FCloudWatchProfileFileIdentity Identity;
+#if PLATFORM_WINDOWS
+	WIN32_FILE_ATTRIBUTE_DATA Attributes;
+	if (GetFileAttributesExA(Path.c_str(), GetFileExInfoStandard, &Attributes))
+	{
+		Identity.bExists = true;
+		Identity.ModifiedTime = (int64(Attributes.ftLastWriteTime.dwHighDateTime) << 32) | Attributes.ftLastWriteTime.dwLowDateTime;
+		Identity.Size = (uint64(Attributes.nFileSizeHigh) << 32) | Attributes.nFileSizeLow;
+	}
+#else
+	struct stat Status;
+	if (stat(Path.c_str(), &Status) == 0)
+	{
+		Identity.bExists = true;
+		Identity.FileId = uint64(Status.st_ino);
+	#if PLATFORM_MAC || PLATFORM_IOS
+		Identity.ModifiedTime = int64(Status.st_mtimespec.tv_sec) * 1000000000 + Status.st_mtimespec.tv_nsec;
+	#else
+		Identity.ModifiedTime = int64(Status.st_mtim.tv_sec) * 1000000000 + Status.st_mtim.tv_nsec;
+	#endif
+		Identity.Size = uint64(Status.st_size);
+	}
+#endif
+	return Identity;
+}
+
+/**
+* Reads the keys of one section, the last occurrence of a key winning like in the SDK's loader.
+* @param Section [const Aws::String&] Section name as written between the brackets, e.g. "profile dev".
+* @return [bool] True if the section has an access key.
+**/
+static bool ReadProfile(const Aws::String& Path, const Aws::String& Section, Aws::Auth::AWSCredentials& OutCredentials)
+{
+	const FCloudWatchProfileFile File(Path);
+
+	FProfileToken AccessKey = { nullptr, nullptr };
+	FProfileToken SecretKey = { nullptr, nullptr };
+	FProfileToken SessionToken = { nullptr, nullptr };
+
+	bool bInSection = false;
+	const char* Line = File.Begin();
+	const char* const End = File.End();
+	while (Line < End)
+	{
+		const char* LineEnd = static_cast<const char*>(memchr(Line, '\n', End - Line));
+		if (!LineEnd)
+		{
+			LineEnd = End;
+		}
+		const FProfileToken Text = Trim(Line, LineEnd);
+		Line = LineEnd + (LineEnd < End ? 1 : 0);
+
+		if (Text.IsEmpty() || *Text.Begin == '#' || *Text.Begin == ';')
+		{
+			continue;
+		}
+		if (*Text.Begin == '[')
+		{
+			const char* Close = static_cast<const char*>(memchr(Text.Begin, ']', Text.End - Text.Begin));
+			bInSection = Close && Trim(Text.Begin + 1, Close).Equals(Section.c_str(), Section.size());
+			continue;
+		}
+		if (!bInSection)
+		{
+			continue;
+		}
+
+		const char* Equal = static_cast<const char*>(memchr(Text.Begin, '=', Text.End - Text.Begin));
+		if (!Equal)
+		{
+			continue;
+		}
+		const FProfileToken Key = Trim(Text.Begin, Equal);
+		const FProfileToken Value = Trim(Equal + 1, Text.End);
+		if (Key.Equals("aws_access_key_id", 17))
+		{
+			AccessKey = Value;
+		}
+		else if (Key.Equals("aws_secret_access_key", 21))
+		{
+			SecretKey = Value;
+		}
+		else if (Key.Equals("aws_session_token", 17))
+		{
+			SessionToken = Value;
+		}
+	}
+
+	if (AccessKey.IsEmpty())
+	{
+		return false;
+	}
+	// copied out while the file buffer is still there
+	OutCredentials = Aws::Auth::AWSCredentials(AccessKey.ToString(), SecretKey.ToString(), SessionToken.ToString());
+	return true;
+}
+
+FCloudWatchProfileCredentialsProvider::FCloudWatchProfileCredentialsProvider(const char* Profile, int32 CheckIntervalSeconds)
+	: ProfileName(Profile ? Aws::String(Profile) : Aws::Auth::GetConfigProfileName())
+	, CredentialsPath(Aws::Auth::ProfileConfigFileAWSCredentialsProvider::GetCredentialsProfileFilename())
+	, CheckIntervalMillis(int64(FMath::Max(0, CheckIntervalSeconds)) * 1000)
+	, Current(nullptr)
+	, Readers(0)
+	, NextCheckMillis(0)
+	, Parses(0)
+{
+	ConfigPath = Aws::Environment::GetEnv("AWS_CONFIG_FILE");
+	if (ConfigPath.empty())
+	{
+		ConfigPath = Aws::Auth::ProfileConfigFileAWSCredentialsProvider::GetProfileDirectory() + Aws::FileSystem::PATH_DELIM + "config";
+	}
+	CheckFiles(true);
+}
+
+FCloudWatchProfileCredentialsProvider::~FCloudWatchProfileCredentialsProvider()
+{
+	Aws::Delete(const_cast<FSnapshot*>(Current.load()));
+	for (const FSnapshot* Snapshot : Retired)
+	{
+		Aws::Delete(const_cast<FSnapshot*>(Snapshot));
+	}
+}
+
+Aws::Auth::AWSCredentials FCloudWatchProfileCredentialsProvider::GetAWSCredentials()
+{
+	if (Aws::Utils::DateTime::CurrentTimeMillis() >= NextCheckMillis.load(std::memory_order_relaxed))
+	{
+		CheckFiles(false);
+	}
+
+	Readers.fetch_add(1);
+	const Aws::Auth::AWSCredentials Credentials = Current.load()->Credentials;
+	Readers.fetch_sub(1);
+	return Credentials;
+}
+
+void FCloudWatchProfileCredentialsProvider::CheckFiles(bool bForce)
+{
+	std::unique_lock<std::mutex> Guard(CheckLock, std::try_to_lock);
+	if (!Guard.owns_lock())
+	{
+		// another thread is checking, the current snapshot is good enough meanwhile
+		return;
+	}
+	NextCheckMillis.store(Aws::Utils::DateTime::CurrentTimeMillis() + CheckIntervalMillis, std::memory_order_relaxed);
+
+	const FCloudWatchProfileFileIdentity CredentialsFile = StatFile(CredentialsPath);
+	const FCloudWatchProfileFileIdentity ConfigFile = StatFile(ConfigPath);
+
+	// only holders of CheckLock replace the snapshot, so it can be read here without counting as a reader
+	const FSnapshot* Snapshot = Current.load();
+	if (!bForce && Snapshot && Snapshot->CredentialsFile == CredentialsFile && Snapshot->ConfigFile == ConfigFile)
+	{
+		return;
+	}
+
+	// a rewrite between the stat and the read only costs one more parse at the next check
+	FSnapshot* Next = Aws::New<FSnapshot>(ALLOCATION_TAG);
+	Next->CredentialsFile = CredentialsFile;
+	Next->ConfigFile = ConfigFile;
+	if (!(CredentialsFile.bExists && ReadProfile(CredentialsPath, ProfileName, Next->Credentials)) && ConfigFile.bExists)
+	{
+		// the config file prefixes every profile but the default one
+		ReadProfile(ConfigPath, ProfileName == "default" ? ProfileName : "profile " + ProfileName, Next->Credentials);
+	}
+	Parses.fetch_add(1, std::memory_order_relaxed);
+
+	if (Snapshot)
+	{
+		LOG_NORMAL("AWS profile files changed, credentials reloaded.");
+	}
+	Publish(Next);
+}
+
+void FCloudWatchProfileCredentialsProvider::Publish(FSnapshot* Next)
+{
+	const FSnapshot* Previous = Current.exchange(Next);
+	if (Previous)
+	{
+		Retired.push_back(Previous);
+	}
+
+	// a reader that could still hold a replaced snapshot was counted before the exchange, so none are left at zero
+	if (Readers.load() == 0)
+	{
+		for (const FSnapshot* Snapshot : Retired)
+		{
+			Aws::Delete(const_cast<FSnapshot*>(Snapshot));
+		}
+		Retired.clear();
+	}
+}
+
+#endif
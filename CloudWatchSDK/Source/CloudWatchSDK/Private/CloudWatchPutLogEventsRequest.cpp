@@ -0,0 +1,168 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#include "CloudWatchPutLogEventsRequest.h"
+#include "CloudWatchEncoding.h"
+
+#if WITH_CLOUDWATCH
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <aws/core/utils/memory/AWSMemory.h>
+
+#include <cstdio>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+static const char* ALLOCATION_TAG = "CloudWatchPutLogEventsRequest";
+
+// bytes one event adds on top of its message: {"timestamp":<20 digits>,"message":""},
+static const size_t EventOverhead = 48;
+
+static void AppendJsonString(Aws::String& Out, const Aws::String& Value)
+{
+	static const char* Hex = "0123456789abcdef";
+
+	Out.push_back('"');
+	const char* Run = Value.data();
+	const char* End = Run + Value.size();
+	for (const char* Char = Run; Char != End; ++Char)
+	{
+		const unsigned char Byte = static_cast<unsigned char>(*Char);
+		if (Byte >= 0x20 && Byte != '"' && Byte != '\\') continue;
+
+		// copy the clean run in one go, then the escape
+		Out.append(Run, Char - Run);
+		Run = Char + 1;
+		switch (Byte)
+		{
+		case '"': Out.append("\\\"", 2); break;
+		case '\\': Out.append("\\\\", 2); break;
+		case '\b': Out.append("\\b", 2); break;
+		case '\f': Out.append("\\f", 2); break;
+		case '\n': Out.append("\\n", 2); break;
+		case '\r': Out.append("\\r", 2); break;
+		case '\t': Out.append("\\t", 2); break;
+		default:
+		{
+			const char Escape[6] = { '\\', 'u', '0', '0', Hex[Byte >> 4], Hex[Byte & 0xF] };
+			Out.append(Escape, 6);
+			break;
+		}
+		}
+	}
+	Out.append(Run, End - Run);
+	Out.push_back('"');
+}
+
+// hashes what was appended since the last call, before later events push it out of cache
+static void HashAppended(const Aws::String& Out, size_t& Hashed, FCloudWatchSha256& PayloadSha)
+{
+	PayloadSha.Update(Out.data() + Hashed, Out.size() - Hashed);
+	Hashed = Out.size();
+}
+
+static void AppendJsonMember(Aws::String& Out, const char* Name, bool& bFirst)
+{
+	if (!bFirst) Out.push_back(',');
+	bFirst = false;
+	Out.push_back('"');
+	Out.append(Name);
+	Out.append("\":", 2);
+}
+
+std::shared_ptr<Aws::IOStream> FCloudWatchPutLogEventsRequest::GetBody() const
+{
+	if (!Payload)
+	{
+		Payload = FCloudWatchBufferPool::Get().Acquire(EstimatePayloadSize());
+		FCloudWatchSha256 PayloadSha;
+		WritePayload(*Payload, PayloadSha);
+
+		uint8 Digest[FCloudWatchSha256::DigestSize];
+		PayloadSha.Final(Digest);
+		FCloudWatchEncoding::HexEncode(Digest, sizeof(Digest), PayloadHash);
+	}
+	return Aws::MakeShared<FCloudWatchPooledBufferStream>(ALLOCATION_TAG, Payload, PayloadHash);
+}
+
+size_t FCloudWatchPutLogEventsRequest::EstimatePayloadSize() const
+{
+	// exact unless messages need escaping, which only grows the buffer once
+	size_t Size = 128 + GetLogGroupName().size() + GetLogStreamName().size() + GetSequenceToken().size();
+	for (const auto& Event : GetLogEvents())
+	{
+		Size += Event.GetMessage().size() + EventOverhead;
+	}
+	return Size;
+}
+
+void FCloudWatchPutLogEventsRequest::WritePayload(Aws::String& Out, FCloudWatchSha256& PayloadSha) const
+{
+	// same members, in the same order, as PutLogEventsRequest::SerializePayload
+	size_t Hashed = 0;
+	bool bFirst = true;
+	Out.push_back('{');
+	if (LogGroupNameHasBeenSet())
+	{
+		AppendJsonMember(Out, "logGroupName", bFirst);
+		AppendJsonString(Out, GetLogGroupName());
+	}
+	if (LogStreamNameHasBeenSet())
+	{
+		AppendJsonMember(Out, "logStreamName", bFirst);
+		AppendJsonString(Out, GetLogStreamName());
+	}
+	if (LogEventsHasBeenSet())
+	{
+		AppendJsonMember(Out, "logEvents", bFirst);
+		Out.push_back('[');
+		bool bFirstEvent = true;
+		for (const auto& Event : GetLogEvents())
+		{
+			if (!bFirstEvent) Out.push_back(',');
+			bFirstEvent = false;
+
+			bool bFirstField = true;
+			Out.push_back('{');
+			if (Event.TimestampHasBeenSet())
+			{
+				char Digits[24];
+				const int Length = snprintf(Digits, sizeof(Digits), "%lld", Event.GetTimestamp());
+				AppendJsonMember(Out, "timestamp", bFirstField);
+				Out.append(Digits, Length);
+			}
+			if (Event.MessageHasBeenSet())
+			{
+				AppendJsonMember(Out, "message", bFirstField);
+				AppendJsonString(Out, Event.GetMessage());
+			}
+			Out.push_back('}');
+			HashAppended(Out, Hashed, PayloadSha);
+		}
+		Out.push_back(']');
+	}
+	if (SequenceTokenHasBeenSet())
+	{
+		AppendJsonMember(Out, "sequenceToken", bFirst);
+		AppendJsonString(Out, GetSequenceToken());
+	}
+	Out.push_back('}');
+	HashAppended(Out, Hashed, PayloadSha);
+}
+
+#endif
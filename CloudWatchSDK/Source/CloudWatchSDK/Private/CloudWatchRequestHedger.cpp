@@ -0,0 +1,160 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#include "CloudWatchRequestHedger.h"
+#include "CloudWatchRetryStrategy.h"
+
+#if WITH_CLOUDWATCH
+
+#include <algorithm>
+#include <cmath>
+
+// latencies kept per operation for the p95
+static const size_t LatencyWindowSize = 200;
+// below this many samples the p95 is noise and MinDelay is used
+static const size_t MinLatencySamples = 20;
+static const uint32 SamplesPerUpdate = 10;
+// hedges that can be sent back to back after a quiet period
+static const double MaxBudget = 10.0;
+
+static const char* ALLOCATION_TAG = "CloudWatchRequestHedger";
+
+FCloudWatchHedgeState::FCloudWatchHedgeState(float InMaxHedgeRatio, int32 MinDelayMs)
+	: Requests(0)
+	, Hedges(0)
+	, HedgeWins(0)
+	, HedgesDenied(0)
+	, MaxHedgeRatio(FMath::Clamp(static_cast<double>(InMaxHedgeRatio), 0.0, 1.0))
+	, MinDelay(FMath::Max(1, MinDelayMs))
+	, Budget(0.0)
+{
+}
+
+FCloudWatchRequestHedger::FCloudWatchRequestHedger(float InMaxHedgeRatio, int32 MinDelayMs)
+	: State(Aws::MakeShared<FCloudWatchHedgeState>(ALLOCATION_TAG, InMaxHedgeRatio, MinDelayMs))
+	, bStop(false)
+{
+	TimerThread = std::thread(&FCloudWatchRequestHedger::TimerLoop, this);
+}
+
+FCloudWatchRequestHedger::~FCloudWatchRequestHedger()
+{
+	{
+		std::lock_guard<std::mutex> Guard(TimerLock);
+		bStop = true;
+	}
+	TimerSignal.notify_one();
+	TimerThread.join();
+}
+
+void FCloudWatchHedgeState::AddBudget()
+{
+	std::lock_guard<std::mutex> Guard(BudgetLock);
+	Budget = FMath::Min(MaxBudget, Budget + MaxHedgeRatio);
+}
+
+bool FCloudWatchHedgeState::TryAcquireHedge(const Aws::String& ServiceName)
+{
+	// a second attempt only adds to the load of an endpoint that is already throttling
+	const std::shared_ptr<FCloudWatchRetryStrategy> RetryStrategy = FCloudWatchRetryStrategy::Find(ServiceName);
+	bool bAcquired = !RetryStrategy || !RetryStrategy->IsRateLimited();
+	if (bAcquired)
+	{
+		std::lock_guard<std::mutex> Guard(BudgetLock);
+		bAcquired = Budget >= 1.0;
+		if (bAcquired) Budget -= 1.0;
+	}
+
+	if (!bAcquired) HedgesDenied.fetch_add(1, std::memory_order_relaxed);
+	return bAcquired;
+}
+
+std::chrono::milliseconds FCloudWatchHedgeState::GetHedgeDelay(const Aws::String& OperationName)
+{
+	std::lock_guard<std::mutex> Guard(LatencyLock);
+	auto It = Latencies.find(OperationName);
+	if (It == Latencies.end() || It->second.Samples.size() < MinLatencySamples) return MinDelay;
+	return std::max(MinDelay, std::chrono::milliseconds(static_cast<int64>(std::ceil(It->second.P95Ms))));
+}
+
+void FCloudWatchHedgeState::RecordLatency(const Aws::String& OperationName, double LatencyMs)
+{
+	std::lock_guard<std::mutex> Guard(LatencyLock);
+	FLatencyWindow& Window = Latencies[OperationName];
+	if (Window.Samples.size() < LatencyWindowSize)
+	{
+		Window.Samples.push_back(LatencyMs);
+	}
+	else
+	{
+		Window.Samples[Window.Next] = LatencyMs;
+		Window.Next = (Window.Next + 1) % LatencyWindowSize;
+	}
+
+	if (Window.Samples.size() < MinLatencySamples || ++Window.SinceUpdate < SamplesPerUpdate) return;
+	Window.SinceUpdate = 0;
+
+	Aws::Vector<double> Sorted = Window.Samples;
+	const size_t Index = (Sorted.size() * 95) / 100;
+	std::nth_element(Sorted.begin(), Sorted.begin() + Index, Sorted.end());
+	Window.P95Ms = Sorted[Index];
+}
+
+void FCloudWatchRequestHedger::Schedule(std::chrono::milliseconds Delay, std::function<void()>&& Task)
+{
+	bool bEarliest = false;
+	{
+		std::lock_guard<std::mutex> Guard(TimerLock);
+		auto It = Timers.emplace(std::chrono::steady_clock::now() + Delay, std::move(Task));
+		bEarliest = It == Timers.begin();
+	}
+	if (bEarliest) TimerSignal.notify_one();
+}
+
+void FCloudWatchRequestHedger::TimerLoop()
+{
+	std::unique_lock<std::mutex> Guard(TimerLock);
+	while (!bStop)
+	{
+		if (Timers.empty())
+		{
+			TimerSignal.wait(Guard);
+			continue;
+		}
+
+		const auto Due = Timers.begin()->first;
+		if (std::chrono::steady_clock::now() < Due)
+		{
+			TimerSignal.wait_until(Guard, Due);
+			continue;
+		}
+
+		std::function<void()> Task = std::move(Timers.begin()->second);
+		Timers.erase(Timers.begin());
+		Guard.unlock();
+		Task();
+		Guard.lock();
+	}
+}
+
+FCloudWatchHedgeStats FCloudWatchRequestHedger::GetStats() const
+{
+	FCloudWatchHedgeStats Stats;
+	Stats.Requests = State->Requests.load(std::memory_order_relaxed);
+	Stats.Hedges = State->Hedges.load(std::memory_order_relaxed);
+	Stats.HedgeWins = State->HedgeWins.load(std::memory_order_relaxed);
+	Stats.HedgesDenied = State->HedgesDenied.load(std::memory_order_relaxed);
+	return Stats;
+}
+
+#endif
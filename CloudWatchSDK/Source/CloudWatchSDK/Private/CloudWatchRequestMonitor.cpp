@@ -0,0 +1,121 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#include "CloudWatchRequestMonitor.h"
+#include "CloudWatchOperationRateLimiter.h"
+#include "CloudWatchRetryStrategy.h"
+#include "CloudWatchConcurrencyLimiter.h"
+
+#if WITH_CLOUDWATCH
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <aws/core/utils/Outcome.h>
+
+#include <chrono>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+static const char* ALLOCATION_TAG = "CloudWatchRequestMonitor";
+
+// lives from OnRequestStarted to OnFinish of one call, across its attempts
+struct FRequestContext
+{
+	// set once the attempt is past the rate limiter and the retry strategy, so the sample is the http round trip only
+	std::chrono::steady_clock::time_point AttemptStart;
+};
+
+static void ReportAttemptLatency(const Aws::String& ServiceName, void* Context)
+{
+	FRequestContext* RequestContext = static_cast<FRequestContext*>(Context);
+	if (!RequestContext) return;
+
+	if (auto Limiter = FCloudWatchConcurrencyLimiter::Find(ServiceName))
+	{
+		const std::chrono::duration<double, std::milli> Elapsed = std::chrono::steady_clock::now() - RequestContext->AttemptStart;
+		Limiter->OnAttemptLatency(Elapsed.count());
+	}
+}
+
+void* FCloudWatchRequestMonitor::OnRequestStarted(const Aws::String& ServiceName, const Aws::String& RequestName,
+	const std::shared_ptr<const Aws::Http::HttpRequest>& Request) const
+{
+	// calls submitted through the rate limiter got their slot before reaching an executor thread; other callers only
+	// take a free slot, an attempt can't be held or cancelled from here so one over the rate is sent and counted
+	if (!FCloudWatchOperationRateLimiter::TakeSubmittedSlot())
+	{
+		FCloudWatchOperationRateLimiter::Get().TryAcquire(ServiceName, RequestName);
+	}
+	if (auto Strategy = FCloudWatchRetryStrategy::Find(ServiceName))
+	{
+		Strategy->OnAttemptStarting();
+	}
+
+	FRequestContext* RequestContext = Aws::New<FRequestContext>(ALLOCATION_TAG);
+	RequestContext->AttemptStart = std::chrono::steady_clock::now();
+	return RequestContext;
+}
+
+void FCloudWatchRequestMonitor::OnRequestSucceeded(const Aws::String& ServiceName, const Aws::String& RequestName, const std::shared_ptr<const Aws::Http::HttpRequest>& Request,
+	const Aws::Client::HttpResponseOutcome& Outcome, const Aws::Monitoring::CoreMetricsCollection& MetricsFromCore, void* Context) const
+{
+	// RetryStrategy has no success callback, the retry budget is refilled from here
+	if (auto Strategy = FCloudWatchRetryStrategy::Find(ServiceName))
+	{
+		Strategy->OnAttemptSucceeded();
+	}
+	ReportAttemptLatency(ServiceName, Context);
+}
+
+void FCloudWatchRequestMonitor::OnRequestFailed(const Aws::String& ServiceName, const Aws::String& RequestName, const std::shared_ptr<const Aws::Http::HttpRequest>& Request,
+	const Aws::Client::HttpResponseOutcome& Outcome, const Aws::Monitoring::CoreMetricsCollection& MetricsFromCore, void* Context) const
+{
+	// an attempt that never reached the endpoint says nothing about its latency
+	if (Outcome.GetError().GetResponseCode() != Aws::Http::HttpResponseCode::REQUEST_NOT_MADE)
+	{
+		ReportAttemptLatency(ServiceName, Context);
+	}
+}
+
+void FCloudWatchRequestMonitor::OnRequestRetry(const Aws::String& ServiceName, const Aws::String& RequestName,
+	const std::shared_ptr<const Aws::Http::HttpRequest>& Request, void* Context) const
+{
+	// retries count against the same quota, the retry strategy's backoff already spaced them out
+	FCloudWatchOperationRateLimiter::Get().TryAcquire(ServiceName, RequestName);
+	if (auto Strategy = FCloudWatchRetryStrategy::Find(ServiceName))
+	{
+		Strategy->OnAttemptStarting();
+	}
+
+	if (FRequestContext* RequestContext = static_cast<FRequestContext*>(Context))
+	{
+		RequestContext->AttemptStart = std::chrono::steady_clock::now();
+	}
+}
+
+void FCloudWatchRequestMonitor::OnFinish(const Aws::String& ServiceName, const Aws::String& RequestName,
+	const std::shared_ptr<const Aws::Http::HttpRequest>& Request, void* Context) const
+{
+	Aws::Delete(static_cast<FRequestContext*>(Context));
+}
+
+Aws::UniquePtr<Aws::Monitoring::MonitoringInterface> FCloudWatchRequestMonitorFactory::CreateMonitoringInstance() const
+{
+	return Aws::MakeUnique<FCloudWatchRequestMonitor>(ALLOCATION_TAG);
+}
+
+#endif
@@ -0,0 +1,245 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#include "CloudWatchRetryStrategy.h"
+#include "CloudWatchConcurrencyLimiter.h"
+
+#if WITH_CLOUDWATCH
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <aws/core/client/AWSError.h>
+#include <aws/core/client/CoreErrors.h>
+#include <aws/core/utils/memory/stl/AWSMap.h>
+
+#include <cmath>
+#include <random>
+#include <thread>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+// token costs of the SDK's standard retry mode
+static const int32 RetryCost = 5;
+static const int32 TimeoutRetryCost = 10;
+static const int32 SuccessRefund = 1;
+
+static const int32 ThrottledBaseDelayFactor = 10;
+
+// client side rate after throttling
+static const double RateCutFactor = 0.7;
+static const double MinSendRate = 1.0;
+// the rate grows by this fraction per second of successes
+static const double RateIncreasePerSecond = 0.1;
+static const std::chrono::milliseconds MeasureWindow(500);
+// without a throttle for this long and well below the limit, the limit is dropped
+static const std::chrono::seconds RateLimitIdleTimeout(30);
+
+struct FRetryStrategyRegistry
+{
+	std::mutex Lock;
+	Aws::Map<Aws::String, std::weak_ptr<FCloudWatchRetryStrategy>> Strategies;
+};
+
+static FRetryStrategyRegistry& GetRegistry()
+{
+	static FRetryStrategyRegistry Registry;
+	return Registry;
+}
+
+static std::mt19937& ThreadRandom()
+{
+	thread_local std::mt19937 Generator(std::random_device{}());
+	return Generator;
+}
+
+FCloudWatchRetryStrategy::FCloudWatchRetryStrategy(int32 InMaxRetries, int32 InBudgetTokens, int32 InBaseDelayMs, int32 InMaxDelayMs)
+	: MaxRetries(FMath::Max(0, InMaxRetries))
+	, BudgetTokens(FMath::Max(0, InBudgetTokens))
+	, BaseDelayMs(FMath::Max(1, InBaseDelayMs))
+	, MaxDelayMs(FMath::Max(FMath::Max(1, InBaseDelayMs), InMaxDelayMs))
+	, Tokens(FMath::Max(0, InBudgetTokens))
+	, Retries(0)
+	, RetriesDenied(0)
+	, Throttles(0)
+	, DelayedAttempts(0)
+	, SendLimiter(1)
+	, bRateLimited(false)
+	, SendRate(0.0)
+	, MeasuredRate(0.0)
+	, WindowStartNs(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count())
+	, WindowAttempts(0)
+{
+}
+
+bool FCloudWatchRetryStrategy::ShouldRetry(const Aws::Client::AWSError<Aws::Client::CoreErrors>& Error, long AttemptedRetries) const
+{
+	if (FCloudWatchConcurrencyLimiter::IsThrottlingError(Error))
+	{
+		OnThrottled();
+	}
+
+	// cancelled on purpose, e.g. the losing attempt of a hedged call
+	if (AttemptedRetries >= MaxRetries || !Error.ShouldRetry() || Error.GetErrorType() == Aws::Client::CoreErrors::USER_CANCELLED)
+	{
+		return false;
+	}
+
+	const Aws::Client::CoreErrors Type = Error.GetErrorType();
+	const bool bTimeout = Type == Aws::Client::CoreErrors::REQUEST_TIMEOUT || Type == Aws::Client::CoreErrors::NETWORK_CONNECTION;
+	if (!TrySpendTokens(bTimeout ? TimeoutRetryCost : RetryCost))
+	{
+		RetriesDenied.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	Retries.fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+long FCloudWatchRetryStrategy::CalculateDelayBeforeNextRetry(const Aws::Client::AWSError<Aws::Client::CoreErrors>& Error, long AttemptedRetries) const
+{
+	// a request retries on the thread that sent it, so the previous delay of this request is the thread's
+	thread_local long PreviousDelayMs = 0;
+
+	const long Base = FCloudWatchConcurrencyLimiter::IsThrottlingError(Error) ? FMath::Min(BaseDelayMs * ThrottledBaseDelayFactor, MaxDelayMs) : BaseDelayMs;
+	if (AttemptedRetries == 0 || PreviousDelayMs < Base)
+	{
+		PreviousDelayMs = Base;
+	}
+
+	// decorrelated jitter: uniform between the base and three times the previous delay
+	const long Upper = FMath::Min(static_cast<long>(MaxDelayMs), PreviousDelayMs * 3);
+	std::uniform_int_distribution<long> Distribution(Base, FMath::Max(Base, Upper));
+	PreviousDelayMs = Distribution(ThreadRandom());
+	return PreviousDelayMs;
+}
+
+bool FCloudWatchRetryStrategy::TrySpendTokens(int32 Cost) const
+{
+	int32 Available = Tokens.load(std::memory_order_relaxed);
+	do
+	{
+		if (Available < Cost) return false;
+	} while (!Tokens.compare_exchange_weak(Available, Available - Cost, std::memory_order_relaxed));
+	return true;
+}
+
+void FCloudWatchRetryStrategy::OnAttemptStarting()
+{
+	UpdateMeasuredRate();
+
+	if (!bRateLimited.load(std::memory_order_acquire)) return;
+
+	const auto Delay = SendLimiter.ApplyCost(1);
+	if (Delay.count() > 0)
+	{
+		DelayedAttempts.fetch_add(1, std::memory_order_relaxed);
+		std::this_thread::sleep_for(Delay);
+	}
+}
+
+void FCloudWatchRetryStrategy::OnAttemptSucceeded()
+{
+	int32 Available = Tokens.load(std::memory_order_relaxed);
+	while (Available < BudgetTokens && !Tokens.compare_exchange_weak(Available, FMath::Min(BudgetTokens, Available + SuccessRefund), std::memory_order_relaxed))
+	{
+	}
+
+	if (!bRateLimited.load(std::memory_order_acquire)) return;
+
+	std::lock_guard<std::mutex> Guard(RateLock);
+	const auto Now = std::chrono::steady_clock::now();
+	const double Seconds = std::chrono::duration<double>(Now - LastIncrease).count();
+	LastIncrease = Now;
+	SendRate += FMath::Max(1.0, SendRate * RateIncreasePerSecond) * Seconds;
+
+	// demand fell well below the limit and the endpoint stopped throttling => stop limiting
+	if (Now - LastThrottle > RateLimitIdleTimeout && SendRate > MeasuredRate.load(std::memory_order_relaxed) * 2.0)
+	{
+		bRateLimited.store(false, std::memory_order_release);
+		SendRate = 0.0;
+		return;
+	}
+	SendLimiter.SetRate(static_cast<int64>(std::ceil(SendRate)));
+}
+
+void FCloudWatchRetryStrategy::OnThrottled() const
+{
+	Throttles.fetch_add(1, std::memory_order_relaxed);
+
+	std::lock_guard<std::mutex> Guard(RateLock);
+	const auto Now = std::chrono::steady_clock::now();
+	const bool bWasLimited = bRateLimited.load(std::memory_order_relaxed);
+
+	// one cut per measurement window, a burst of throttles is one signal
+	if (bWasLimited && Now - LastThrottle < MeasureWindow) return;
+
+	const double Measured = MeasuredRate.load(std::memory_order_relaxed);
+	const double Current = bWasLimited ? FMath::Min(SendRate, Measured) : Measured;
+	SendRate = FMath::Max(MinSendRate, Current * RateCutFactor);
+	LastThrottle = Now;
+	LastIncrease = Now;
+	SendLimiter.SetRate(static_cast<int64>(std::ceil(SendRate)), !bWasLimited);
+	bRateLimited.store(true, std::memory_order_release);
+}
+
+void FCloudWatchRetryStrategy::UpdateMeasuredRate()
+{
+	WindowAttempts.fetch_add(1, std::memory_order_relaxed);
+	const int64 Now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	int64 Start = WindowStartNs.load(std::memory_order_relaxed);
+	const int64 ElapsedNs = Now - Start;
+	if (ElapsedNs < std::chrono::duration_cast<std::chrono::nanoseconds>(MeasureWindow).count()) return;
+
+	// the thread that moves the window on folds it into the rate, attempts counted meanwhile go to the next window
+	if (!WindowStartNs.compare_exchange_strong(Start, Now, std::memory_order_relaxed)) return;
+	const double Rate = WindowAttempts.exchange(0, std::memory_order_relaxed) / (ElapsedNs / 1000000000.0);
+	const double Previous = MeasuredRate.load(std::memory_order_relaxed);
+	MeasuredRate.store(Previous > 0.0 ? 0.5 * Previous + 0.5 * Rate : Rate, std::memory_order_relaxed);
+}
+
+FCloudWatchRetryStats FCloudWatchRetryStrategy::GetStats() const
+{
+	FCloudWatchRetryStats Stats;
+	Stats.Retries = Retries.load(std::memory_order_relaxed);
+	Stats.RetriesDenied = RetriesDenied.load(std::memory_order_relaxed);
+	Stats.Throttles = Throttles.load(std::memory_order_relaxed);
+	Stats.AvailableTokens = Tokens.load(std::memory_order_relaxed);
+	Stats.DelayedAttempts = DelayedAttempts.load(std::memory_order_relaxed);
+
+	std::lock_guard<std::mutex> Guard(RateLock);
+	Stats.SendRate = bRateLimited.load(std::memory_order_relaxed) ? SendRate : 0.0;
+	return Stats;
+}
+
+void FCloudWatchRetryStrategy::Register(const Aws::String& ServiceName, const std::shared_ptr<FCloudWatchRetryStrategy>& Strategy)
+{
+	FRetryStrategyRegistry& Registry = GetRegistry();
+	std::lock_guard<std::mutex> Guard(Registry.Lock);
+	if (Strategy) Registry.Strategies[ServiceName] = Strategy;
+	else Registry.Strategies.erase(ServiceName);
+}
+
+std::shared_ptr<FCloudWatchRetryStrategy> FCloudWatchRetryStrategy::Find(const Aws::String& ServiceName)
+{
+	FRetryStrategyRegistry& Registry = GetRegistry();
+	std::lock_guard<std::mutex> Guard(Registry.Lock);
+	auto It = Registry.Strategies.find(ServiceName);
+	return It != Registry.Strategies.end() ? It->second.lock() : nullptr;
+}
+
+#endif
@@ -21,6 +21,32 @@
 #include <aws/core/utils/Outcome.h>
 #include <aws/core/auth/AWSCredentialsProvider.h>
 #include <aws/core/client/ClientConfiguration.h>
+#include <aws/core/utils/threading/Executor.h>
+#include <aws/core/utils/logging/AWSLogging.h>
+#include <aws/logs/CloudWatchLogsEndpoint.h>
+#include <aws/monitoring/CloudWatchEndpoint.h>
+#endif
+
+#if WITH_CLOUDWATCH
+static const char* ALLOCATION_TAG = "CloudWatchSDK";
+
+// feeds throttling responses back into the client's concurrency limiter
+template<typename OutcomeType>
+static void ReportThrottling(const std::shared_ptr<FCloudWatchConcurrencyLimiter>& Limiter, const OutcomeType& Outcome)
+{
+	if (Limiter && !Outcome.IsSuccess() && FCloudWatchConcurrencyLimiter::IsThrottlingError(Outcome.GetError()))
+	{
+		Limiter->OnThrottled();
+	}
+}
+
+// per-client limiter running admitted requests on a pool sized to the concurrency ceiling
+static std::shared_ptr<FCloudWatchConcurrencyLimiter> CreateConcurrencyLimiter(const FCloudWatchClientSettings& Settings)
+{
+	const int32 PoolSize = FMath::Max(1, Settings.MaxConcurrency);
+	auto Pool = Aws::MakeShared<Aws::Utils::Threading::PooledThreadExecutor>(ALLOCATION_TAG, PoolSize);
+	return Aws::MakeShared<FCloudWatchConcurrencyLimiter>(ALLOCATION_TAG, Pool, Settings.InitialConcurrency, Settings.MinConcurrency, PoolSize, Settings.MaxQueuedRequests);
+}
 #endif
 
 ULogsCustomEventObject* ULogsCustomEventObject::CreateLogsCustomEvent(const FString& GroupName, const FString& StreamName)
@@ -35,6 +61,13 @@ ULogsCustomEventObject* ULogsCustomEventObject::CreateLogsCustomEvent(const FStr
 	return nullptr;
 }
 
+ULogsCustomEventObject::~ULogsCustomEventObject()
+{
+#if WITH_CLOUDWATCH
+	FCloudWatchUELogSystem::ClearForwardTarget(this);
+#endif
+}
+
 void ULogsCustomEventObject::Call(const FString& Message, int stackLimit /* = 1*/)
 {
 #if WITH_CLOUDWATCH
@@ -79,13 +112,18 @@ void ULogsCustomEventObject::DescribeLogGroups()
 	GroupsRequestHandler = std::bind(&ULogsCustomEventObject::OnDescribeLogGroups, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4);
 
 	// call DescribeLogStream
-	LogsClient->DescribeLogGroupsAsync(GroupsRequest, GroupsRequestHandler);
+	SubmitLogsCall("DescribeLogGroups", [Client = LogsClient, GroupsRequest, GroupsRequestHandler]()
+	{
+		GroupsRequestHandler(Client, GroupsRequest, Client->DescribeLogGroups(GroupsRequest), nullptr);
+	});
 #endif
 }
 
 void ULogsCustomEventObject::OnDescribeLogGroups(const Aws::CloudWatchLogs::CloudWatchLogsClient* Client, const Aws::CloudWatchLogs::Model::DescribeLogGroupsRequest& Request, const Aws::CloudWatchLogs::Model::DescribeLogGroupsOutcome& Outcome, const std::shared_ptr<const Aws::Client::AsyncCallerContext>& Context)
 {
 #if WITH_CLOUDWATCH
+	ReportThrottling(Limiter, Outcome);
+
 	if (!Outcome.IsSuccess())
 	{
 		LOG_WARNING(FString::Printf(TEXT("On Describe Log Groups: %s"), *FString(Outcome.GetError().GetMessage().c_str())));
@@ -122,13 +160,18 @@ void ULogsCustomEventObject::DescribeLogStreams()
 	StreamRequestHandler = std::bind(&ULogsCustomEventObject::OnDescribeLogStreams, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4);
 
 	// call DescribeLogStream
-	LogsClient->DescribeLogStreamsAsync(StreamsRequest, StreamRequestHandler);
+	SubmitLogsCall("DescribeLogStreams", [Client = LogsClient, StreamsRequest, StreamRequestHandler]()
+	{
+		StreamRequestHandler(Client, StreamsRequest, Client->DescribeLogStreams(StreamsRequest), nullptr);
+	});
 #endif
 }
 
 void ULogsCustomEventObject::OnDescribeLogStreams(const Aws::CloudWatchLogs::CloudWatchLogsClient* Client, const Aws::CloudWatchLogs::Model::DescribeLogStreamsRequest& Request, const Aws::CloudWatchLogs::Model::DescribeLogStreamsOutcome& Outcome, const std::shared_ptr<const Aws::Client::AsyncCallerContext>& Context)
 {
 #if WITH_CLOUDWATCH
+	ReportThrottling(Limiter, Outcome);
+
 	if (!Outcome.IsSuccess())
 	{
 		LOG_WARNING(FString::Printf(TEXT("On Describe Log Streams: %s"), *FString(Outcome.GetError().GetMessage().c_str())));
@@ -171,7 +214,10 @@ void ULogsCustomEventObject::RegisterGroup()
 		LogGroupRequestHandler = std::bind(&ULogsCustomEventObject::OnCreateLogGroup, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4);
 
 		// call Generate Log Group
-		LogsClient->CreateLogGroupAsync(LogGroupRequest, LogGroupRequestHandler);
+		SubmitLogsCall("CreateLogGroup", [Client = LogsClient, LogGroupRequest, LogGroupRequestHandler]()
+		{
+			LogGroupRequestHandler(Client, LogGroupRequest, Client->CreateLogGroup(LogGroupRequest), nullptr);
+		});
 	}
 #endif
 }
@@ -179,6 +225,8 @@ void ULogsCustomEventObject::RegisterGroup()
 void ULogsCustomEventObject::OnCreateLogGroup(const Aws::CloudWatchLogs::CloudWatchLogsClient* Client, const Aws::CloudWatchLogs::Model::CreateLogGroupRequest& Request, const Aws::CloudWatchLogs::Model::CreateLogGroupOutcome& Outcome, const std::shared_ptr<const Aws::Client::AsyncCallerContext>& Context)
 {
 #if WITH_CLOUDWATCH
+	ReportThrottling(Limiter, Outcome);
+
 	if (!Outcome.IsSuccess()) {
 		LOG_WARNING(FString::Printf(TEXT("Log Group Was Not Registered: %s.Process is interrupted."), *FString(Outcome.GetError().GetMessage().c_str())));
 		bIsRunning = false;
@@ -208,7 +256,10 @@ void ULogsCustomEventObject::RegisterStream()
 		Aws::CloudWatchLogs::CreateLogStreamResponseReceivedHandler LogStreamRequestHandler;
 		LogStreamRequestHandler = std::bind(&ULogsCustomEventObject::OnCreateLogStream, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4);
 		// call Generate Stream Group
-		LogsClient->CreateLogStreamAsync(LogStreamRequest, LogStreamRequestHandler);
+		SubmitLogsCall("CreateLogStream", [Client = LogsClient, LogStreamRequest, LogStreamRequestHandler]()
+		{
+			LogStreamRequestHandler(Client, LogStreamRequest, Client->CreateLogStream(LogStreamRequest), nullptr);
+		});
 	}
 #endif
 }
@@ -216,6 +267,8 @@ void ULogsCustomEventObject::RegisterStream()
 void ULogsCustomEventObject::OnCreateLogStream(const Aws::CloudWatchLogs::CloudWatchLogsClient* Client, const Aws::CloudWatchLogs::Model::CreateLogStreamRequest& Request, const Aws::CloudWatchLogs::Model::CreateLogStreamOutcome& Outcome, const std::shared_ptr<const Aws::Client::AsyncCallerContext>& Context)
 {
 #if WITH_CLOUDWATCH
+	ReportThrottling(Limiter, Outcome);
+
 	if (!Outcome.IsSuccess()) {
 		LOG_WARNING(FString::Printf(TEXT("Log Stream Was Not Registered: %s. Log Process is interrupted"), *FString(Outcome.GetError().GetMessage().c_str())));
 	}
@@ -239,10 +292,10 @@ void ULogsCustomEventObject::PutLogs()
 	}
 	
 	// setup GroupName and StreamName
-	Aws::CloudWatchLogs::Model::PutLogEventsRequest LogEventRequest;
+	FCloudWatchPutLogEventsRequest LogEventRequest;
 	LogEventRequest.SetLogGroupName(TCHAR_TO_UTF8(*GroupName));
 	LogEventRequest.SetLogStreamName(TCHAR_TO_UTF8(*StreamName));
-	LogEventRequest.SetLogEvents(Aws::Vector<Aws::CloudWatchLogs::Model::InputLogEvent>(mInputEvents)); // log stack is copied into a new aws::vector
+	LogEventRequest.SetLogEvents(std::move(mInputEvents)); // log stack is moved into the request
 
 	// clear current log stack
 	mInputEvents.clear();
@@ -254,14 +307,38 @@ void ULogsCustomEventObject::PutLogs()
 	Aws::CloudWatchLogs::PutLogEventsResponseReceivedHandler PutLogEventHandler;
 	PutLogEventHandler = std::bind(&ULogsCustomEventObject::PutLogEvent, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4);
 
-	// send Custom Log
-	LogsClient->PutLogEventsAsync(LogEventRequest, PutLogEventHandler);
+	// send Custom Log. PutLogEventsAsync would copy the request as a plain PutLogEventsRequest and serialize it the slow way
+	const int32 EventCount = static_cast<int32>(LogEventRequest.GetLogEvents().size());
+	SubmitLogsCall("PutLogEvents", [Client = LogsClient, LogEventRequest, PutLogEventHandler]()
+	{
+		PutLogEventHandler(Client, LogEventRequest, Client->PutLogEvents(LogEventRequest), nullptr);
+	}, EventCount);
+#endif
+}
+
+void ULogsCustomEventObject::SubmitLogsCall(const char* OperationName, std::function<void()>&& Call, int32 DroppedEvents /*= 0*/)
+{
+#if WITH_CLOUDWATCH
+	// the SDK's *Async wrappers drop the return of Submit, so a call shed by the limiter would leave bIsRunning set for good.
+	// PutLogEvents is rate limited per stream, the other operations per process
+	const Aws::String Stream = Aws::String(TCHAR_TO_UTF8(*GroupName)) + "/" + TCHAR_TO_UTF8(*StreamName);
+	FCloudWatchOperationRateLimiter::Get().Submit(LogsClient->GetServiceClientName(), OperationName, Stream, Executor, std::move(Call), [this, OperationName, DroppedEvents]()
+	{
+		LOG_WARNING(FString::Printf(TEXT("%s was shed by the concurrency limiter or its rate limit. Sending resumes with the next Call."), UTF8_TO_TCHAR(OperationName)));
+		if (DroppedEvents > 0)
+		{
+			LOG_WARNING(FString::Printf(TEXT("%d log events are dropped."), DroppedEvents));
+		}
+		bIsRunning = false;
+	});
 #endif
 }
 
 void ULogsCustomEventObject::PutLogEvent(const Aws::CloudWatchLogs::CloudWatchLogsClient* Client, const Aws::CloudWatchLogs::Model::PutLogEventsRequest& Request, const Aws::CloudWatchLogs::Model::PutLogEventsOutcome& Outcome, const std::shared_ptr<const Aws::Client::AsyncCallerContext>& Context)
 {
 #if WITH_CLOUDWATCH
+	ReportThrottling(Limiter, Outcome);
+
 	if (!Outcome.IsSuccess()) {
 		// we are failed!
 		LOG_WARNING(FString::Printf(TEXT("PutLogEvent Error: %s"), *FString(Outcome.GetError().GetMessage().c_str())));
@@ -323,7 +400,7 @@ void UCloudWatchCustomMetricsObject::Call(const FString& KeyName, const FString&
 		Aws::CloudWatch::Model::PutMetricDataRequest MetricDataRequest;
 		MetricDataRequest.SetNamespace(TCHAR_TO_UTF8(*NameSpace));
 		MetricDataRequest.AddMetricData(datum);
-		
+
 		// send data without callbacks
 		if (OnCloudWatchCustomMetricsSuccess.IsBound() == false || OnCloudWatchCustomMetricsFailed.IsBound() == false) {
 			CloudWatchClient->PutMetricData(MetricDataRequest);
@@ -335,15 +412,34 @@ void UCloudWatchCustomMetricsObject::Call(const FString& KeyName, const FString&
 		Aws::CloudWatch::PutMetricDataResponseReceivedHandler Handler;
 		Handler = std::bind(&UCloudWatchCustomMetricsObject::OnCustomMetricsCall, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4);
 
-		CloudWatchClient->PutMetricDataAsync(MetricDataRequest, Handler);
+		// PutMetricDataAsync would drop a call shed by the limiter without ever running the handler
+		FCloudWatchOperationRateLimiter::Get().Submit(CloudWatchClient->GetServiceClientName(), "PutMetricData", Aws::String(), Executor,
+			[Client = CloudWatchClient, MetricDataRequest, Handler]()
+			{
+				Handler(Client, MetricDataRequest, Client->PutMetricData(MetricDataRequest), nullptr);
+			},
+			[this]() { OnCustomMetricsShed(); });
+		return;
 	}
 	LOG_ERROR("CloudWatchClient is null. Did you call SetupClient and CreateCloudWatchCustomMetricsObject first?");
 #endif
 }
 
+void UCloudWatchCustomMetricsObject::OnCustomMetricsShed()
+{
+#if WITH_CLOUDWATCH
+	const FString MyErrorMessage = TEXT("PutMetricData was shed by the concurrency limiter or its rate limit. The datum is dropped.");
+	LOG_WARNING(MyErrorMessage);
+	bIsRunning = false;
+	OnCloudWatchCustomMetricsFailed.ExecuteIfBound(MyErrorMessage);
+#endif
+}
+
 void UCloudWatchCustomMetricsObject::OnCustomMetricsCall(const Aws::CloudWatch::CloudWatchClient* Client, const Aws::CloudWatch::Model::PutMetricDataRequest& Request, const Aws::CloudWatch::Model::PutMetricDataOutcome& Outcome, const std::shared_ptr<const Aws::Client::AsyncCallerContext>& Context)
 {
 #if WITH_CLOUDWATCH
+	ReportThrottling(Limiter, Outcome);
+
 	if (Outcome.IsSuccess())
 	{
 		LOG_NORMAL("Received OnCustomMetricsCall with Success outcome.");
@@ -429,8 +525,38 @@ void FCloudWatchSDKModule::StartupModule()
                 FreeDependency(AWSLogsLibraryHandle);
             }
 			
+			// gates requests by operation before they are signed and sent
+			options.monitoringOptions.customizedMonitoringFactory_create_fn.push_back([]()
+			{
+				return Aws::MakeUnique<FCloudWatchRequestMonitorFactory>(ALLOCATION_TAG);
+			});
+
+			// the SDK's own SHA-256 and HMAC, e.g. for checksums or AWSAuthV4Signer, share the plugin's stateless
+			// implementation instead of allocating a crypto context per hash
+			options.cryptoOptions.sha256Factory_create_fn = []()
+			{
+				return Aws::MakeShared<FCloudWatchSha256Factory>(ALLOCATION_TAG);
+			};
+			options.cryptoOptions.sha256HMACFactory_create_fn = []()
+			{
+				return Aws::MakeShared<FCloudWatchSha256HMACFactory>(ALLOCATION_TAG);
+			};
+			LOG_NORMAL(FString::Printf(TEXT("SHA-256 implementation: %s"), UTF8_TO_TCHAR(FCloudWatchSha256::GetImplementationName())));
+
+		#if WITH_CLOUDWATCH_CURL
+			// hands out the event driven curl client to configurations asking for CURL_CLIENT
+			HttpClientFactory = Aws::MakeShared<FCloudWatchHttpClientFactory>(ALLOCATION_TAG);
+			options.httpOptions.httpClientFactory_create_fn = [this]()
+			{
+				return HttpClientFactory;
+			};
+		#endif
+
 			Aws::InitAPI(options);
 			LOG_NORMAL("Aws::InitAPI called.");
+
+			// the chain's probes, the instance metadata one above all, run while the game starts up
+			DefaultCredentials = Aws::MakeShared<FCloudWatchCachedCredentialsChain>(ALLOCATION_TAG);
         #endif
     #endif
 #endif
@@ -468,7 +594,16 @@ void FCloudWatchSDKModule::ShutdownModule()
 	#if PLATFORM_64BITS
 		#if WITH_CLOUDWATCH
 			LOG_NORMAL("Aws::ShutdownAPI called.");
+			// worker threads sleeping for a rate slot would hold up the executors below
+			FCloudWatchOperationRateLimiter::Get().Shutdown();
+			ConnectionWarmer.reset();
+			RequestHedger.reset();
+			CredentialsRefresher.reset();
+			DefaultCredentials.reset();
+			Aws::Utils::Logging::ShutdownAWSLogging();
+			SdkLogSystem.reset();
 			Aws::ShutdownAPI(options);
+			HttpClientFactory.reset();
 		#endif
 	#endif
 #endif
@@ -483,18 +618,241 @@ void FCloudWatchSDKModule::ShutdownModule()
 }
 
 void FCloudWatchSDKModule::SetupClient(const FString& AccessKey, const FString& Secret, const FString& Region /*= "us-east-1"*/)
+{
+	SetupClient(AccessKey, Secret, Region, FCloudWatchClientSettings());
+}
+
+void FCloudWatchSDKModule::SetupClient(const FString& AccessKey, const FString& Secret, const FString& Region, const FCloudWatchClientSettings& Settings)
+{
+#if WITH_CLOUDWATCH
+	// static keys never need a refresh
+	CredentialsRefresher.reset();
+	SetupClients(Aws::MakeShared<Aws::Auth::SimpleAWSCredentialsProvider>(ALLOCATION_TAG, TCHAR_TO_UTF8(*AccessKey), TCHAR_TO_UTF8(*Secret)), Region, Settings);
+#endif
+}
+
+void FCloudWatchSDKModule::SetupClient(const std::shared_ptr<Aws::Auth::AWSCredentialsProvider>& CredentialsProvider, const FString& Region, const FCloudWatchClientSettings& Settings)
+{
+#if WITH_CLOUDWATCH
+	if (!CredentialsProvider)
+	{
+		LOG_ERROR("SetupClient called without a credentials provider.");
+		return;
+	}
+
+	CredentialsRefresher.reset();
+	if (Settings.CredentialsRefreshIntervalSeconds > 0)
+	{
+		// the wrapped provider's reload runs on the refresher's thread, request threads only read
+		CredentialsRefresher = Aws::MakeShared<FCloudWatchRefreshingCredentialsProvider>(ALLOCATION_TAG, CredentialsProvider, Settings.CredentialsRefreshIntervalSeconds, Settings.CredentialsRefreshAheadSeconds);
+		SetupClients(CredentialsRefresher, Region, Settings);
+	}
+	else
+	{
+		SetupClients(CredentialsProvider, Region, Settings);
+	}
+#endif
+}
+
+void FCloudWatchSDKModule::SetupClients(const std::shared_ptr<Aws::Auth::AWSCredentialsProvider>& CredentialsProvider, const FString& Region, const FCloudWatchClientSettings& Settings)
 {
 #if WITH_CLOUDWATCH
 	Aws::Client::ClientConfiguration ClientConfig;
-	Aws::Auth::AWSCredentials Credentials;
 
-	ClientConfig.connectTimeoutMs = 10000;
-	ClientConfig.requestTimeoutMs = 10000;
+	ClientConfig.connectTimeoutMs = Settings.ConnectTimeoutMs;
+	ClientConfig.requestTimeoutMs = Settings.RequestTimeoutMs;
+	ClientConfig.maxConnections = Settings.MaxConnections;
+	bool bUseCurlHttpClient = false;
+	if (Settings.bUseCurlHttpClient)
+	{
+#if WITH_CLOUDWATCH_CURL
+		bUseCurlHttpClient = true;
+		// picked up by FCloudWatchHttpClientFactory
+		ClientConfig.httpLibOverride = Aws::Http::TransferLibType::CURL_CLIENT;
+		if (HttpClientFactory)
+		{
+			FCloudWatchCurlOptions CurlOptions;
+			CurlOptions.bEnableHttp2 = Settings.bEnableHttp2;
+			CurlOptions.MaxStreamsPerConnection = Settings.MaxStreamsPerConnection;
+			CurlOptions.HandleAcquireTimeoutMs = Settings.CurlHandleAcquireTimeoutMs;
+			CurlOptions.MaxConnectionIdleSeconds = Settings.MaxConnectionIdleSeconds;
+			CurlOptions.DnsCacheTtlSeconds = Settings.DnsCacheTtlSeconds;
+			HttpClientFactory->SetOptions(CurlOptions);
+		}
+#else
+		LOG_WARNING("bUseCurlHttpClient is set but libcurl isn't available on this platform. Using the default http client.");
+#endif
+	}
 	ClientConfig.region = TCHAR_TO_UTF8(*Region);
 
-	Credentials = Aws::Auth::AWSCredentials(TCHAR_TO_UTF8(*AccessKey), TCHAR_TO_UTF8(*Secret));
-	LogsClient = new Aws::CloudWatchLogs::CloudWatchLogsClient(Credentials, ClientConfig);
-	CloudWatchClient = new Aws::CloudWatch::CloudWatchClient(Credentials, ClientConfig);
+	// SDK internal logging goes through a preallocated ring so request threads never wait on the file or the UE log device
+	if (Settings.SdkLogLevel != Aws::Utils::Logging::LogLevel::Off)
+	{
+		if (Settings.SdkLogFilePrefix.Len() > 0)
+		{
+			Aws::Utils::Logging::InitializeAWSLogging(Aws::MakeShared<FCloudWatchFileLogSystem>(ALLOCATION_TAG, Settings.SdkLogLevel, TCHAR_TO_UTF8(*Settings.SdkLogFilePrefix), Settings.SdkLogBufferRecords));
+			// a UE_LOG sink of an earlier SetupClient is no longer installed, ForwardSdkLogs must not configure it
+			SdkLogSystem.reset();
+		}
+		else
+		{
+			SdkLogSystem = Aws::MakeShared<FCloudWatchUELogSystem>(ALLOCATION_TAG, Settings.SdkLogLevel, Settings.SdkLogBufferRecords);
+			Aws::Utils::Logging::InitializeAWSLogging(SdkLogSystem);
+		}
+	}
+	else
+	{
+		// the log system of an earlier SetupClient would otherwise keep logging
+		Aws::Utils::Logging::ShutdownAWSLogging();
+		SdkLogSystem.reset();
+	}
+
+	// bandwidth caps are shared so they bound the whole process, not each client
+	if (Settings.WriteBytesPerSecond > 0)
+	{
+		ClientConfig.writeRateLimiter = Aws::MakeShared<FCloudWatchTokenBucketRateLimiter>(ALLOCATION_TAG, Settings.WriteBytesPerSecond);
+	}
+	if (Settings.ReadBytesPerSecond > 0)
+	{
+		ClientConfig.readRateLimiter = Aws::MakeShared<FCloudWatchTokenBucketRateLimiter>(ALLOCATION_TAG, Settings.ReadBytesPerSecond);
+	}
+
+	// every client gets its own limiter so a throttled Logs endpoint doesn't slow down metrics
+	Aws::Client::ClientConfiguration LogsConfig = ClientConfig;
+	Aws::Client::ClientConfiguration CloudWatchConfig = ClientConfig;
+	if (Settings.bEnableConcurrencyLimiter)
+	{
+		LogsLimiter = CreateConcurrencyLimiter(Settings);
+		CloudWatchLimiter = CreateConcurrencyLimiter(Settings);
+		LogsConfig.executor = LogsLimiter;
+		CloudWatchConfig.executor = CloudWatchLimiter;
+		LogsExecutor = LogsLimiter;
+	}
+	else
+	{
+		LogsLimiter.reset();
+		CloudWatchLimiter.reset();
+		if (bUseCurlHttpClient)
+		{
+			// the SDK still runs each call on an executor thread that waits for the I/O thread, so a fixed pool per
+			// client bounds those threads instead of the default executor's thread per call
+			const size_t PoolSize = static_cast<size_t>(FMath::Max(1, Settings.MaxConnections));
+			LogsExecutor = Aws::MakeShared<Aws::Utils::Threading::PooledThreadExecutor>(ALLOCATION_TAG, PoolSize);
+			CloudWatchConfig.executor = Aws::MakeShared<Aws::Utils::Threading::PooledThreadExecutor>(ALLOCATION_TAG, PoolSize);
+		}
+		else
+		{
+			LogsExecutor = Aws::MakeShared<Aws::Utils::Threading::DefaultExecutor>(ALLOCATION_TAG);
+		}
+		LogsConfig.executor = LogsExecutor;
+	}
+	CloudWatchExecutor = CloudWatchConfig.executor;
+	FCloudWatchBufferPool::Get().SetLimits(Settings.PooledBodyBuffers, Settings.MaxPooledBodyBufferBytes);
+
+	// one budget per client as well, an outage of one endpoint must not stop the other from retrying
+	LogsRetryStrategy.reset();
+	CloudWatchRetryStrategy.reset();
+	if (Settings.bEnableAdaptiveRetry)
+	{
+		LogsRetryStrategy = Aws::MakeShared<FCloudWatchRetryStrategy>(ALLOCATION_TAG, Settings.MaxRetries, Settings.RetryBudgetTokens, Settings.RetryBaseDelayMs, Settings.RetryMaxDelayMs);
+		CloudWatchRetryStrategy = Aws::MakeShared<FCloudWatchRetryStrategy>(ALLOCATION_TAG, Settings.MaxRetries, Settings.RetryBudgetTokens, Settings.RetryBaseDelayMs, Settings.RetryMaxDelayMs);
+		LogsConfig.retryStrategy = LogsRetryStrategy;
+		CloudWatchConfig.retryStrategy = CloudWatchRetryStrategy;
+	}
+
+	// the SDK clients can't be handed a signer, so requests are signed by the http client the factory wraps around
+	// them, and the clients get anonymous credentials which makes their own signer skip the request
+	bool bSignInHttpClient = false;
+#if WITH_CLOUDWATCH_CURL
+	if (HttpClientFactory)
+	{
+		std::shared_ptr<FCloudWatchSigV4Signer> Signer;
+		if (Settings.bUseCachedSigner)
+		{
+			Signer = Aws::MakeShared<FCloudWatchSigV4Signer>(ALLOCATION_TAG, CredentialsProvider, ClientConfig.region, Settings.bCorrectClockSkew);
+			bSignInHttpClient = true;
+		}
+		HttpClientFactory->SetSigner(Signer);
+	}
+#endif
+
+	if (bSignInHttpClient)
+	{
+#if WITH_CLOUDWATCH_CURL
+		// only these two clients are wrapped, never the metadata clients the credentials providers create meanwhile
+		FCloudWatchHttpClientFactory::FSignedClientScope SignedClients;
+#endif
+		LogsClient = new Aws::CloudWatchLogs::CloudWatchLogsClient(Aws::MakeShared<Aws::Auth::AnonymousAWSCredentialsProvider>(ALLOCATION_TAG), LogsConfig);
+		CloudWatchClient = new Aws::CloudWatch::CloudWatchClient(Aws::MakeShared<Aws::Auth::AnonymousAWSCredentialsProvider>(ALLOCATION_TAG), CloudWatchConfig);
+	}
+	else
+	{
+		LogsClient = new Aws::CloudWatchLogs::CloudWatchLogsClient(CredentialsProvider, LogsConfig);
+		CloudWatchClient = new Aws::CloudWatch::CloudWatchClient(CredentialsProvider, CloudWatchConfig);
+	}
+
+	// successes, attempt starts and attempt latencies reach the strategies and limiters through FCloudWatchRequestMonitor
+	FCloudWatchRetryStrategy::Register(LogsClient->GetServiceClientName(), LogsRetryStrategy);
+	FCloudWatchRetryStrategy::Register(CloudWatchClient->GetServiceClientName(), CloudWatchRetryStrategy);
+	FCloudWatchConcurrencyLimiter::Register(LogsClient->GetServiceClientName(), LogsLimiter);
+	FCloudWatchConcurrencyLimiter::Register(CloudWatchClient->GetServiceClientName(), CloudWatchLimiter);
+
+	RequestHedger.reset();
+	if (Settings.bEnableRequestHedging)
+	{
+		RequestHedger = Aws::MakeShared<FCloudWatchRequestHedger>(ALLOCATION_TAG, Settings.MaxHedgedRequestRatio, Settings.MinHedgeDelayMs);
+	}
+
+	// per operation TPS quotas, applied when the plugin submits a call and charged by FCloudWatchRequestMonitor for the rest.
+	// A rate of 0 removes the limit, which also drops the quotas of an earlier SetupClient when they are turned off
+	FCloudWatchOperationRateLimiter::Get().SetMaxWait(Settings.MaxOperationRateWaitMs);
+	for (const auto& Rate : Settings.LogsOperationRequestsPerSecond)
+	{
+		// the PutLogEvents quota applies to each log stream
+		const bool bPerStream = Rate.Key == TEXT("PutLogEvents");
+		FCloudWatchOperationRateLimiter::Get().SetOperationRate(LogsClient->GetServiceClientName(), TCHAR_TO_UTF8(*Rate.Key),
+			Settings.bEnableOperationRateLimits ? Rate.Value : 0.0, 1, bPerStream);
+	}
+	for (const auto& Rate : Settings.CloudWatchOperationRequestsPerSecond)
+	{
+		FCloudWatchOperationRateLimiter::Get().SetOperationRate(CloudWatchClient->GetServiceClientName(), TCHAR_TO_UTF8(*Rate.Key),
+			Settings.bEnableOperationRateLimits ? Rate.Value : 0.0);
+	}
+
+#if WITH_CLOUDWATCH_CURL
+	const Aws::String Scheme = Aws::Http::SchemeMapper::ToString(ClientConfig.scheme);
+	Aws::Vector<Aws::String> Endpoints;
+	if (!ClientConfig.endpointOverride.empty())
+	{
+		Endpoints.push_back(Scheme + "://" + ClientConfig.endpointOverride);
+	}
+	else
+	{
+		Endpoints.push_back(Scheme + "://" + Aws::CloudWatchLogs::CloudWatchLogsEndpoint::ForRegion(ClientConfig.region, ClientConfig.useDualStack));
+		Endpoints.push_back(Scheme + "://" + Aws::CloudWatch::CloudWatchEndpoint::ForRegion(ClientConfig.region, ClientConfig.useDualStack));
+	}
+
+	const std::shared_ptr<FCloudWatchDnsCache> DnsCache = HttpClientFactory && Settings.bUseCurlHttpClient ? HttpClientFactory->GetDnsCache() : nullptr;
+	if (DnsCache)
+	{
+		for (const Aws::String& Endpoint : Endpoints)
+		{
+			DnsCache->Prime(Aws::Http::URI(Endpoint));
+		}
+	}
+
+	// connections live in the curl multi handle shared with both clients, so warming them here serves the first real requests
+	ConnectionWarmer.reset();
+	if (HttpClientFactory && Settings.bUseCurlHttpClient && (Settings.PrewarmConnections > 0 || Settings.KeepAliveIntervalSeconds > 0))
+	{
+		ConnectionWarmer = Aws::MakeShared<FCloudWatchConnectionWarmer>(ALLOCATION_TAG, HttpClientFactory->CreateCurlHttpClient(ClientConfig), Endpoints,
+			FMath::Min(Settings.PrewarmConnections, Settings.MaxConnections), Settings.KeepAliveIntervalSeconds);
+		if (Settings.PrewarmConnections > 0)
+		{
+			ConnectionWarmer->Warm();
+		}
+	}
+#endif
 #endif
 }
 
@@ -503,6 +861,8 @@ UCloudWatchCustomMetricsObject* FCloudWatchSDKModule::CreateCloudWatchCustomMetr
 #if WITH_CLOUDWATCH
 	UCloudWatchCustomMetricsObject* Proxy = UCloudWatchCustomMetricsObject::CreateCloudWatchCustomMetrics(NameSpace, GroupName);
 	Proxy->CloudWatchClient = CloudWatchClient;
+	Proxy->Limiter = CloudWatchLimiter;
+	Proxy->Executor = CloudWatchExecutor;
 	return Proxy;
 #endif
 	return nullptr;
@@ -513,11 +873,156 @@ ULogsCustomEventObject* FCloudWatchSDKModule::CreateLogsCustomEventObject(const
 #if WITH_CLOUDWATCH
 	ULogsCustomEventObject* Proxy = ULogsCustomEventObject::CreateLogsCustomEvent(GroupName, StreamName);
 	Proxy->LogsClient = LogsClient;
+	Proxy->Limiter = LogsLimiter;
+	Proxy->Executor = LogsExecutor;
 	return Proxy;
 #endif
 	return nullptr;
 }
 
+FCloudWatchCurlPoolStats FCloudWatchSDKModule::GetCurlHandlePoolStats() const
+{
+#if WITH_CLOUDWATCH && WITH_CLOUDWATCH_CURL
+	if (HttpClientFactory)
+	{
+		return HttpClientFactory->GetHandlePoolStats();
+	}
+#endif
+	return FCloudWatchCurlPoolStats();
+}
+
+FCloudWatchDnsCacheStats FCloudWatchSDKModule::GetDnsCacheStats() const
+{
+#if WITH_CLOUDWATCH && WITH_CLOUDWATCH_CURL
+	const std::shared_ptr<FCloudWatchDnsCache> DnsCache = HttpClientFactory ? HttpClientFactory->GetDnsCache() : nullptr;
+	if (DnsCache)
+	{
+		return DnsCache->GetStats();
+	}
+#endif
+	return FCloudWatchDnsCacheStats();
+}
+
+std::shared_ptr<Aws::Auth::AWSCredentialsProvider> FCloudWatchSDKModule::GetDefaultCredentialsProvider() const
+{
+#if WITH_CLOUDWATCH
+	return DefaultCredentials;
+#else
+	return nullptr;
+#endif
+}
+
+FCloudWatchCredentialsRefreshStats FCloudWatchSDKModule::GetCredentialsRefreshStats() const
+{
+#if WITH_CLOUDWATCH
+	if (CredentialsRefresher)
+	{
+		return CredentialsRefresher->GetStats();
+	}
+#endif
+	return FCloudWatchCredentialsRefreshStats();
+}
+
+FCloudWatchSigningKeyCacheStats FCloudWatchSDKModule::GetSigningKeyCacheStats() const
+{
+#if WITH_CLOUDWATCH
+	return FCloudWatchSigningKeyCache::Get().GetStats();
+#endif
+	return FCloudWatchSigningKeyCacheStats();
+}
+
+FCloudWatchClockSkewStats FCloudWatchSDKModule::GetClockSkewStats() const
+{
+#if WITH_CLOUDWATCH && WITH_CLOUDWATCH_CURL
+	const std::shared_ptr<FCloudWatchSigV4Signer> Signer = HttpClientFactory ? HttpClientFactory->GetSigner() : nullptr;
+	if (Signer)
+	{
+		return Signer->GetClockSkewStats();
+	}
+#endif
+	return FCloudWatchClockSkewStats();
+}
+
+FCloudWatchRetryStats FCloudWatchSDKModule::GetRetryStats(bool bLogs) const
+{
+#if WITH_CLOUDWATCH
+	const std::shared_ptr<FCloudWatchRetryStrategy>& Strategy = bLogs ? LogsRetryStrategy : CloudWatchRetryStrategy;
+	if (Strategy)
+	{
+		return Strategy->GetStats();
+	}
+#endif
+	return FCloudWatchRetryStats();
+}
+
+void FCloudWatchSDKModule::GetMetricDataAsync(const Aws::CloudWatch::Model::GetMetricDataRequest& Request, const Aws::CloudWatch::GetMetricDataResponseReceivedHandler& Handler)
+{
+#if WITH_CLOUDWATCH
+	if (!CloudWatchClient)
+	{
+		LOG_ERROR("CloudWatchClient is null. Did you call SetupClient first?");
+		return;
+	}
+
+	// the handler sees a shed call as a throttled outcome, GetMetricDataAsync of the client would never call it.
+	// Captured by value, a call over its rate is rejected later from the rate limiter's delay queue
+	Aws::CloudWatch::CloudWatchClient* Client = CloudWatchClient;
+	const auto OnShed = [Client, Request, Handler]()
+	{
+		LOG_WARNING("GetMetricData was shed by the concurrency limiter or its rate limit.");
+		Handler(Client, Request, Aws::CloudWatch::Model::GetMetricDataOutcome(Aws::Client::AWSError<Aws::CloudWatch::CloudWatchErrors>(
+			Aws::CloudWatch::CloudWatchErrors::THROTTLING, "RequestShed", "GetMetricData was shed by the concurrency limiter or its rate limit", true)), nullptr);
+	};
+
+	// a local reference, SetupClient may replace the hedger while this call is being sent
+	const std::shared_ptr<FCloudWatchRequestHedger> Hedger = RequestHedger;
+	if (!Hedger)
+	{
+		FCloudWatchOperationRateLimiter::Get().Submit(Client->GetServiceClientName(), "GetMetricData", Aws::String(), CloudWatchExecutor,
+			[Client, Request, Handler]() { Handler(Client, Request, Client->GetMetricData(Request), nullptr); }, OnShed);
+		return;
+	}
+
+	const std::shared_ptr<Aws::Utils::Threading::Executor> AttemptExecutor = CloudWatchExecutor;
+	const bool bSent = Hedger->Send<Aws::CloudWatch::Model::GetMetricDataRequest, Aws::CloudWatch::Model::GetMetricDataOutcome>(Client->GetServiceClientName(), "GetMetricData", Request,
+		[Client, AttemptExecutor](const Aws::CloudWatch::Model::GetMetricDataRequest& Attempt, const std::function<void(const Aws::CloudWatch::Model::GetMetricDataOutcome&)>& Done)
+		{
+			return AttemptExecutor->Submit([Client, Attempt, Done]() { Done(Client->GetMetricData(Attempt)); });
+		},
+		[Client, Request, Handler](const Aws::CloudWatch::Model::GetMetricDataOutcome& Outcome)
+		{
+			Handler(Client, Request, Outcome, nullptr);
+		});
+	if (!bSent)
+	{
+		OnShed();
+	}
+#endif
+}
+
+FCloudWatchHedgeStats FCloudWatchSDKModule::GetHedgeStats() const
+{
+#if WITH_CLOUDWATCH
+	if (RequestHedger)
+	{
+		return RequestHedger->GetStats();
+	}
+#endif
+	return FCloudWatchHedgeStats();
+}
+
+void FCloudWatchSDKModule::ForwardSdkLogs(ULogsCustomEventObject* Target, Aws::Utils::Logging::LogLevel MinLevel /*= Aws::Utils::Logging::LogLevel::Warn*/)
+{
+#if WITH_CLOUDWATCH
+	if (!SdkLogSystem)
+	{
+		LOG_WARNING("SDK logging is not routed to UE_LOG. Call SetupClient with SdkLogLevel set and an empty SdkLogFilePrefix first.");
+		return;
+	}
+	SdkLogSystem->SetForwardTarget(Target, MinLevel);
+#endif
+}
+
 #undef LOCTEXT_NAMESPACE
 
 IMPLEMENT_MODULE(FCloudWatchSDKModule, CloudWatchSDK)
@@ -0,0 +1,280 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#include "CloudWatchSha256.h"
+#include "CloudWatchCpuFeatures.h"
+
+#if WITH_CLOUDWATCH
+
+#if CLOUDWATCH_X64
+	#include <immintrin.h>
+#endif
+
+static const uint32 RoundConstants[64] =
+{
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static inline uint32 RotateRight(uint32 Value, uint32 Bits)
+{
+	return (Value >> Bits) | (Value << (32 - Bits));
+}
+
+static void TransformScalar(uint32* State, const uint8* Block)
+{
+	uint32 Schedule[64];
+	for (int32 Index = 0; Index < 16; ++Index)
+	{
+		Schedule[Index] = (uint32(Block[4 * Index]) << 24) | (uint32(Block[4 * Index + 1]) << 16) | (uint32(Block[4 * Index + 2]) << 8) | uint32(Block[4 * Index + 3]);
+	}
+	for (int32 Index = 16; Index < 64; ++Index)
+	{
+		const uint32 S0 = RotateRight(Schedule[Index - 15], 7) ^ RotateRight(Schedule[Index - 15], 18) ^ (Schedule[Index - 15] >> 3);
+		const uint32 S1 = RotateRight(Schedule[Index - 2], 17) ^ RotateRight(Schedule[Index - 2], 19) ^ (Schedule[Index - 2] >> 10);
+		Schedule[Index] = Schedule[Index - 16] + S0 + Schedule[Index - 7] + S1;
+	}
+
+	uint32 A = State[0], B = State[1], C = State[2], D = State[3], E = State[4], F = State[5], G = State[6], H = State[7];
+	for (int32 Index = 0; Index < 64; ++Index)
+	{
+		const uint32 S1 = RotateRight(E, 6) ^ RotateRight(E, 11) ^ RotateRight(E, 25);
+		const uint32 Choose = (E & F) ^ (~E & G);
+		const uint32 Temp1 = H + S1 + Choose + RoundConstants[Index] + Schedule[Index];
+		const uint32 S0 = RotateRight(A, 2) ^ RotateRight(A, 13) ^ RotateRight(A, 22);
+		const uint32 Majority = (A & B) ^ (A & C) ^ (B & C);
+		const uint32 Temp2 = S0 + Majority;
+
+		H = G;
+		G = F;
+		F = E;
+		E = D + Temp1;
+		D = C;
+		C = B;
+		B = A;
+		A = Temp1 + Temp2;
+	}
+
+	State[0] += A;
+	State[1] += B;
+	State[2] += C;
+	State[3] += D;
+	State[4] += E;
+	State[5] += F;
+	State[6] += G;
+	State[7] += H;
+}
+
+#if CLOUDWATCH_X64
+// four rounds with the SHA-NI instructions, after Intel's reference sequence. Current holds the step's message words,
+// Next gets its final schedule update and Previous, free after that, its first one; the caller rotates the registers
+CLOUDWATCH_TARGET("sha,sse4.1,ssse3")
+static inline void ShaNiRounds(int32 Step, __m128i& State0, __m128i& State1, const __m128i& Current, __m128i& Next, __m128i& Previous)
+{
+	__m128i Rounds = _mm_add_epi32(Current, _mm_loadu_si128(reinterpret_cast<const __m128i*>(RoundConstants + 4 * Step)));
+	State1 = _mm_sha256rnds2_epu32(State1, State0, Rounds);
+	if (Step >= 3 && Step < 15)
+	{
+		Next = _mm_sha256msg2_epu32(_mm_add_epi32(Next, _mm_alignr_epi8(Current, Previous, 4)), Current);
+	}
+	Rounds = _mm_shuffle_epi32(Rounds, 0x0E);
+	State0 = _mm_sha256rnds2_epu32(State0, State1, Rounds);
+	if (Step >= 1 && Step < 13)
+	{
+		Previous = _mm_sha256msg1_epu32(Previous, Current);
+	}
+}
+
+CLOUDWATCH_TARGET("sha,sse4.1,ssse3")
+static void TransformShaNi(uint32* State, const uint8* Blocks, size_t Count)
+{
+	const __m128i ByteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+	// the instructions want the state as ABEF and CDGH
+	__m128i Temp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(State)), 0xB1);
+	__m128i State1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(State + 4)), 0x1B);
+	__m128i State0 = _mm_alignr_epi8(Temp, State1, 8);
+	State1 = _mm_blend_epi16(State1, Temp, 0xF0);
+
+	for (; Count > 0; --Count, Blocks += FCloudWatchSha256::BlockSize)
+	{
+		const __m128i SavedState0 = State0;
+		const __m128i SavedState1 = State1;
+
+		__m128i Message0 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Blocks)), ByteSwap);
+		__m128i Message1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Blocks + 16)), ByteSwap);
+		__m128i Message2 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Blocks + 32)), ByteSwap);
+		__m128i Message3 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Blocks + 48)), ByteSwap);
+
+		// unrolled by hand so the schedule stays in registers
+		for (int32 Step = 0; Step < 16; Step += 4)
+		{
+			ShaNiRounds(Step, State0, State1, Message0, Message1, Message3);
+			ShaNiRounds(Step + 1, State0, State1, Message1, Message2, Message0);
+			ShaNiRounds(Step + 2, State0, State1, Message2, Message3, Message1);
+			ShaNiRounds(Step + 3, State0, State1, Message3, Message0, Message2);
+		}
+
+		State0 = _mm_add_epi32(State0, SavedState0);
+		State1 = _mm_add_epi32(State1, SavedState1);
+	}
+
+	Temp = _mm_shuffle_epi32(State0, 0x1B);
+	State1 = _mm_shuffle_epi32(State1, 0xB1);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(State), _mm_blend_epi16(Temp, State1, 0xF0));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(State + 4), _mm_alignr_epi8(State1, Temp, 8));
+}
+#endif
+
+static bool UseShaNi()
+{
+#if CLOUDWATCH_X64
+	static const bool bShaNi = []()
+	{
+		const FCloudWatchCpuFeatures& Cpu = FCloudWatchCpuFeatures::Get();
+		return Cpu.bSha && Cpu.bSse41 && Cpu.bSsse3;
+	}();
+	return bShaNi;
+#else
+	return false;
+#endif
+}
+
+void FCloudWatchSha256::Transform(const uint8* Blocks, size_t Count)
+{
+#if CLOUDWATCH_X64
+	if (UseShaNi())
+	{
+		TransformShaNi(State, Blocks, Count);
+		return;
+	}
+#endif
+	for (; Count > 0; --Count, Blocks += BlockSize)
+	{
+		TransformScalar(State, Blocks);
+	}
+}
+
+const char* FCloudWatchSha256::GetImplementationName()
+{
+	return UseShaNi() ? "sha-ni" : "scalar";
+}
+
+void FCloudWatchSha256::Reset()
+{
+	State[0] = 0x6a09e667;
+	State[1] = 0xbb67ae85;
+	State[2] = 0x3c6ef372;
+	State[3] = 0xa54ff53a;
+	State[4] = 0x510e527f;
+	State[5] = 0x9b05688c;
+	State[6] = 0x1f83d9ab;
+	State[7] = 0x5be0cd19;
+	TotalLength = 0;
+	Buffered = 0;
+}
+
+void FCloudWatchSha256::Update(const void* Data, size_t Length)
+{
+	const uint8* Bytes = static_cast<const uint8*>(Data);
+	TotalLength += Length;
+
+	if (Buffered > 0)
+	{
+		const size_t Take = Length < BlockSize - Buffered ? Length : BlockSize - Buffered;
+		std::memcpy(Buffer + Buffered, Bytes, Take);
+		Buffered += Take;
+		Bytes += Take;
+		Length -= Take;
+		if (Buffered < BlockSize) return;
+		Transform(Buffer, 1);
+		Buffered = 0;
+	}
+
+	// whole blocks straight from the input
+	if (Length >= BlockSize)
+	{
+		const size_t Blocks = Length / BlockSize;
+		Transform(Bytes, Blocks);
+		Bytes += Blocks * BlockSize;
+		Length -= Blocks * BlockSize;
+	}
+
+	if (Length > 0)
+	{
+		std::memcpy(Buffer, Bytes, Length);
+		Buffered = Length;
+	}
+}
+
+void FCloudWatchSha256::Final(uint8* OutDigest)
+{
+	const uint64 BitLength = TotalLength * 8;
+
+	static const uint8 Padding[BlockSize] = { 0x80 };
+	// pad to 56 bytes into the block, the length takes the last 8
+	const size_t PadLength = Buffered < 56 ? 56 - Buffered : BlockSize + 56 - Buffered;
+	Update(Padding, PadLength);
+
+	uint8 LengthBytes[8];
+	for (int32 Index = 0; Index < 8; ++Index)
+	{
+		LengthBytes[Index] = static_cast<uint8>(BitLength >> (56 - 8 * Index));
+	}
+	Update(LengthBytes, sizeof(LengthBytes));
+
+	for (int32 Index = 0; Index < 8; ++Index)
+	{
+		OutDigest[4 * Index] = static_cast<uint8>(State[Index] >> 24);
+		OutDigest[4 * Index + 1] = static_cast<uint8>(State[Index] >> 16);
+		OutDigest[4 * Index + 2] = static_cast<uint8>(State[Index] >> 8);
+		OutDigest[4 * Index + 3] = static_cast<uint8>(State[Index]);
+	}
+}
+
+void FCloudWatchSha256::Hmac(const uint8* Key, size_t KeyLength, const void* Data, size_t Length, uint8* OutDigest)
+{
+	uint8 BlockKey[BlockSize] = {};
+	if (KeyLength > BlockSize)
+	{
+		FCloudWatchSha256 KeyHash;
+		KeyHash.Update(Key, KeyLength);
+		KeyHash.Final(BlockKey);
+	}
+	else
+	{
+		std::memcpy(BlockKey, Key, KeyLength);
+	}
+
+	uint8 Pad[BlockSize];
+	for (size_t Index = 0; Index < BlockSize; ++Index) Pad[Index] = BlockKey[Index] ^ 0x36;
+	FCloudWatchSha256 Inner;
+	Inner.Update(Pad, BlockSize);
+	Inner.Update(Data, Length);
+	uint8 InnerDigest[DigestSize];
+	Inner.Final(InnerDigest);
+
+	for (size_t Index = 0; Index < BlockSize; ++Index) Pad[Index] = BlockKey[Index] ^ 0x5c;
+	FCloudWatchSha256 Outer;
+	Outer.Update(Pad, BlockSize);
+	Outer.Update(InnerDigest, DigestSize);
+	Outer.Final(OutDigest);
+}
+
+#endif
@@ -0,0 +1,381 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#include "CloudWatchSigV4Signer.h"
+#include "CloudWatchGlobals.h"
+#include "CloudWatchSha256.h"
+#include "CloudWatchEncoding.h"
+#include "CloudWatchBufferPool.h"
+
+#if WITH_CLOUDWATCH
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <aws/core/http/HttpResponse.h>
+#include <aws/core/http/standard/StandardHttpResponse.h>
+#include <aws/core/utils/DateTime.h>
+#include <aws/core/utils/StringUtils.h>
+
+#include <cctype>
+#include <cstring>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+using namespace Aws::Http;
+
+static const char* ALLOCATION_TAG = "CloudWatchSigV4Signer";
+
+static const char* Algorithm = "AWS4-HMAC-SHA256";
+static const char* DateHeader = "x-amz-date";
+static const char* SecurityTokenHeader = "x-amz-security-token";
+static const char* TargetHeader = "x-amz-target";
+static const char* ScopeTerminator = "aws4_request";
+// hex SHA-256 of an empty payload
+static const char* EmptyPayloadHash = "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855";
+
+static const size_t HashHexLength = 2 * FCloudWatchSha256::DigestSize;
+static const size_t PayloadReadSize = 8192;
+
+// strings of one signature, reused by every request the thread signs so their capacity is allocated once
+struct FSigningScratch
+{
+	Aws::String SignedHeaders;
+	Aws::String StringToSign;
+	Aws::String Authorization;
+	char PayloadChunk[PayloadReadSize];
+};
+
+static std::atomic<uint64> NextSignerId(1);
+
+static FSigningScratch& GetSigningScratch()
+{
+	thread_local FSigningScratch Scratch;
+	return Scratch;
+}
+
+// same exclusions as AWSAuthV4Signer; authorization is left over from the previous attempt on a retry
+static bool IsUnsignedHeader(const Aws::String& Name)
+{
+	return Name == "user-agent" || Name == "x-amzn-trace-id" || Name == "authorization";
+}
+
+static void WriteDigits(char* Out, int32 Value, int32 Digits)
+{
+	for (int32 Index = Digits - 1; Index >= 0; --Index)
+	{
+		Out[Index] = static_cast<char>('0' + Value % 10);
+		Value /= 10;
+	}
+}
+
+// YYYYMMDDTHHMMSSZ and YYYYMMDD from milliseconds since the epoch, without a gmtime call per field
+static void FormatSigningTime(int64 Millis, char (&OutTimestamp)[17], char (&OutDate)[9])
+{
+	const int64 Seconds = Millis / 1000;
+	const int64 Days = Seconds / 86400;
+	const int32 SecondOfDay = static_cast<int32>(Seconds % 86400);
+
+	// civil date from days since 1970-01-01, proleptic Gregorian
+	const int64 Shifted = Days + 719468;
+	const int64 Era = Shifted / 146097;
+	const int64 DayOfEra = Shifted - Era * 146097;
+	const int64 YearOfEra = (DayOfEra - DayOfEra / 1460 + DayOfEra / 36524 - DayOfEra / 146096) / 365;
+	const int64 DayOfYear = DayOfEra - (365 * YearOfEra + YearOfEra / 4 - YearOfEra / 100);
+	const int64 MonthIndex = (5 * DayOfYear + 2) / 153;
+	const int32 Day = static_cast<int32>(DayOfYear - (153 * MonthIndex + 2) / 5 + 1);
+	const int32 Month = static_cast<int32>(MonthIndex < 10 ? MonthIndex + 3 : MonthIndex - 9);
+	const int32 Year = static_cast<int32>(YearOfEra + Era * 400 + (Month <= 2 ? 1 : 0));
+
+	WriteDigits(OutDate, Year, 4);
+	WriteDigits(OutDate + 4, Month, 2);
+	WriteDigits(OutDate + 6, Day, 2);
+	OutDate[8] = '\0';
+
+	std::memcpy(OutTimestamp, OutDate, 8);
+	OutTimestamp[8] = 'T';
+	WriteDigits(OutTimestamp + 9, SecondOfDay / 3600, 2);
+	WriteDigits(OutTimestamp + 11, SecondOfDay / 60 % 60, 2);
+	WriteDigits(OutTimestamp + 13, SecondOfDay % 60, 2);
+	OutTimestamp[15] = 'Z';
+	OutTimestamp[16] = '\0';
+}
+
+FCloudWatchSigV4Signer::FCloudWatchSigV4Signer(const std::shared_ptr<Aws::Auth::AWSCredentialsProvider>& InCredentialsProvider, const Aws::String& InRegion, bool bInCorrectClockSkew)
+	: CredentialsProvider(InCredentialsProvider)
+	, Region(InRegion)
+	, SignerId(NextSignerId.fetch_add(1))
+	, bCorrectClockSkew(bInCorrectClockSkew)
+{
+}
+
+int64 FCloudWatchSigV4Signer::GetSigningMillis() const
+{
+	const int64 Now = Aws::Utils::DateTime::CurrentTimeMillis();
+	return bCorrectClockSkew ? Now + ClockSkew.GetOffsetMillis() : Now;
+}
+
+void FCloudWatchSigV4Signer::ObserveResponse(const HttpResponse& Response)
+{
+	if (!bCorrectClockSkew)
+	{
+		return;
+	}
+	const int64 Now = Aws::Utils::DateTime::CurrentTimeMillis();
+	if (ClockSkew.IsSampleDue(Now) && Response.HasHeader(DATE_HEADER))
+	{
+		const Aws::String& Date = Response.GetHeader(DATE_HEADER);
+		ClockSkew.AddSample(Date.c_str(), Date.size(), Now);
+	}
+}
+
+const Aws::String& FCloudWatchSigV4Signer::GetServiceName(const HttpRequest& Request)
+{
+	static const Aws::String Logs("logs");
+	static const Aws::String Monitoring("monitoring");
+
+	// logs.<region>.amazonaws.com or monitoring.<region>.amazonaws.com
+	const Aws::String& Host = Request.GetUri().GetAuthority();
+	if (Host.compare(0, 5, "logs.") == 0) return Logs;
+	if (Host.compare(0, 11, "monitoring.") == 0) return Monitoring;
+
+	// endpoint override: Logs speaks JSON with a target header, CloudWatch speaks query
+	return Request.HasHeader(TargetHeader) && Request.GetHeaderValue(TargetHeader).compare(0, 5, "Logs_") == 0 ? Logs : Monitoring;
+}
+
+bool FCloudWatchSigV4Signer::BeginSigning(FSigningContext& Context) const
+{
+	Context.Credentials = CredentialsProvider->GetAWSCredentials();
+	if (Context.Credentials.GetAWSAccessKeyId().empty() || Context.Credentials.GetAWSSecretKey().empty())
+	{
+		LOG_ERROR("No credentials to sign the request with.");
+		Context.Second = -1;
+		return false;
+	}
+
+	char DateChars[9];
+	const int64 Millis = GetSigningMillis();
+	FormatSigningTime(Millis, Context.Timestamp, DateChars);
+	// fits the small string buffer, like the region and service names
+	Context.Date.assign(DateChars, 8);
+	Context.Second = Millis / 1000;
+	return true;
+}
+
+bool FCloudWatchSigV4Signer::SignRequest(HttpRequest& Request) const
+{
+	// a flush burst signs many requests per second on each worker, they share the credentials fetch and the formatted
+	// timestamp, so all a signature costs up front is a clock read
+	struct FCachedContext
+	{
+		uint64 SignerId = 0;
+		FSigningContext Context;
+	};
+	thread_local FCachedContext Cached;
+
+	if (Cached.SignerId != SignerId || Cached.Context.Second != GetSigningMillis() / 1000)
+	{
+		Cached.SignerId = SignerId;
+		if (!BeginSigning(Cached.Context))
+		{
+			return false;
+		}
+	}
+	SignWithContext(Request, Cached.Context);
+	return true;
+}
+
+void FCloudWatchSigV4Signer::SignWithContext(HttpRequest& Request, const FSigningContext& Context) const
+{
+	const Aws::Auth::AWSCredentials& Credentials = Context.Credentials;
+	const Aws::String& Date = Context.Date;
+	const char* Timestamp = Context.Timestamp;
+
+	if (!Credentials.GetSessionToken().empty())
+	{
+		Request.SetHeaderValue(SecurityTokenHeader, Credentials.GetSessionToken());
+	}
+
+	if (!Request.HasHeader(HOST_HEADER))
+	{
+		const URI& Uri = Request.GetUri();
+		const bool bDefaultPort = Uri.GetPort() == HTTP_DEFAULT_PORT || Uri.GetPort() == HTTPS_DEFAULT_PORT;
+		Request.SetHeaderValue(HOST_HEADER, bDefaultPort ? Uri.GetAuthority() : Uri.GetAuthority() + ":" + Aws::Utils::StringUtils::to_string(Uri.GetPort()));
+	}
+
+	Request.SetHeaderValue(DateHeader, Timestamp);
+
+	FSigningScratch& Scratch = GetSigningScratch();
+
+	// payload hash, taken from bodies that were hashed while written, otherwise read in chunks; the body is
+	// rewound for the http client
+	char PayloadHash[HashHexLength];
+	const std::shared_ptr<Aws::IOStream>& Body = Request.GetContentBody();
+	const FCloudWatchPooledBufferStream* PooledBody = dynamic_cast<const FCloudWatchPooledBufferStream*>(Body.get());
+	if (PooledBody && PooledBody->GetPayloadHash())
+	{
+		std::memcpy(PayloadHash, PooledBody->GetPayloadHash(), HashHexLength);
+	}
+	else if (Body)
+	{
+		FCloudWatchSha256 PayloadSha;
+		Body->clear();
+		Body->seekg(0);
+		while (Body->good())
+		{
+			Body->read(Scratch.PayloadChunk, PayloadReadSize);
+			PayloadSha.Update(Scratch.PayloadChunk, static_cast<size_t>(Body->gcount()));
+		}
+		Body->clear();
+		Body->seekg(0);
+
+		uint8 Digest[FCloudWatchSha256::DigestSize];
+		PayloadSha.Final(Digest);
+		FCloudWatchEncoding::HexEncode(Digest, sizeof(Digest), PayloadHash);
+	}
+	else
+	{
+		std::memcpy(PayloadHash, EmptyPayloadHash, HashHexLength);
+	}
+
+	// the canonical request goes straight into the hash instead of being built first
+	FCloudWatchSha256 Canonical;
+	Canonical.Update(HttpMethodMapper::GetNameForHttpMethod(Request.GetMethod()));
+	Canonical.Update("\n", 1);
+
+	const Aws::String& Path = Request.GetUri().GetPath();
+	if (Path.empty() || Path == "/")
+	{
+		Canonical.Update("/", 1);
+	}
+	else
+	{
+		const Aws::String EncodedPath = Request.GetUri().GetURLEncodedPath();
+		Canonical.Update(EncodedPath.c_str(), EncodedPath.size());
+	}
+	Canonical.Update("\n", 1);
+
+	if (Request.GetQueryString().size() > 1)
+	{
+		Request.CanonicalizeRequest();
+		const Aws::String& Query = Request.GetQueryString();
+		Canonical.Update(Query.c_str() + 1, Query.size() - 1);
+		if (Query.find('=') == Aws::String::npos) Canonical.Update("=", 1);
+	}
+	Canonical.Update("\n", 1);
+
+	// header names are stored lower case and sorted. The map copy is the one allocation left, HttpRequest only hands out copies
+	Scratch.SignedHeaders.clear();
+	for (const auto& Header : Request.GetHeaders())
+	{
+		if (IsUnsignedHeader(Header.first)) continue;
+
+		const Aws::String& Value = Header.second;
+		size_t First = 0;
+		size_t Last = Value.size();
+		while (First < Last && std::isspace(static_cast<unsigned char>(Value[First]))) ++First;
+		while (Last > First && std::isspace(static_cast<unsigned char>(Value[Last - 1]))) --Last;
+
+		Canonical.Update(Header.first.c_str(), Header.first.size());
+		Canonical.Update(":", 1);
+		Canonical.Update(Value.c_str() + First, Last - First);
+		Canonical.Update("\n", 1);
+
+		if (!Scratch.SignedHeaders.empty()) Scratch.SignedHeaders.push_back(';');
+		Scratch.SignedHeaders.append(Header.first);
+	}
+	Canonical.Update("\n", 1);
+	Canonical.Update(Scratch.SignedHeaders.c_str(), Scratch.SignedHeaders.size());
+	Canonical.Update("\n", 1);
+	Canonical.Update(PayloadHash, HashHexLength);
+
+	uint8 CanonicalDigest[FCloudWatchSha256::DigestSize];
+	Canonical.Final(CanonicalDigest);
+	char CanonicalHash[HashHexLength];
+	FCloudWatchEncoding::HexEncode(CanonicalDigest, sizeof(CanonicalDigest), CanonicalHash);
+
+	const Aws::String& Service = GetServiceName(Request);
+	Aws::String& StringToSign = Scratch.StringToSign;
+	StringToSign.clear();
+	StringToSign.append(Algorithm).append("\n")
+		.append(Timestamp).append("\n");
+	const size_t ScopeStart = StringToSign.size();
+	StringToSign.append(Date).append("/").append(Region).append("/").append(Service).append("/").append(ScopeTerminator);
+	const size_t ScopeLength = StringToSign.size() - ScopeStart;
+	StringToSign.append("\n").append(CanonicalHash, HashHexLength);
+
+	const FCloudWatchSigningKey Key = FCloudWatchSigningKeyCache::Get().GetKey(Credentials.GetAWSSecretKey(), Date, Region, Service);
+	uint8 Signature[FCloudWatchSha256::DigestSize];
+	FCloudWatchSha256::Hmac(Key.Bytes, sizeof(Key.Bytes), StringToSign.c_str(), StringToSign.size(), Signature);
+	char SignatureHex[HashHexLength];
+	FCloudWatchEncoding::HexEncode(Signature, sizeof(Signature), SignatureHex);
+
+	Aws::String& Authorization = Scratch.Authorization;
+	Authorization.clear();
+	Authorization.append(Algorithm)
+		.append(" Credential=").append(Credentials.GetAWSAccessKeyId()).append("/").append(StringToSign, ScopeStart, ScopeLength)
+		.append(", SignedHeaders=").append(Scratch.SignedHeaders)
+		.append(", Signature=").append(SignatureHex, HashHexLength);
+	Request.SetHeaderValue(AUTHORIZATION_HEADER, Authorization);
+}
+
+FCloudWatchSigningHttpClient::FCloudWatchSigningHttpClient(const std::shared_ptr<HttpClient>& InClient, const std::shared_ptr<FCloudWatchSigV4Signer>& InSigner)
+	: Client(InClient)
+	, Signer(InSigner)
+{
+}
+
+std::shared_ptr<HttpResponse> FCloudWatchSigningHttpClient::MakeRequest(HttpRequest& Request, Aws::Utils::RateLimits::RateLimiterInterface* ReadLimiter,
+	Aws::Utils::RateLimits::RateLimiterInterface* WriteLimiter) const
+{
+	// the request outlives the call since the wrapped client waits for it
+	const std::shared_ptr<HttpRequest> Borrowed(&Request, [](HttpRequest*) {});
+	return MakeRequest(Borrowed, ReadLimiter, WriteLimiter);
+}
+
+std::shared_ptr<HttpResponse> FCloudWatchSigningHttpClient::MakeRequest(const std::shared_ptr<HttpRequest>& Request, Aws::Utils::RateLimits::RateLimiterInterface* ReadLimiter,
+	Aws::Utils::RateLimits::RateLimiterInterface* WriteLimiter) const
+{
+	// DisableRequestProcessing and EnableRequestProcessing aren't virtual, the service client calls them on this wrapper.
+	// Pass the state on before every request; RetryRequestSleep waits on this wrapper, which Disable already wakes
+	if (IsRequestProcessingEnabled() != Client->IsRequestProcessingEnabled())
+	{
+		if (IsRequestProcessingEnabled()) Client->EnableRequestProcessing();
+		else Client->DisableRequestProcessing();
+	}
+
+	if (!Signer->SignRequest(*Request))
+	{
+		return CreateSigningFailure(Request);
+	}
+	std::shared_ptr<HttpResponse> Response = Client->MakeRequest(Request, ReadLimiter, WriteLimiter);
+	// error responses carry the service's time as well, a skew rejection included
+	if (Response)
+	{
+		Signer->ObserveResponse(*Response);
+	}
+	return Response;
+}
+
+std::shared_ptr<HttpResponse> FCloudWatchSigningHttpClient::CreateSigningFailure(const std::shared_ptr<const HttpRequest>& Request) const
+{
+	auto Response = Aws::MakeShared<Standard::StandardHttpResponse>(ALLOCATION_TAG, Request);
+	Response->SetClientErrorType(Aws::Client::CoreErrors::CLIENT_SIGNING_FAILURE);
+	Response->SetClientErrorMessage("Failed to sign the request.");
+	return Response;
+}
+
+#endif
@@ -0,0 +1,294 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#include "CloudWatchSigningKeyCache.h"
+#include "CloudWatchSha256.h"
+
+#if WITH_CLOUDWATCH
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <aws/core/utils/memory/AWSMemory.h>
+
+#include <algorithm>
+#include <cstring>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+static const char* ALLOCATION_TAG = "CloudWatchSigningKeyCache";
+
+// a day's keys of both clients plus a credential rotation or two
+static const size_t MaxSharedKeys = 16;
+static const int32 ThreadKeySlots = 4;
+
+/** A thread's own keys and its reader, released when the thread exits. */
+struct FCloudWatchSigningKeyCache::FThreadState
+{
+	FEntry Slots[ThreadKeySlots];
+	int32 Next = 0;
+	uint32 Generation = 0;
+	FReader* Reader = nullptr;
+
+	~FThreadState()
+	{
+		for (FEntry& Slot : Slots)
+		{
+			Wipe(Slot);
+		}
+		if (Reader)
+		{
+			Reader->Hazard.store(nullptr);
+			Reader->bInUse.store(false, std::memory_order_release);
+		}
+	}
+};
+
+FCloudWatchSigningKeyCache& FCloudWatchSigningKeyCache::Get()
+{
+	static FCloudWatchSigningKeyCache Instance;
+	return Instance;
+}
+
+FCloudWatchSigningKeyCache::FCloudWatchSigningKeyCache()
+	: Current(Aws::New<FSnapshot>(ALLOCATION_TAG))
+	, Generation(0)
+	, Readers(nullptr)
+	, Derivations(0)
+{
+}
+
+FCloudWatchSigningKeyCache::~FCloudWatchSigningKeyCache()
+{
+	Aws::Delete(const_cast<FSnapshot*>(Current.load()));
+	for (const FSnapshot* Snapshot : Retired)
+	{
+		Aws::Delete(const_cast<FSnapshot*>(Snapshot));
+	}
+	for (FReader* Reader = Readers.load(); Reader;)
+	{
+		FReader* Next = Reader->Next;
+		Aws::Delete(Reader);
+		Reader = Next;
+	}
+}
+
+FCloudWatchSigningKeyCache::FThreadState& FCloudWatchSigningKeyCache::GetThreadState() const
+{
+	thread_local FThreadState State;
+	return State;
+}
+
+FCloudWatchSigningKey FCloudWatchSigningKeyCache::GetKey(const Aws::String& SecretKey, const Aws::String& Date, const Aws::String& Region, const Aws::String& Service)
+{
+	// keys are a pure function of the scope, so per thread copies never go stale; they are still dropped with
+	// every new generation so a rotated secret doesn't outlive it in every thread that ever signed
+	FThreadState& State = GetThreadState();
+	const uint32 CurrentGeneration = Generation.load(std::memory_order_acquire);
+	if (State.Generation != CurrentGeneration)
+	{
+		for (FEntry& Slot : State.Slots)
+		{
+			Wipe(Slot);
+		}
+		State.Generation = CurrentGeneration;
+	}
+
+	for (const FEntry& Slot : State.Slots)
+	{
+		// empty slots have no date and never match
+		if (Slot.Matches(SecretKey, Date, Region, Service)) return Slot.Key;
+	}
+
+	if (!State.Reader)
+	{
+		State.Reader = AcquireReader();
+	}
+
+	FCloudWatchSigningKey Key;
+	if (!FindShared(*State.Reader, SecretKey, Date, Region, Service, Key))
+	{
+		Key = DeriveKey(SecretKey, Date, Region, Service);
+		Derivations.fetch_add(1, std::memory_order_relaxed);
+
+		FEntry Entry;
+		Entry.SecretKey = SecretKey;
+		Entry.Date = Date;
+		Entry.Region = Region;
+		Entry.Service = Service;
+		Entry.Key = Key;
+		Publish(std::move(Entry));
+
+		// the generation this publish started wipes this thread's slots now rather than on its next lookup
+		for (FEntry& Slot : State.Slots)
+		{
+			Wipe(Slot);
+		}
+		State.Generation = Generation.load(std::memory_order_acquire);
+	}
+
+	// assigned in place, the slot's strings keep their buffers
+	FEntry& Slot = State.Slots[State.Next];
+	Wipe(Slot);
+	Slot.SecretKey = SecretKey;
+	Slot.Date = Date;
+	Slot.Region = Region;
+	Slot.Service = Service;
+	Slot.Key = Key;
+	State.Next = (State.Next + 1) % ThreadKeySlots;
+	return Key;
+}
+
+FCloudWatchSigningKeyCache::FReader* FCloudWatchSigningKeyCache::AcquireReader() const
+{
+	// reuse the reader of an exited thread before growing the list
+	for (FReader* Reader = Readers.load(std::memory_order_acquire); Reader; Reader = Reader->Next)
+	{
+		bool bInUse = false;
+		if (!Reader->bInUse.load(std::memory_order_relaxed) && Reader->bInUse.compare_exchange_strong(bInUse, true, std::memory_order_acquire))
+		{
+			return Reader;
+		}
+	}
+
+	FReader* Reader = Aws::New<FReader>(ALLOCATION_TAG);
+	FReader* Head = Readers.load(std::memory_order_relaxed);
+	do
+	{
+		Reader->Next = Head;
+	} while (!Readers.compare_exchange_weak(Head, Reader, std::memory_order_release, std::memory_order_relaxed));
+	return Reader;
+}
+
+const FCloudWatchSigningKeyCache::FSnapshot* FCloudWatchSigningKeyCache::Protect(FReader& Reader) const
+{
+	// the hazard must be visible before Current is checked again, a writer that swapped in between sees either
+	const FSnapshot* Snapshot = Current.load();
+	for (;;)
+	{
+		Reader.Hazard.store(Snapshot);
+		const FSnapshot* Latest = Current.load();
+		if (Latest == Snapshot) return Snapshot;
+		Snapshot = Latest;
+	}
+}
+
+bool FCloudWatchSigningKeyCache::FindShared(FReader& Reader, const Aws::String& SecretKey, const Aws::String& Date, const Aws::String& Region, const Aws::String& Service, FCloudWatchSigningKey& OutKey) const
+{
+	const FSnapshot* Snapshot = Protect(Reader);
+
+	bool bFound = false;
+	for (const FEntry& Entry : Snapshot->Entries)
+	{
+		if (Entry.Matches(SecretKey, Date, Region, Service))
+		{
+			OutKey = Entry.Key;
+			bFound = true;
+			break;
+		}
+	}
+
+	Reader.Hazard.store(nullptr, std::memory_order_release);
+	// only this thread writes its counter
+	if (bFound) Reader.SharedHits.store(Reader.SharedHits.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	return bFound;
+}
+
+void FCloudWatchSigningKeyCache::Publish(FEntry&& Entry)
+{
+	std::lock_guard<std::mutex> Guard(WriteLock);
+
+	const FSnapshot* Previous = Current.load();
+	FSnapshot* Next = Aws::New<FSnapshot>(ALLOCATION_TAG);
+	Next->Entries.reserve(std::min(Previous->Entries.size() + 1, MaxSharedKeys));
+	Next->Entries.push_back(std::move(Entry));
+	for (const FEntry& Existing : Previous->Entries)
+	{
+		if (Next->Entries.size() >= MaxSharedKeys) break;
+		// another thread may have derived the same key meanwhile
+		if (Existing.Matches(Next->Entries[0].SecretKey, Next->Entries[0].Date, Next->Entries[0].Region, Next->Entries[0].Service)) continue;
+		Next->Entries.push_back(Existing);
+	}
+
+	Retired.push_back(Current.exchange(Next));
+	Generation.fetch_add(1, std::memory_order_release);
+
+	// a reader still on a replaced snapshot set its hazard before its second load of Current, so it is seen here
+	auto Last = std::remove_if(Retired.begin(), Retired.end(), [this](const FSnapshot* Snapshot)
+	{
+		for (FReader* Reader = Readers.load(std::memory_order_acquire); Reader; Reader = Reader->Next)
+		{
+			if (Reader->Hazard.load() == Snapshot) return false;
+		}
+		Aws::Delete(const_cast<FSnapshot*>(Snapshot));
+		return true;
+	});
+	Retired.erase(Last, Retired.end());
+}
+
+void FCloudWatchSigningKeyCache::Wipe(FEntry& Entry)
+{
+	// overwritten through a volatile pointer so the stores aren't dropped as dead
+	volatile char* Secret = Entry.SecretKey.empty() ? nullptr : &Entry.SecretKey[0];
+	for (size_t Index = 0; Index < Entry.SecretKey.size(); ++Index)
+	{
+		Secret[Index] = 0;
+	}
+	volatile uint8* KeyBytes = Entry.Key.Bytes;
+	for (size_t Index = 0; Index < sizeof(Entry.Key.Bytes); ++Index)
+	{
+		KeyBytes[Index] = 0;
+	}
+	Entry.SecretKey.clear();
+	Entry.Date.clear();
+}
+
+FCloudWatchSigningKey FCloudWatchSigningKeyCache::DeriveKey(const Aws::String& SecretKey, const Aws::String& Date, const Aws::String& Region, const Aws::String& Service)
+{
+	static const char Prefix[] = "AWS4";
+	static const char Terminator[] = "aws4_request";
+
+	const Aws::String Secret = Prefix + SecretKey;
+	uint8 Hash[FCloudWatchSha256::DigestSize];
+	FCloudWatchSha256::Hmac(reinterpret_cast<const uint8*>(Secret.c_str()), Secret.length(), Date.c_str(), Date.length(), Hash);
+	FCloudWatchSha256::Hmac(Hash, sizeof(Hash), Region.c_str(), Region.length(), Hash);
+	FCloudWatchSha256::Hmac(Hash, sizeof(Hash), Service.c_str(), Service.length(), Hash);
+
+	FCloudWatchSigningKey Key;
+	FCloudWatchSha256::Hmac(Hash, sizeof(Hash), Terminator, sizeof(Terminator) - 1, Key.Bytes);
+	return Key;
+}
+
+FCloudWatchSigningKeyCacheStats FCloudWatchSigningKeyCache::GetStats() const
+{
+	FCloudWatchSigningKeyCacheStats Stats;
+	Stats.Derivations = Derivations.load(std::memory_order_relaxed);
+	for (FReader* Reader = Readers.load(std::memory_order_acquire); Reader; Reader = Reader->Next)
+	{
+		Stats.SharedHits += Reader->SharedHits.load(std::memory_order_relaxed);
+	}
+
+	FThreadState& State = GetThreadState();
+	if (!State.Reader)
+	{
+		State.Reader = AcquireReader();
+	}
+	Stats.Keys = static_cast<int32>(Protect(*State.Reader)->Entries.size());
+	State.Reader->Hazard.store(nullptr, std::memory_order_release);
+	return Stats;
+}
+
+#endif
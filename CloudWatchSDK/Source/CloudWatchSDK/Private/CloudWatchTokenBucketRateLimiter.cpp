@@ -0,0 +1,76 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#include "CloudWatchTokenBucketRateLimiter.h"
+
+#if WITH_CLOUDWATCH
+
+#include <chrono>
+#include <thread>
+
+// the bucket holds one second worth of rate, like DefaultRateLimiter
+static const int64 BurstNs = 1000000000LL;
+
+FCloudWatchTokenBucketRateLimiter::FCloudWatchTokenBucketRateLimiter(int64 MaxRate)
+	: TheoreticalArrivalNs(0)
+	, Rate(1)
+{
+	SetRate(MaxRate, true);
+}
+
+int64 FCloudWatchTokenBucketRateLimiter::NowNs()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+FCloudWatchTokenBucketRateLimiter::DelayType FCloudWatchTokenBucketRateLimiter::ApplyCost(int64_t Cost)
+{
+	const int64 Now = NowNs();
+	const double NsPerUnit = static_cast<double>(BurstNs) / static_cast<double>(Rate.load(std::memory_order_relaxed));
+	const int64 CostNs = static_cast<int64>(static_cast<double>(Cost) * NsPerUnit);
+
+	int64 Expected = TheoreticalArrivalNs.load(std::memory_order_relaxed);
+	int64 Base = 0;
+	do
+	{
+		// a bucket can't hold more than one second worth of rate
+		Base = FMath::Max(Expected, Now - BurstNs);
+	} while (!TheoreticalArrivalNs.compare_exchange_weak(Expected, Base + CostNs, std::memory_order_acq_rel, std::memory_order_relaxed));
+
+	// only the debt left by previous calls has to be waited out; this call's cost is paid by the next one
+	const int64 DebtNs = Base - Now;
+	return DebtNs > 0 ? std::chrono::duration_cast<DelayType>(std::chrono::nanoseconds(DebtNs)) : DelayType(0);
+}
+
+void FCloudWatchTokenBucketRateLimiter::ApplyAndPayForCost(int64_t Cost)
+{
+	const DelayType Delay = ApplyCost(Cost);
+	if (Delay.count() > 0)
+	{
+		std::this_thread::sleep_for(Delay);
+	}
+}
+
+void FCloudWatchTokenBucketRateLimiter::SetRate(int64_t NewRate, bool bResetAccumulator /*= false*/)
+{
+	// rate must always be positive
+	Rate.store(FMath::Max(static_cast<int64>(1), static_cast<int64>(NewRate)), std::memory_order_relaxed);
+
+	// the pending delay is kept in time units, so it is preserved across rate changes without renormalizing
+	if (bResetAccumulator)
+	{
+		TheoreticalArrivalNs.store(NowNs() - BurstNs, std::memory_order_release);
+	}
+}
+
+#endif
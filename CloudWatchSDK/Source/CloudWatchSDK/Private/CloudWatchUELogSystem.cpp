@@ -0,0 +1,164 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#include "CloudWatchUELogSystem.h"
+#include "CloudWatchSDK.h"
+#include "CloudWatchGlobals.h"
+#include "Async/Async.h"
+
+#if WITH_CLOUDWATCH
+
+#include <algorithm>
+#include <mutex>
+
+using Aws::Utils::Logging::LogLevel;
+
+static const char* ALLOCATION_TAG = "CloudWatchUELogSystem";
+
+// events the forward target may have queued before forwarded lines are dropped. The upload of forwarded lines
+// logs itself, a failing or throttled stream would otherwise feed its own backlog without bound
+static const size_t MaxForwardBacklog = 10000;
+
+struct FForwardRegistry
+{
+	std::mutex Lock;
+	Aws::Vector<std::weak_ptr<void>> States;
+};
+
+static FForwardRegistry& GetForwardRegistry()
+{
+	static FForwardRegistry Registry;
+	return Registry;
+}
+
+FCloudWatchUELogSystem::FCloudWatchUELogSystem(LogLevel InLevel, int32 Capacity /*= 8192*/)
+	: FCloudWatchAsyncLogSystem(InLevel, Capacity)
+	, Forward(Aws::MakeShared<FForwardState>(ALLOCATION_TAG))
+{
+	Forward->Target.store(nullptr);
+	Forward->Level.store(LogLevel::Warn);
+	Forward->Dropped.store(0);
+
+	{
+		FForwardRegistry& Registry = GetForwardRegistry();
+		std::lock_guard<std::mutex> Guard(Registry.Lock);
+		Registry.States.erase(std::remove_if(Registry.States.begin(), Registry.States.end(), [](const std::weak_ptr<void>& State) { return State.expired(); }), Registry.States.end());
+		Registry.States.push_back(Forward);
+	}
+	StartWriter();
+}
+
+FCloudWatchUELogSystem::~FCloudWatchUELogSystem()
+{
+	StopWriter();
+}
+
+void FCloudWatchUELogSystem::SetForwardTarget(ULogsCustomEventObject* Target, LogLevel MinLevel)
+{
+	Forward->Level.store(MinLevel);
+	Forward->Target.store(Target);
+}
+
+void FCloudWatchUELogSystem::ClearForwardTarget(ULogsCustomEventObject* Target)
+{
+	FForwardRegistry& Registry = GetForwardRegistry();
+	std::lock_guard<std::mutex> Guard(Registry.Lock);
+	for (const std::weak_ptr<void>& Entry : Registry.States)
+	{
+		if (std::shared_ptr<FForwardState> State = std::static_pointer_cast<FForwardState>(Entry.lock()))
+		{
+			ULogsCustomEventObject* Expected = Target;
+			State->Target.compare_exchange_strong(Expected, nullptr);
+		}
+	}
+}
+
+void FCloudWatchUELogSystem::WriteRecord(const FCloudWatchLogRecord& Record)
+{
+	// conversion to TCHAR happens here, on the writer thread, never on the thread that logged
+	const FString Tag = UTF8_TO_TCHAR(Record.Tag);
+	const FString Message = UTF8_TO_TCHAR(Record.Message);
+
+	switch (Record.Level)
+	{
+	case LogLevel::Fatal:
+	case LogLevel::Error:
+		UE_LOG(LogCloudWatchSDK, Error, TEXT("[AWS %s] %s"), *Tag, *Message);
+		break;
+	case LogLevel::Warn:
+		UE_LOG(LogCloudWatchSDK, Warning, TEXT("[AWS %s] %s"), *Tag, *Message);
+		break;
+	case LogLevel::Info:
+		UE_LOG(LogCloudWatchSDK, Log, TEXT("[AWS %s] %s"), *Tag, *Message);
+		break;
+	case LogLevel::Debug:
+		UE_LOG(LogCloudWatchSDK, Verbose, TEXT("[AWS %s] %s"), *Tag, *Message);
+		break;
+	default:
+		UE_LOG(LogCloudWatchSDK, VeryVerbose, TEXT("[AWS %s] %s"), *Tag, *Message);
+		break;
+	}
+
+	if (Forward->Target.load(std::memory_order_relaxed) && Record.Level <= Forward->Level.load(std::memory_order_relaxed))
+	{
+		char Prefix[160];
+		FormatPrefix(Record, Prefix, sizeof(Prefix));
+		PendingForward.Add(FString(UTF8_TO_TCHAR(Prefix)) + Message);
+	}
+}
+
+void FCloudWatchUELogSystem::EndBatch()
+{
+	const uint64 TotalDropped = GetDroppedCount();
+	if (TotalDropped != ReportedDropped)
+	{
+		UE_LOG(LogCloudWatchSDK, Warning, TEXT("%llu AWS SDK log records dropped, ring buffer was full"), TotalDropped - ReportedDropped);
+		ReportedDropped = TotalDropped;
+	}
+
+	const uint64 TotalForwardDropped = Forward->Dropped.load(std::memory_order_relaxed);
+	if (TotalForwardDropped != ReportedForwardDropped)
+	{
+		UE_LOG(LogCloudWatchSDK, Warning, TEXT("%llu AWS SDK log lines not forwarded, the target's backlog was full"), TotalForwardDropped - ReportedForwardDropped);
+		ReportedForwardDropped = TotalForwardDropped;
+	}
+
+	ULogsCustomEventObject* Target = Forward->Target.load();
+	if (!Target || PendingForward.Num() == 0)
+	{
+		PendingForward.Reset();
+		return;
+	}
+
+	// ULogsCustomEventObject isn't thread safe => hand the whole batch to the game thread at once
+	TArray<FString> Lines = MoveTemp(PendingForward);
+	PendingForward.Reset();
+	std::shared_ptr<FForwardState> State = Forward;
+	AsyncTask(ENamedThreads::GameThread, [State, Target, Lines]()
+	{
+		// the target is replaced and deleted on the game thread as well, so if it is still current it is alive
+		if (State->Target.load() != Target) return;
+
+		for (int32 Index = 0; Index < Lines.Num(); ++Index)
+		{
+			if (Target->mInputEvents.size() >= MaxForwardBacklog)
+			{
+				State->Dropped.fetch_add(Lines.Num() - Index, std::memory_order_relaxed);
+				return;
+			}
+			Target->Call(Lines[Index]);
+		}
+	});
+}
+
+#endif
@@ -0,0 +1,148 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <aws/core/utils/logging/LogSystemInterface.h>
+#include <aws/core/utils/logging/LogLevel.h>
+#include <aws/core/utils/memory/stl/AWSStreamFwd.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+/** One SDK log line as it sits in the ring. Messages longer than MaxMessageLength are truncated. */
+struct CLOUDWATCHSDK_API FCloudWatchLogRecord
+{
+	static const int32 MaxTagLength = 48;
+	static const int32 MaxMessageLength = 464;
+
+	Aws::Utils::Logging::LogLevel Level;
+	int64 TimestampMs;
+	uint64 ThreadId;
+	int32 MessageLength;
+	char Tag[MaxTagLength];
+	char Message[MaxMessageLength];
+};
+
+/**
+* Log system that never blocks on the logging thread, and with Log never allocates either.
+* Records are formatted straight into a preallocated multi-producer / single-consumer ring; a writer thread drains
+* the ring in batches and hands them to WriteRecord. When the ring is full new records are dropped and counted.
+* The writer sleeps while the ring is empty and is woken by the record that ends that.
+**/
+class CLOUDWATCHSDK_API FCloudWatchAsyncLogSystem : public Aws::Utils::Logging::LogSystemInterface
+{
+public:
+	/**
+	* public FCloudWatchAsyncLogSystem::FCloudWatchAsyncLogSystem
+	* @param InLevel [LogLevel] Records above this level are discarded before formatting.
+	* @param Capacity [int32] Number of records in the ring, rounded up to a power of two.
+	**/
+	FCloudWatchAsyncLogSystem(Aws::Utils::Logging::LogLevel InLevel, int32 Capacity);
+	virtual ~FCloudWatchAsyncLogSystem();
+
+	Aws::Utils::Logging::LogLevel GetLogLevel(void) const override { return Level.load(std::memory_order_relaxed); }
+	void SetLogLevel(Aws::Utils::Logging::LogLevel InLevel) { Level.store(InLevel, std::memory_order_relaxed); }
+
+	void Log(Aws::Utils::Logging::LogLevel InLevel, const char* Tag, const char* FormatStr, ...) override;
+	void LogStream(Aws::Utils::Logging::LogLevel InLevel, const char* Tag, const Aws::OStringStream& MessageStream) override;
+
+	/** Blocks until every record logged before the call has been written. */
+	void Flush() override;
+
+	/** Records dropped because the ring was full. */
+	uint64 GetDroppedCount() const { return Dropped.load(std::memory_order_relaxed); }
+
+protected:
+	/** Called on the writer thread for every record, in order. */
+	virtual void WriteRecord(const FCloudWatchLogRecord& Record) = 0;
+	/** Called on the writer thread after each batch. */
+	virtual void EndBatch() {}
+
+	/** Must be called by the most derived constructor, once WriteRecord can be called. */
+	void StartWriter();
+	/** Must be called by the most derived destructor so WriteRecord isn't called on a destroyed object. */
+	void StopWriter();
+
+	/** Formats the common "[LEVEL] timestamp tag [thread] " prefix. */
+	static int32 FormatPrefix(const FCloudWatchLogRecord& Record, char* Buffer, int32 BufferSize);
+
+private:
+	struct FSlot
+	{
+		std::atomic<uint64> Sequence;
+		FCloudWatchLogRecord Record;
+	};
+
+	FCloudWatchLogRecord* BeginRecord(Aws::Utils::Logging::LogLevel InLevel, const char* Tag, uint64& OutPosition);
+	void CommitRecord(uint64 Position);
+	bool HasPendingRecords() const;
+	void WriterLoop();
+	int32 Drain();
+
+	std::atomic<Aws::Utils::Logging::LogLevel> Level;
+
+	std::unique_ptr<FSlot[]> Slots;
+	uint64 Mask;
+	std::atomic<uint64> EnqueuePosition;
+	uint64 DequeuePosition;
+	std::atomic<uint64> Dropped;
+
+	std::mutex WriterLock;
+	std::condition_variable WriterSignal;
+	std::condition_variable FlushedSignal;
+	std::atomic<bool> bStopWriter;
+	// set by the writer before it checks the ring and sleeps, cleared by the producer that wakes it
+	std::atomic<bool> bWriterIdle;
+	uint64 FlushRequests;
+	uint64 FlushedRequests;
+	std::thread Writer;
+};
+
+/**
+* FCloudWatchAsyncLogSystem writing to a file named FilenamePrefix + timestamp + ".log", like Aws::Utils::Logging::DefaultLogSystem.
+* A new file is started every hour, on the writer thread.
+**/
+class CLOUDWATCHSDK_API FCloudWatchFileLogSystem : public FCloudWatchAsyncLogSystem
+{
+public:
+	FCloudWatchFileLogSystem(Aws::Utils::Logging::LogLevel InLevel, const Aws::String& FilenamePrefix, int32 Capacity = 8192);
+	virtual ~FCloudWatchFileLogSystem();
+
+protected:
+	void WriteRecord(const FCloudWatchLogRecord& Record) override;
+	void EndBatch() override;
+
+private:
+	/** Opens the file of the hour TimestampMs falls in. */
+	void OpenFile(int64 TimestampMs);
+
+	const Aws::String FilenamePrefix;
+	std::shared_ptr<Aws::OFStream> LogFile;
+	/** Hours since the epoch covered by LogFile. */
+	int64 FileHour = 0;
+	uint64 ReportedDropped = 0;
+};
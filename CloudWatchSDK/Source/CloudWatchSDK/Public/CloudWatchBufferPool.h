@@ -0,0 +1,147 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <aws/core/utils/memory/stl/AWSStreamFwd.h>
+#include <aws/core/utils/memory/stl/AWSString.h>
+#include <aws/core/utils/memory/stl/AWSVector.h>
+#include <aws/core/utils/stream/PreallocatedStreamBuf.h>
+
+#include <memory>
+#include <mutex>
+#include <streambuf>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+/** Reuse counters of the buffer pool. */
+struct CLOUDWATCHSDK_API FCloudWatchBufferPoolStats
+{
+	uint64 Acquires = 0;
+	/** Acquires served by a pooled buffer instead of a new allocation. */
+	uint64 Reuses = 0;
+	int32 FreeBuffers = 0;
+	uint64 FreeBytes = 0;
+};
+
+/**
+* Process-wide pool of byte buffers for request and response bodies.
+* A buffer goes back to the pool when its last reference is dropped, with its capacity kept, so steady traffic stops
+* allocating body memory after the first few requests. Buffers above the size cap are freed instead, which bounds RSS.
+**/
+class CLOUDWATCHSDK_API FCloudWatchBufferPool
+{
+public:
+	static FCloudWatchBufferPool& Get();
+
+	/**
+	* public FCloudWatchBufferPool::SetLimits
+	* @param MaxFreeBuffers [int32] Released buffers kept for reuse.
+	* @param MaxBufferBytes [int32] Capacity above which a released buffer is freed.
+	**/
+	void SetLimits(int32 MaxFreeBuffers, int32 MaxBufferBytes);
+
+	/**
+	* public FCloudWatchBufferPool::Acquire
+	* @param MinCapacity [size_t] Bytes reserved up front.
+	* @return [std::shared_ptr<Aws::String>] Empty buffer. Only the bytes matter, it isn't meant as text.
+	**/
+	std::shared_ptr<Aws::String> Acquire(size_t MinCapacity);
+
+	FCloudWatchBufferPoolStats GetStats() const;
+
+private:
+	FCloudWatchBufferPool();
+	void Release(Aws::String* Buffer);
+
+	mutable std::mutex Lock;
+	Aws::Vector<Aws::String*> Free;
+	int32 MaxFreeBuffers;
+	size_t MaxBufferBytes;
+	FCloudWatchBufferPoolStats Stats;
+};
+
+/**
+* Read-only stream over a pooled buffer. Reads copy straight out of the buffer, and the buffer stays referenced
+* until the stream is destroyed.
+**/
+class CLOUDWATCHSDK_API FCloudWatchPooledBufferStream : public Aws::IOStream
+{
+public:
+	/**
+	* public FCloudWatchPooledBufferStream::FCloudWatchPooledBufferStream
+	* @param InBuffer [const std::shared_ptr<Aws::String>&] Body bytes.
+	* @param InPayloadHash [const char*] Hex SHA-256 of the bytes, 64 chars, if the writer computed it. The signer uses it instead of reading the body again.
+	**/
+	explicit FCloudWatchPooledBufferStream(const std::shared_ptr<Aws::String>& InBuffer, const char* InPayloadHash = nullptr);
+
+	/** Hex SHA-256 of the body, 64 chars without a terminator. nullptr if it wasn't computed while writing. */
+	const char* GetPayloadHash() const { return bHasPayloadHash ? PayloadHash : nullptr; }
+
+private:
+	std::shared_ptr<Aws::String> Buffer;
+	Aws::Utils::Stream::PreallocatedStreamBuf StreamBuf;
+	char PayloadHash[64];
+	bool bHasPayloadHash;
+};
+
+/**
+* Stream buffer appending to a pooled buffer and reading back from it. The bytes stay contiguous, so the whole
+* content can be handed to a parser as one string once writing is done.
+**/
+class CLOUDWATCHSDK_API FCloudWatchGrowableStreamBuf : public std::streambuf
+{
+public:
+	explicit FCloudWatchGrowableStreamBuf(const std::shared_ptr<Aws::String>& InBuffer);
+
+	/** Grows the capacity ahead of writes, e.g. to a response's Content-Length. */
+	void Reserve(size_t Bytes);
+
+	const Aws::String& GetContents() const { return *Buffer; }
+
+protected:
+	int_type overflow(int_type Char) override;
+	std::streamsize xsputn(const char_type* Data, std::streamsize Count) override;
+	int_type underflow() override;
+	pos_type seekoff(off_type Offset, std::ios_base::seekdir Direction, std::ios_base::openmode Which) override;
+	pos_type seekpos(pos_type Position, std::ios_base::openmode Which) override;
+
+private:
+	// appends move the data, so the get area is rebuilt from the read offset after each one
+	void ResetGetArea(size_t ReadOffset);
+
+	std::shared_ptr<Aws::String> Buffer;
+};
+
+/** Response body stream over a pooled buffer. The buffer returns to the pool when the response is destroyed. */
+class CLOUDWATCHSDK_API FCloudWatchPooledResponseStream : public Aws::IOStream
+{
+public:
+	explicit FCloudWatchPooledResponseStream(const std::shared_ptr<Aws::String>& InBuffer);
+
+	void Reserve(size_t Bytes) { StreamBuf.Reserve(Bytes); }
+
+	/** Everything written so far, as one contiguous string. */
+	const Aws::String& GetContents() const { return StreamBuf.GetContents(); }
+
+private:
+	FCloudWatchGrowableStreamBuf StreamBuf;
+};
@@ -0,0 +1,143 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <aws/core/utils/logging/LogLevel.h>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+/**
+* Tuning knobs for the Logs and Monitoring clients created by FCloudWatchSDKModule::SetupClient.
+* The plain SetupClient(AccessKey, Secret, Region) call uses these defaults too, so every setting that changes how
+* requests are sent, retried or signed is off by default and those clients behave like bare SDK clients: the
+* concurrency limiter, adaptive retry, the cached signer with its clock skew correction, the per-operation rate
+* limits, hedging and the curl client, with its prewarming and DNS cache.
+**/
+struct CLOUDWATCHSDK_API FCloudWatchClientSettings
+{
+	/** Socket connect timeout in milliseconds. */
+	int32 ConnectTimeoutMs = 10000;
+	/** Socket read timeout in milliseconds. */
+	int32 RequestTimeoutMs = 10000;
+	/** Max concurrent tcp connections per client. */
+	int32 MaxConnections = 25;
+	/**
+	* Run requests on FCloudWatchCurlHttpClient, where one I/O thread drives every connection of both clients.
+	* Each call still waits on an executor thread; without the concurrency limiter they come from a pool of MaxConnections threads per client.
+	**/
+	bool bUseCurlHttpClient = false;
+	/** Let the curl client negotiate HTTP/2 and multiplex requests over a few connections. Falls back to HTTP/1.1. */
+	bool bEnableHttp2 = true;
+	/** Concurrent HTTP/2 streams per connection. */
+	int32 MaxStreamsPerConnection = 100;
+	/** How long a request waits for a free curl handle before failing with a retryable error. */
+	int32 CurlHandleAcquireTimeoutMs = 1000;
+	/** Connections opened to each endpoint by SetupClient, so the first requests skip DNS, TCP and TLS. 0 disables. Needs the curl client. */
+	int32 PrewarmConnections = 0;
+	/** Seconds between background keep-alive pings to each endpoint. 0 disables. Needs the curl client. */
+	int32 KeepAliveIntervalSeconds = 0;
+	/** Idle connections older than this are closed instead of reused, so connections dropped by a NAT are never picked up. */
+	int32 MaxConnectionIdleSeconds = 50;
+	/** Seconds endpoint addresses are cached before they are refreshed in the background, so requests never wait on the resolver. 0 disables. Needs the curl client. */
+	int32 DnsCacheTtlSeconds = 0;
+
+	/** Adapt the number of in-flight async requests per client to observed latency and throttling. */
+	bool bEnableConcurrencyLimiter = false;
+	/** Limit the adaptive concurrency limiter starts from. */
+	int32 InitialConcurrency = 8;
+	/** Lower bound of the adaptive concurrency limit. */
+	int32 MinConcurrency = 1;
+	/** Upper bound of the adaptive concurrency limit. Also the size of the per-client thread pool. */
+	int32 MaxConcurrency = 25;
+	/** Requests queued above the limit before new ones are shed. 0 means the queue is unbounded. */
+	int32 MaxQueuedRequests = 1000;
+
+	/** Retry through FCloudWatchRetryStrategy: a per-client retry budget, jittered delays and a send rate cut on throttling. Off keeps the SDK's default retries. */
+	bool bEnableAdaptiveRetry = false;
+	/** Retries per request, budget permitting. */
+	int32 MaxRetries = 10;
+	/** Tokens of each client's retry budget. A retry costs 5, 10 after a timeout, every success refunds 1. */
+	int32 RetryBudgetTokens = 500;
+	/** Smallest delay before a retry in milliseconds. */
+	int32 RetryBaseDelayMs = 50;
+	/** Largest delay before a retry in milliseconds. */
+	int32 RetryMaxDelayMs = 20000;
+
+	/**
+	* Send a second attempt of FCloudWatchSDKModule::GetMetricDataAsync calls that run longer than their recent p95 latency,
+	* and use whichever answers first. PutMetricData is never hedged, a datum that reached the service twice is stored twice.
+	**/
+	bool bEnableRequestHedging = false;
+	/** Extra requests hedging may add, as a fraction of the hedged calls. */
+	float MaxHedgedRequestRatio = 0.05f;
+	/** Smallest delay before a hedge is sent in milliseconds. */
+	int32 MinHedgeDelayMs = 20;
+
+	/**
+	* Sign requests with FCloudWatchSigV4Signer, which shares signing keys across both clients and all worker threads
+	* without locking. Off leaves signing to each client's own AWSAuthV4Signer. Needs the curl plugin build.
+	**/
+	bool bUseCachedSigner = false;
+	/** Sign with the service's time, estimated from the Date header of responses, so a wrong local clock doesn't get requests rejected. Needs bUseCachedSigner. */
+	bool bCorrectClockSkew = false;
+
+	/** Longest time between background refreshes of a credentials provider passed to SetupClient. 0 reads the provider on the request threads. */
+	int32 CredentialsRefreshIntervalSeconds = 60;
+	/** How long before their expiration provider credentials are renewed. */
+	int32 CredentialsRefreshAheadSeconds = 300;
+
+	/** Outgoing bandwidth cap in bytes per second shared by both clients. 0 means unlimited. */
+	int64 WriteBytesPerSecond = 0;
+	/** Incoming bandwidth cap in bytes per second shared by both clients. 0 means unlimited. */
+	int64 ReadBytesPerSecond = 0;
+	/** Released body buffers kept for reuse by later requests. */
+	int32 PooledBodyBuffers = 16;
+	/** Body buffers that grew past this many bytes are freed instead of pooled. */
+	int32 MaxPooledBodyBufferBytes = 2 * 1024 * 1024;
+
+	/** Queue the plugin's requests above the rates below, and charge other requests to them. */
+	bool bEnableOperationRateLimits = false;
+	/**
+	* Requests per second allowed per CloudWatch Logs operation in this process. Requests above the rate are queued.
+	* PutLogEvents is limited per log group and stream, its service quota is 5 requests per second per stream.
+	**/
+	TMap<FString, float> LogsOperationRequestsPerSecond = {
+		{ TEXT("DescribeLogGroups"), 5.0f },
+		{ TEXT("DescribeLogStreams"), 5.0f },
+		{ TEXT("CreateLogGroup"), 5.0f },
+		{ TEXT("CreateLogStream"), 50.0f },
+		{ TEXT("PutLogEvents"), 5.0f }
+	};
+	/** Requests per second allowed per CloudWatch (Monitoring) operation in this process. Requests above the rate are queued. */
+	TMap<FString, float> CloudWatchOperationRequestsPerSecond = {
+		{ TEXT("PutMetricData"), 150.0f }
+	};
+	/** Longest time a request waits for its operation's rate. Requests that would wait longer fail as throttled. */
+	int32 MaxOperationRateWaitMs = 2000;
+
+	/** Verbosity of the SDK's internal logging. Off keeps the SDK silent. */
+	Aws::Utils::Logging::LogLevel SdkLogLevel = Aws::Utils::Logging::LogLevel::Off;
+	/** SDK log lines are written to SdkLogFilePrefix + timestamp + ".log". When empty they go to the LogCloudWatchSDK category. */
+	FString SdkLogFilePrefix;
+	/** SDK log records buffered before new ones are dropped. */
+	int32 SdkLogBufferRecords = 8192;
+};
@@ -0,0 +1,81 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+
+/** Clock skew between this machine and the service, as seen by FCloudWatchClockSkewEstimator. */
+struct CLOUDWATCHSDK_API FCloudWatchClockSkewStats
+{
+	/** Date headers that went into the estimate. */
+	uint64 Samples = 0;
+	/** Smoothed server time minus local time in milliseconds. */
+	int64 EstimatedOffsetMillis = 0;
+	/** Offset added to signing timestamps, 0 while the estimate is within the Date header's resolution. */
+	int64 AppliedOffsetMillis = 0;
+};
+
+/**
+* Estimates the clock skew from the Date header of responses, so requests are signed with the server's time before
+* the service rejects one as skewed. The SDK only corrects its signer after such a rejection, and with the clients on
+* anonymous credentials its correction never reaches FCloudWatchSigV4Signer anyway.
+* At most one response per sample interval is looked at, by whichever thread gets it first; the others only compare a
+* timestamp. The offset signers read is a single atomic.
+**/
+class CLOUDWATCHSDK_API FCloudWatchClockSkewEstimator
+{
+public:
+	FCloudWatchClockSkewEstimator();
+
+	/**
+	* public FCloudWatchClockSkewEstimator::IsSampleDue
+	* @return [bool] True if the next response's Date header should be passed to AddSample.
+	**/
+	bool IsSampleDue(int64 NowMillis) const { return NowMillis >= NextSampleMillis.load(std::memory_order_relaxed); }
+
+	/**
+	* public FCloudWatchClockSkewEstimator::AddSample
+	* @param DateHeader [const char*] RFC 1123 date, e.g. "Sun, 06 Nov 1994 08:49:37 GMT". Unparsable dates are ignored.
+	* @param ReceivedMillis [int64] Local time the response arrived.
+	**/
+	void AddSample(const char* DateHeader, size_t Length, int64 ReceivedMillis);
+
+	/** Milliseconds to add to the local clock for signing. */
+	int64 GetOffsetMillis() const { return AppliedOffsetMillis.load(std::memory_order_relaxed); }
+
+	FCloudWatchClockSkewStats GetStats() const;
+
+	/**
+	* public static FCloudWatchClockSkewEstimator::ParseHttpDate
+	* @param OutMillis [int64&] Milliseconds since the epoch.
+	* @return [bool] False unless Text is an RFC 1123 date in GMT.
+	**/
+	static bool ParseHttpDate(const char* Text, size_t Length, int64& OutMillis);
+
+private:
+	std::atomic<int64> NextSampleMillis;
+
+	// held by the one thread adding a sample
+	std::mutex SampleLock;
+	bool bHasEstimate;
+	double EstimateMillis;
+
+	std::atomic<int64> EstimatedOffsetMillis;
+	std::atomic<int64> AppliedOffsetMillis;
+	std::atomic<uint64> Samples;
+};
@@ -0,0 +1,125 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <aws/core/utils/threading/Executor.h>
+#include <aws/core/client/AWSError.h>
+#include <aws/core/client/CoreErrors.h>
+#include <aws/core/http/HttpResponse.h>
+#include <aws/core/utils/memory/stl/AWSString.h>
+
+#include <chrono>
+#include <deque>
+#include <mutex>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+/**
+* Executor that caps the number of in-flight async requests of a single client.
+* The limit follows AIMD: it grows by roughly one per round trip while latency stays near the observed minimum,
+* shrinks with the latency gradient when requests start queueing on the endpoint and is cut multiplicatively on throttling.
+* Latency is sampled per http attempt, and the limit is cut at most once per smoothed round trip.
+* Requests above the limit wait in a FIFO queue and are shed once the queue is full.
+**/
+class CLOUDWATCHSDK_API FCloudWatchConcurrencyLimiter : public Aws::Utils::Threading::Executor
+{
+public:
+	/**
+	* public FCloudWatchConcurrencyLimiter::FCloudWatchConcurrencyLimiter
+	* @param InnerExecutor [const std::shared_ptr<Executor>&] Executor the admitted requests are run on.
+	* @param InitialLimit [int32] Limit to start from.
+	* @param MinLimit [int32] Lower bound of the limit.
+	* @param MaxLimit [int32] Upper bound of the limit.
+	* @param MaxQueued [int32] Requests waiting above the limit before new ones are shed. 0 means unbounded.
+	**/
+	FCloudWatchConcurrencyLimiter(const std::shared_ptr<Aws::Utils::Threading::Executor>& InnerExecutor, int32 InitialLimit, int32 MinLimit, int32 MaxLimit, int32 MaxQueued);
+
+	/** Drops the queued requests and joins the inner executor while the limiter state is still alive. */
+	virtual ~FCloudWatchConcurrencyLimiter();
+
+	/**
+	* public FCloudWatchConcurrencyLimiter::OnThrottled
+	* Reports a throttling response. Cuts the limit at most once per smoothed round trip.
+	**/
+	void OnThrottled();
+
+	/**
+	* public FCloudWatchConcurrencyLimiter::OnAttemptLatency
+	* Reports the round trip of one http attempt, without retry backoff or rate limiter waits. Reported by FCloudWatchRequestMonitor.
+	* @param LatencyMs [double] Time from sending the attempt to receiving its response.
+	**/
+	void OnAttemptLatency(double LatencyMs);
+
+	int32 GetLimit() const;
+	int32 GetInFlight() const;
+	int32 GetQueued() const;
+	uint64 GetShedCount() const;
+
+	/**
+	* public static FCloudWatchConcurrencyLimiter::IsThrottlingError
+	* Works for CloudWatchLogsErrors, CloudWatchErrors and CoreErrors since the services share the core error range.
+	**/
+	template<typename ERROR_TYPE>
+	static bool IsThrottlingError(const Aws::Client::AWSError<ERROR_TYPE>& Error)
+	{
+		const Aws::Client::CoreErrors CoreError = static_cast<Aws::Client::CoreErrors>(Error.GetErrorType());
+		return CoreError == Aws::Client::CoreErrors::THROTTLING
+			|| CoreError == Aws::Client::CoreErrors::SLOW_DOWN
+			|| Error.GetResponseCode() == Aws::Http::HttpResponseCode::TOO_MANY_REQUESTS;
+	}
+
+	/**
+	* public static FCloudWatchConcurrencyLimiter::Register
+	* Makes the limiter reachable from the monitoring callbacks, which only know the service name.
+	* @param ServiceName [const Aws::String&] Service client name, as returned by GetServiceClientName().
+	* @param Limiter [const std::shared_ptr<FCloudWatchConcurrencyLimiter>&] Limiter of that client. nullptr unregisters.
+	**/
+	static void Register(const Aws::String& ServiceName, const std::shared_ptr<FCloudWatchConcurrencyLimiter>& Limiter);
+	static std::shared_ptr<FCloudWatchConcurrencyLimiter> Find(const Aws::String& ServiceName);
+
+protected:
+	bool SubmitToThread(std::function<void()>&& Task) override;
+
+private:
+	void Dispatch(std::function<void()>&& Task);
+	void OnTaskFinished();
+
+	mutable std::mutex Lock;
+	std::deque<std::function<void()>> Pending;
+
+	double Limit;
+	const double MinLimit;
+	const double MaxLimit;
+	const int32 MaxQueued;
+	int32 InFlight = 0;
+	uint64 ShedCount = 0;
+	bool bStopping = false;
+
+	// latency state in milliseconds
+	double MinLatencyMs = 0.0;
+	double SmoothedLatencyMs = 0.0;
+	uint32 SamplesSinceMinReset = 0;
+	std::chrono::steady_clock::time_point LastDecrease;
+
+	// declared last so it is destroyed first, its workers still finish through OnTaskFinished
+	std::shared_ptr<Aws::Utils::Threading::Executor> Inner;
+};
@@ -0,0 +1,76 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CloudWatchHttpClient.h"
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <aws/core/utils/memory/stl/AWSString.h>
+#include <aws/core/utils/memory/stl/AWSVector.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+/**
+* Keeps connections to the CloudWatch endpoints open in the shared curl connection cache.
+* Warm sends unsigned GET / requests to every endpoint so DNS, TCP and TLS are done before the first real request.
+* With a keep-alive interval the same pings are repeated in the background, so idle connections are exercised before
+* a NAT drops them and dead ones are closed by a ping instead of failing a PutLogEvents.
+**/
+class CLOUDWATCHSDK_API FCloudWatchConnectionWarmer
+{
+public:
+	/**
+	* public FCloudWatchConnectionWarmer::FCloudWatchConnectionWarmer
+	* @param InClient [const std::shared_ptr<FCloudWatchCurlHttpClient>&] Client on the same FCloudWatchCurlMulti as the service clients.
+	* @param InEndpoints [const Aws::Vector<Aws::String>&] Endpoint urls, e.g. "https://logs.us-east-1.amazonaws.com".
+	* @param InConnectionsPerEndpoint [int32] Pings sent at once per endpoint. Over HTTP/1.1 each one holds its own connection.
+	* @param InKeepAliveIntervalSeconds [int32] Seconds between background pings. 0 disables them.
+	**/
+	FCloudWatchConnectionWarmer(const std::shared_ptr<FCloudWatchCurlHttpClient>& InClient, const Aws::Vector<Aws::String>& InEndpoints, int32 InConnectionsPerEndpoint, int32 InKeepAliveIntervalSeconds);
+	~FCloudWatchConnectionWarmer();
+
+	/** Sends one round of pings and returns without waiting for them. Skipped while the previous round is in flight. */
+	void Warm();
+
+	uint64 GetPings() const { return Pings.load(std::memory_order_relaxed); }
+	uint64 GetFailedPings() const { return FailedPings.load(std::memory_order_relaxed); }
+
+private:
+	void KeepAliveLoop();
+
+	std::shared_ptr<FCloudWatchCurlHttpClient> Client;
+	Aws::Vector<Aws::String> Endpoints;
+	const int32 ConnectionsPerEndpoint;
+	const int32 KeepAliveIntervalSeconds;
+
+	std::mutex Lock;
+	std::condition_variable Signal;
+	bool bStop;
+	int32 PendingPings;
+	std::atomic<uint64> Pings;
+	std::atomic<uint64> FailedPings;
+	std::thread KeepAliveThread;
+};
@@ -0,0 +1,45 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+	#define CLOUDWATCH_X64 1
+#else
+	#define CLOUDWATCH_X64 0
+#endif
+
+#if CLOUDWATCH_X64
+	#if defined(_MSC_VER)
+		// MSVC emits any intrinsic without a target switch
+		#define CLOUDWATCH_TARGET(Isa)
+	#else
+		#define CLOUDWATCH_TARGET(Isa) __attribute__((target(Isa)))
+	#endif
+#endif
+
+/** Instruction set extensions the vectorized codecs and hashes dispatch on, read once per process. */
+struct CLOUDWATCHSDK_API FCloudWatchCpuFeatures
+{
+	bool bSse2 = false;
+	bool bSsse3 = false;
+	bool bSse41 = false;
+	/** Only set when the OS also saves the YMM registers. */
+	bool bAvx2 = false;
+	/** SHA-256 instructions, SHA-NI. */
+	bool bSha = false;
+
+	static const FCloudWatchCpuFeatures& Get();
+};
@@ -0,0 +1,163 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <aws/core/auth/AWSCredentials.h>
+#include <aws/core/auth/AWSCredentialsProvider.h>
+#include <aws/core/utils/memory/stl/AWSString.h>
+#include <aws/core/utils/memory/stl/AWSVector.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+/** Background refreshes of the credentials provider. */
+struct CLOUDWATCHSDK_API FCloudWatchCredentialsRefreshStats
+{
+	uint64 Refreshes = 0;
+	/** Refreshes that returned no credentials. The previous ones stay in use until they expire. */
+	uint64 FailedRefreshes = 0;
+	/** Seconds until the published credentials expire. -1 if they don't. */
+	int64 SecondsToExpiration = -1;
+};
+
+/**
+* Wraps a provider that refreshes lazily, like InstanceProfileCredentialsProvider, TaskRoleCredentialsProvider or
+* ProcessCredentialsProvider, and asks it for credentials from a background thread instead of the request threads.
+* The wrapped provider's blocking reload, an http call or a subprocess, therefore happens ahead of expiry on that
+* thread. Request threads read the last published credentials through an atomic pointer and never wait on it.
+**/
+class CLOUDWATCHSDK_API FCloudWatchRefreshingCredentialsProvider : public Aws::Auth::AWSCredentialsProvider
+{
+public:
+	/**
+	* public FCloudWatchRefreshingCredentialsProvider::FCloudWatchRefreshingCredentialsProvider
+	* Returns at once, the first credentials are fetched on the refresh thread.
+	* @param InProvider [const std::shared_ptr<AWSCredentialsProvider>&] Provider to refresh.
+	* @param RefreshIntervalSeconds [int32] Longest time between two refreshes. Credentials without an expiration are only refreshed at this rate.
+	* @param RefreshAheadSeconds [int32] How long before their expiration credentials are renewed.
+	**/
+	FCloudWatchRefreshingCredentialsProvider(const std::shared_ptr<Aws::Auth::AWSCredentialsProvider>& InProvider, int32 RefreshIntervalSeconds, int32 RefreshAheadSeconds);
+	~FCloudWatchRefreshingCredentialsProvider();
+
+	/** The last published credentials. Only blocks until the first fetch finished. */
+	Aws::Auth::AWSCredentials GetAWSCredentials() override;
+
+	FCloudWatchCredentialsRefreshStats GetStats() const;
+
+private:
+	// one published set of credentials, replaced as a whole
+	struct FSnapshot
+	{
+		Aws::Auth::AWSCredentials Credentials;
+	};
+
+	/** Fetches from the wrapped provider and publishes the result. Returns when to refresh next. */
+	std::chrono::steady_clock::time_point Refresh();
+	void Publish(const Aws::Auth::AWSCredentials& Credentials);
+	void RefreshLoop();
+
+	std::shared_ptr<Aws::Auth::AWSCredentialsProvider> Provider;
+	const std::chrono::seconds RefreshInterval;
+	const std::chrono::seconds RefreshAhead;
+
+	std::atomic<const FSnapshot*> Current;
+	// readers inside GetAWSCredentials; replaced snapshots are freed once the refresher sees none
+	mutable std::atomic<int32> Readers;
+	Aws::Vector<const FSnapshot*> Retired;
+
+	// set once the first fetch returned, successful or not
+	std::atomic<bool> bFirstRefreshDone;
+	std::mutex RefreshLock;
+	std::condition_variable RefreshSignal;
+	std::condition_variable FirstRefreshSignal;
+	bool bStop;
+	std::thread RefreshThread;
+
+	std::atomic<uint64> Refreshes;
+	std::atomic<uint64> FailedRefreshes;
+};
+
+/**
+* The providers of DefaultAWSCredentialsProviderChain, resolved once in the background instead of walked on every call.
+* The SDK's chain asks environment, profile file, credential process, ECS and instance metadata in turn on each
+* GetAWSCredentials, so on a host that isn't EC2 the first request waits for the metadata probe to time out. This
+* one walks the chain on its own thread as soon as it is created and then only asks the provider that answered.
+* Its credentials are kept in an atomically published snapshot that callers read without locking; the lock is only
+* taken to renew them, every 30 seconds or ahead of their expiration.
+**/
+class CLOUDWATCHSDK_API FCloudWatchCachedCredentialsChain : public Aws::Auth::AWSCredentialsProvider
+{
+public:
+	/**
+	* public FCloudWatchCachedCredentialsChain::FCloudWatchCachedCredentialsChain
+	* Starts resolving right away.
+	* @param RetryIntervalSeconds [int32] When no provider had credentials, how long before the chain is walked again.
+	**/
+	explicit FCloudWatchCachedCredentialsChain(int32 RetryIntervalSeconds = 60);
+	~FCloudWatchCachedCredentialsChain();
+
+	/** Credentials of the provider that won. Waits only if called while the first resolution still runs. */
+	Aws::Auth::AWSCredentials GetAWSCredentials() override;
+
+	/** Class name of the provider that won, e.g. "InstanceProfileCredentialsProvider". Empty until one did. */
+	Aws::String GetResolvedProviderName() const;
+
+private:
+	struct FCandidate
+	{
+		const char* Name;
+		std::shared_ptr<Aws::Auth::AWSCredentialsProvider> Provider;
+	};
+
+	// credentials served until RenewAt, replaced as a whole
+	struct FSnapshot
+	{
+		Aws::Auth::AWSCredentials Credentials;
+		std::chrono::steady_clock::time_point RenewAt;
+	};
+
+	void StartResolveLocked();
+	void Resolve();
+	void PublishLocked(const Aws::Auth::AWSCredentials& Credentials);
+
+	const std::chrono::seconds RetryInterval;
+
+	std::atomic<const FSnapshot*> Cached;
+	// readers of Cached outside the lock; replaced snapshots are freed once a renewal sees none
+	std::atomic<int32> Readers;
+	Aws::Vector<const FSnapshot*> Retired;
+	// set once the first walk finished, later ones aren't waited for
+	std::atomic<bool> bResolvedOnce;
+
+	mutable std::mutex Lock;
+	std::condition_variable Resolved;
+	bool bResolving;
+	std::chrono::steady_clock::time_point LastResolve;
+	FCandidate Winner;
+	std::thread ResolveThread;
+};
@@ -0,0 +1,71 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <aws/core/utils/crypto/Hash.h>
+#include <aws/core/utils/crypto/HMAC.h>
+
+#include <memory>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+/**
+* SHA-256 for the SDK, backed by FCloudWatchSha256. Holds no state between calls, so one instance serves every
+* thread and the SDK's per hash context allocation goes away.
+**/
+class CLOUDWATCHSDK_API FCloudWatchSha256Hash : public Aws::Utils::Crypto::Hash
+{
+public:
+	Aws::Utils::Crypto::HashResult Calculate(const Aws::String& Str) override;
+
+	/** Hashes the whole stream and puts the read position back where it was. */
+	Aws::Utils::Crypto::HashResult Calculate(Aws::IStream& Stream) override;
+};
+
+/** HMAC-SHA256 for the SDK, backed by FCloudWatchSha256. Stateless like FCloudWatchSha256Hash. */
+class CLOUDWATCHSDK_API FCloudWatchSha256HMAC : public Aws::Utils::Crypto::HMAC
+{
+public:
+	Aws::Utils::Crypto::HashResult Calculate(const Aws::Utils::ByteBuffer& ToSign, const Aws::Utils::ByteBuffer& Secret) override;
+};
+
+/** Installed through SDKOptions::cryptoOptions. Every call hands out the same FCloudWatchSha256Hash. */
+class CLOUDWATCHSDK_API FCloudWatchSha256Factory : public Aws::Utils::Crypto::HashFactory
+{
+public:
+	FCloudWatchSha256Factory();
+	std::shared_ptr<Aws::Utils::Crypto::Hash> CreateImplementation() const override { return Instance; }
+
+private:
+	std::shared_ptr<FCloudWatchSha256Hash> Instance;
+};
+
+/** Installed through SDKOptions::cryptoOptions. Every call hands out the same FCloudWatchSha256HMAC. */
+class CLOUDWATCHSDK_API FCloudWatchSha256HMACFactory : public Aws::Utils::Crypto::HMACFactory
+{
+public:
+	FCloudWatchSha256HMACFactory();
+	std::shared_ptr<Aws::Utils::Crypto::HMAC> CreateImplementation() const override { return Instance; }
+
+private:
+	std::shared_ptr<FCloudWatchSha256HMAC> Instance;
+};
@@ -0,0 +1,101 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+/** Occupancy and wait times of a curl handle pool. */
+struct CLOUDWATCHSDK_API FCloudWatchCurlPoolStats
+{
+	int32 Capacity = 0;
+	int32 InUse = 0;
+	int32 PeakInUse = 0;
+	uint64 Acquires = 0;
+	/** Acquires that found the pool empty and had to wait. */
+	uint64 Waits = 0;
+	/** Acquires that gave up after the timeout. */
+	uint64 Timeouts = 0;
+	double TotalWaitMs = 0.0;
+	double MaxWaitMs = 0.0;
+};
+
+/**
+* Fixed size pool of curl easy handles.
+* Free slots sit on a lock-free stack, so acquiring and releasing never takes a lock while handles are available.
+* Only an acquire that finds the pool empty waits, and never longer than the acquire timeout.
+* Handles are created on first use and reset, not destroyed, when released.
+**/
+class CLOUDWATCHSDK_API FCloudWatchCurlHandlePool
+{
+public:
+	/**
+	* public FCloudWatchCurlHandlePool::FCloudWatchCurlHandlePool
+	* @param Capacity [int32] Handles in the pool, i.e. requests of the client in flight at once.
+	* @param AcquireTimeoutMs [int32] How long Acquire waits for a handle when the pool is empty.
+	**/
+	FCloudWatchCurlHandlePool(int32 Capacity, int32 AcquireTimeoutMs);
+	~FCloudWatchCurlHandlePool();
+
+	/**
+	* public FCloudWatchCurlHandlePool::Acquire
+	* @param OutHandle [void*&] Receives the CURL* of the slot.
+	* @return [int32] Slot to release the handle with, INDEX_NONE when the timeout expired or the handle couldn't be created.
+	**/
+	int32 Acquire(void*& OutHandle);
+
+	/**
+	* public FCloudWatchCurlHandlePool::Release
+	* @param Slot [int32] Slot returned by Acquire.
+	* @param bDiscard [bool] Destroy the handle, e.g. after a failed transfer. The slot gets a fresh one on its next use.
+	**/
+	void Release(int32 Slot, bool bDiscard);
+
+	FCloudWatchCurlPoolStats GetStats() const;
+
+private:
+	struct FSlot
+	{
+		// CURL*
+		void* Handle = nullptr;
+		// 1-based index of the next free slot, 0 ends the list
+		std::atomic<uint32> Next;
+	};
+
+	int32 Pop();
+	void Push(int32 Index);
+
+	std::unique_ptr<FSlot[]> Slots;
+	const int32 Capacity;
+	const int32 AcquireTimeoutMs;
+
+	// ABA tag in the high 32 bits, 1-based index of the top slot in the low 32 bits
+	std::atomic<uint64> FreeHead;
+
+	std::mutex WaitLock;
+	std::condition_variable WaitSignal;
+	std::atomic<int32> Waiters;
+
+	std::atomic<int32> InUse;
+	std::atomic<int32> PeakInUse;
+	std::atomic<uint64> Acquires;
+	std::atomic<uint64> Waits;
+	std::atomic<uint64> Timeouts;
+	std::atomic<uint64> TotalWaitUs;
+	std::atomic<uint64> MaxWaitUs;
+};
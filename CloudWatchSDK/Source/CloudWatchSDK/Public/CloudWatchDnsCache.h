@@ -0,0 +1,126 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <aws/core/http/URI.h>
+#include <aws/core/utils/memory/stl/AWSMap.h>
+#include <aws/core/utils/memory/stl/AWSString.h>
+#include <aws/core/utils/memory/stl/AWSVector.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+/** Addresses of one host:port. Never changes once published, a refresh publishes a new record. */
+struct CLOUDWATCHSDK_API FCloudWatchDnsRecord
+{
+	FCloudWatchDnsRecord() = default;
+	FCloudWatchDnsRecord(const FCloudWatchDnsRecord&) = delete;
+	FCloudWatchDnsRecord& operator=(const FCloudWatchDnsRecord&) = delete;
+	~FCloudWatchDnsRecord();
+
+	Aws::String Host;
+	uint16 Port = 0;
+	Aws::Vector<Aws::String> Addresses;
+	// curl_slist* for CURLOPT_RESOLVE, one per rotation of Addresses since curl connects in list order
+	Aws::Vector<void*> ResolveLists;
+};
+
+/** Hit rate and refresh outcomes of a DNS cache. */
+struct CLOUDWATCHSDK_API FCloudWatchDnsCacheStats
+{
+	int32 Hosts = 0;
+	uint64 Hits = 0;
+	/** Lookups of hosts not resolved yet. libcurl resolves those itself. */
+	uint64 Misses = 0;
+	uint64 Resolves = 0;
+	/** Failed resolves. The previous addresses stay in use until a resolve succeeds. */
+	uint64 FailedResolves = 0;
+};
+
+/**
+* Process wide DNS cache for the curl clients.
+* Hosts are resolved on a background thread and refreshed before their TTL runs out, so a request never waits on
+* the system resolver once its host is known. Transfers hand the addresses to curl through CURLOPT_RESOLVE, rotated
+* on every lookup so new connections spread over every address of the endpoint.
+**/
+class CLOUDWATCHSDK_API FCloudWatchDnsCache
+{
+public:
+	/**
+	* public FCloudWatchDnsCache::FCloudWatchDnsCache
+	* @param TtlSeconds [int32] How long resolved addresses are used before they are refreshed.
+	**/
+	explicit FCloudWatchDnsCache(int32 TtlSeconds);
+	~FCloudWatchDnsCache();
+
+	/**
+	* public FCloudWatchDnsCache::Find
+	* Never blocks on the resolver. An unknown host is queued for the background thread and reported as a miss.
+	* @param Uri [const Aws::Http::URI&] Request url.
+	* @param OutResolveList [void*&] Receives the curl_slist* to set as CURLOPT_RESOLVE, nullptr on a miss.
+	* @return [std::shared_ptr<const FCloudWatchDnsRecord>] Keeps OutResolveList alive, hold it until the transfer is done.
+	**/
+	std::shared_ptr<const FCloudWatchDnsRecord> Find(const Aws::Http::URI& Uri, void*& OutResolveList);
+
+	/** Queues the host of Uri for resolving, e.g. the service endpoints right after SetupClient. */
+	void Prime(const Aws::Http::URI& Uri);
+
+	FCloudWatchDnsCacheStats GetStats() const;
+
+private:
+	struct FEntry
+	{
+		Aws::String Host;
+		uint16 Port = 0;
+		std::shared_ptr<const FCloudWatchDnsRecord> Record;
+		// zero until the first resolve finished
+		std::chrono::steady_clock::time_point RefreshAt;
+		std::chrono::steady_clock::time_point LastUsed;
+		bool bQueued = false;
+	};
+
+	static Aws::String MakeKey(const Aws::String& Host, uint16 Port);
+	void Queue(const Aws::String& Host, uint16 Port, FEntry& Entry);
+	void RefreshLoop();
+	static std::shared_ptr<const FCloudWatchDnsRecord> Resolve(const Aws::String& Host, uint16 Port);
+
+	const std::chrono::seconds Ttl;
+
+	mutable std::mutex Lock;
+	std::condition_variable Signal;
+	Aws::Map<Aws::String, FEntry> Entries;
+	Aws::Vector<std::pair<Aws::String, uint16>> Pending;
+	bool bStop;
+	std::thread RefreshThread;
+
+	std::atomic<uint32> Rotation;
+	std::atomic<uint64> Hits;
+	std::atomic<uint64> Misses;
+	std::atomic<uint64> Resolves;
+	std::atomic<uint64> FailedResolves;
+};
@@ -0,0 +1,84 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <aws/core/utils/memory/stl/AWSString.h>
+
+#include <cstddef>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+/**
+* Hex and Base64 codecs writing into caller buffers.
+* HashingUtils returns a fresh Aws::String per call and converts a byte at a time. These pick a vectorized
+* implementation once per process: AVX2 or SSE2 for hex, SSSE3 for Base64, which needs a byte shuffle. Other CPUs
+* use the scalar loops.
+**/
+class CLOUDWATCHSDK_API FCloudWatchEncoding
+{
+public:
+	/**
+	* public static FCloudWatchEncoding::HexEncode
+	* Lower case, no terminator.
+	* @param OutHex [char*] 2 * Length chars.
+	**/
+	static void HexEncode(const uint8* Data, size_t Length, char* OutHex);
+
+	/** Replaces the contents of Out and keeps its capacity. */
+	static void HexEncode(const uint8* Data, size_t Length, Aws::String& Out);
+
+	/**
+	* public static FCloudWatchEncoding::HexDecode
+	* Accepts either case.
+	* @param Length [size_t] Chars in Hex, must be even.
+	* @param OutData [uint8*] Length / 2 bytes.
+	* @return [bool] False on an odd length or a char that isn't a hex digit. OutData is undefined then.
+	**/
+	static bool HexDecode(const char* Hex, size_t Length, uint8* OutData);
+
+	static size_t Base64EncodedLength(size_t Length) { return (Length + 2) / 3 * 4; }
+
+	/**
+	* public static FCloudWatchEncoding::Base64Encode
+	* Standard alphabet with padding, no terminator.
+	* @param OutText [char*] Base64EncodedLength(Length) chars.
+	**/
+	static void Base64Encode(const uint8* Data, size_t Length, char* OutText);
+
+	/** Replaces the contents of Out and keeps its capacity. */
+	static void Base64Encode(const uint8* Data, size_t Length, Aws::String& Out);
+
+	/** Upper bound of the decoded size, exact unless the text is invalid. */
+	static size_t Base64DecodedLength(const char* Text, size_t Length);
+
+	/**
+	* public static FCloudWatchEncoding::Base64Decode
+	* Standard alphabet, padding required.
+	* @param OutData [uint8*] Base64DecodedLength(Text, Length) bytes.
+	* @param OutLength [size_t&] Bytes written.
+	* @return [bool] False if the text isn't valid Base64. OutData is undefined then.
+	**/
+	static bool Base64Decode(const char* Text, size_t Length, uint8* OutData, size_t& OutLength);
+
+	/** "avx2", "ssse3", "sse2" or "scalar", the widest implementation this CPU runs. */
+	static const char* GetImplementationName();
+};
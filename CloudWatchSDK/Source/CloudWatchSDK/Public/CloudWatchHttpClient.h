@@ -0,0 +1,292 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CloudWatchCurlHandlePool.h"
+#include "CloudWatchDnsCache.h"
+#include "CloudWatchBufferPool.h"
+#include "CloudWatchSigV4Signer.h"
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <aws/core/http/HttpClient.h>
+#include <aws/core/http/HttpClientFactory.h>
+#include <aws/core/http/HttpResponse.h>
+#include <aws/core/client/ClientConfiguration.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+struct FCloudWatchCurlTransfer;
+
+/** Curl client settings ClientConfiguration has no field for. */
+struct CLOUDWATCHSDK_API FCloudWatchCurlOptions
+{
+	/** Negotiate HTTP/2 and multiplex requests over shared connections. */
+	bool bEnableHttp2 = true;
+	/** Concurrent HTTP/2 streams per connection. */
+	int32 MaxStreamsPerConnection = 100;
+	/** How long a request waits for a free curl handle before failing with a retryable error. */
+	int32 HandleAcquireTimeoutMs = 1000;
+	/** Connections idle for longer are closed instead of reused. 0 keeps libcurl's default. */
+	int32 MaxConnectionIdleSeconds = 50;
+	/** Seconds endpoint addresses are cached by FCloudWatchDnsCache before a background refresh. 0 leaves resolving to libcurl. */
+	int32 DnsCacheTtlSeconds = 0;
+};
+
+/** Called once per request with the completed response, on the I/O thread. */
+typedef std::function<void(const std::shared_ptr<Aws::Http::HttpResponse>&)> FCloudWatchHttpCallback;
+
+/**
+* One I/O thread driving the transfers of every FCloudWatchCurlHttpClient through a single curl multi handle.
+* Transfers are configured on the calling thread and handed over; the I/O thread only adds them, runs the sockets and
+* completes them. Bandwidth limiters pause a transfer instead of sleeping, so one slow request never stalls the others.
+* With multiplexing on, HTTP/2 transfers to the same host share connections up to MaxStreamsPerConnection each.
+* Every handle run by the loop also shares one TLS session and DNS cache, so new connections resume TLS sessions.
+**/
+class CLOUDWATCHSDK_API FCloudWatchCurlMulti
+{
+public:
+	/**
+	* public FCloudWatchCurlMulti::FCloudWatchCurlMulti
+	* @param MaxHostConnections [int32] Connections per host. Transfers above it wait for a free connection or stream. 0 means unlimited.
+	* @param bMultiplex [bool] Run HTTP/2 transfers as streams of a shared connection.
+	* @param MaxStreamsPerConnection [int32] HTTP/2 streams per connection, when libcurl supports the limit.
+	**/
+	FCloudWatchCurlMulti(int32 MaxHostConnections = 0, bool bMultiplex = false, int32 MaxStreamsPerConnection = 100);
+	~FCloudWatchCurlMulti();
+
+	/** True when the loaded libcurl can negotiate HTTP/2. */
+	static bool SupportsHttp2();
+
+	/**
+	* public FCloudWatchCurlMulti::Submit
+	* Takes ownership of a configured transfer. After Shutdown the transfer is failed right away on the calling thread.
+	* @param Transfer [FCloudWatchCurlTransfer*] Transfer created by FCloudWatchCurlHttpClient.
+	**/
+	void Submit(FCloudWatchCurlTransfer* Transfer);
+
+	/** Fails every pending transfer and stops the I/O thread. */
+	void Shutdown();
+
+	/** Transfers submitted and not completed yet. */
+	int32 GetActiveTransfers() const { return ActiveTransfers.load(std::memory_order_relaxed); }
+	/** Transfers completed so far. */
+	uint64 GetCompletedTransfers() const { return CompletedTransfers.load(std::memory_order_relaxed); }
+	/** Completed transfers that ran over HTTP/2. */
+	uint64 GetHttp2Transfers() const { return Http2Transfers.load(std::memory_order_relaxed); }
+
+	/** CURLSH* to set as CURLOPT_SHARE on every handle run by this loop. */
+	void* GetShareHandle() const { return ShareHandle; }
+
+private:
+	friend struct FCloudWatchCurlTransfer;
+
+	void IoLoop();
+	void AddIncoming();
+	void CompleteFinished();
+	void UpdateThrottled(long& InOutWaitMs);
+	void WaitForActivity(long WaitMs);
+	void RemoveRunning(FCloudWatchCurlTransfer* Transfer);
+
+	// CURLM*, kept opaque so curl headers stay out of the public include path
+	void* MultiHandle;
+	// CURLSH*, with one lock per curl_lock_data
+	void* ShareHandle;
+	std::unique_ptr<std::mutex[]> ShareLocks;
+
+	std::mutex Lock;
+	std::condition_variable Signal;
+	std::vector<FCloudWatchCurlTransfer*> Incoming;
+	bool bStop;
+	std::atomic<int32> ActiveTransfers;
+	std::atomic<uint64> CompletedTransfers;
+	std::atomic<uint64> Http2Transfers;
+	std::thread IoThread;
+
+	// only touched on the I/O thread
+	std::vector<FCloudWatchCurlTransfer*> Running;
+	std::vector<FCloudWatchCurlTransfer*> Throttled;
+};
+
+/**
+* Http client on top of FCloudWatchCurlMulti. Selected with ClientConfiguration::httpLibOverride = CURL_CLIENT
+* once FCloudWatchHttpClientFactory is installed.
+* The SDK calls MakeRequest synchronously from its executor; the calling thread only waits for the I/O thread to
+* complete the request, it never touches the socket. Every SDK call in flight therefore still holds one executor
+* thread, which SetupClient bounds with the concurrency limiter or a fixed pool. Only MakeRequestAsync callers, like
+* FCloudWatchConnectionWarmer, run without a thread of their own.
+**/
+class CLOUDWATCHSDK_API FCloudWatchCurlHttpClient : public Aws::Http::HttpClient
+{
+public:
+	/**
+	* public FCloudWatchCurlHttpClient::FCloudWatchCurlHttpClient
+	* @param ClientConfig [const ClientConfiguration&] Timeouts, TLS and proxy settings.
+	* @param InMulti [const std::shared_ptr<FCloudWatchCurlMulti>&] I/O loop running the transfers.
+	* @param Options [const FCloudWatchCurlOptions&] HTTP/2 and handle pool settings. HTTP/2 is offered through ALPN, servers that don't pick it get HTTP/1.1.
+	* @param InDnsCache [const std::shared_ptr<FCloudWatchDnsCache>&] Optional cache resolving hosts off the request path. Not used behind a proxy.
+	**/
+	FCloudWatchCurlHttpClient(const Aws::Client::ClientConfiguration& ClientConfig, const std::shared_ptr<FCloudWatchCurlMulti>& InMulti, const FCloudWatchCurlOptions& Options,
+		const std::shared_ptr<FCloudWatchDnsCache>& InDnsCache = nullptr);
+
+	std::shared_ptr<Aws::Http::HttpResponse> MakeRequest(Aws::Http::HttpRequest& Request, Aws::Utils::RateLimits::RateLimiterInterface* ReadLimiter = nullptr,
+		Aws::Utils::RateLimits::RateLimiterInterface* WriteLimiter = nullptr) const override;
+
+	std::shared_ptr<Aws::Http::HttpResponse> MakeRequest(const std::shared_ptr<Aws::Http::HttpRequest>& Request, Aws::Utils::RateLimits::RateLimiterInterface* ReadLimiter = nullptr,
+		Aws::Utils::RateLimits::RateLimiterInterface* WriteLimiter = nullptr) const override;
+
+	/**
+	* public FCloudWatchCurlHttpClient::MakeRequestAsync
+	* Starts the request and returns immediately. The client must outlive the request.
+	* @param Request [const std::shared_ptr<HttpRequest>&] Signed request.
+	* @param Callback [FCloudWatchHttpCallback&&] Receives the response on the I/O thread. Keep it short.
+	* @param ReadLimiter [RateLimiterInterface*] Optional limiter for response bytes.
+	* @param WriteLimiter [RateLimiterInterface*] Optional limiter for request bytes.
+	**/
+	void MakeRequestAsync(const std::shared_ptr<Aws::Http::HttpRequest>& Request, FCloudWatchHttpCallback&& Callback,
+		Aws::Utils::RateLimits::RateLimiterInterface* ReadLimiter = nullptr, Aws::Utils::RateLimits::RateLimiterInterface* WriteLimiter = nullptr) const;
+
+	FCloudWatchCurlPoolStats GetHandlePoolStats() const { return HandlePool.GetStats(); }
+
+	/**
+	* public FCloudWatchCurlHttpClient::SetOuterClient
+	* The SDK's request processing calls aren't virtual, a wrapper can't pass them on. Transfers stop when either
+	* this client or Outer has request processing disabled.
+	* @param Outer [const Aws::Http::HttpClient*] Client wrapping this one and owning it, nullptr to clear.
+	**/
+	void SetOuterClient(const Aws::Http::HttpClient* Outer) { OuterClient = Outer; }
+
+private:
+	friend struct FCloudWatchCurlTransfer;
+
+	bool IsProcessingEnabled() const
+	{
+		const Aws::Http::HttpClient* Outer = OuterClient;
+		return IsRequestProcessingEnabled() && (!Outer || Outer->IsRequestProcessingEnabled());
+	}
+
+	FCloudWatchCurlTransfer* CreateTransfer(const std::shared_ptr<Aws::Http::HttpRequest>& Request, FCloudWatchHttpCallback&& Callback,
+		Aws::Utils::RateLimits::RateLimiterInterface* ReadLimiter, Aws::Utils::RateLimits::RateLimiterInterface* WriteLimiter) const;
+
+	std::shared_ptr<FCloudWatchCurlMulti> Multi;
+	std::shared_ptr<FCloudWatchDnsCache> DnsCache;
+	std::atomic<const Aws::Http::HttpClient*> OuterClient;
+	bool bUseHttp2;
+	// one handle per request in flight, the connections themselves live in the multi handle
+	mutable FCloudWatchCurlHandlePool HandlePool;
+
+	long ConnectTimeoutMs;
+	long RequestTimeoutMs;
+	long HttpRequestTimeoutMs;
+	unsigned long LowSpeedLimit;
+	bool bEnableTcpKeepAlive;
+	unsigned long TcpKeepAliveIntervalMs;
+	bool bVerifySSL;
+	Aws::String CaPath;
+	Aws::String CaFile;
+	bool bDisableExpectHeader;
+	bool bFollowRedirects;
+	long MaxConnectionIdleSeconds;
+
+	bool bUseProxy;
+	Aws::String ProxyScheme;
+	Aws::String ProxyHost;
+	unsigned ProxyPort;
+	Aws::String ProxyUserName;
+	Aws::String ProxyPassword;
+	Aws::String ProxySSLCertPath;
+	Aws::String ProxySSLCertType;
+	Aws::String ProxySSLKeyPath;
+	Aws::String ProxySSLKeyType;
+	Aws::String ProxyKeyPassword;
+};
+
+/**
+* Http client factory installed by FCloudWatchSDKModule. CURL_CLIENT gets FCloudWatchCurlHttpClient, everything else
+* gets what the SDK would have created, so installing the factory alone changes nothing.
+**/
+class CLOUDWATCHSDK_API FCloudWatchHttpClientFactory : public Aws::Http::HttpClientFactory
+{
+public:
+	std::shared_ptr<Aws::Http::HttpClient> CreateHttpClient(const Aws::Client::ClientConfiguration& ClientConfig) const override;
+	std::shared_ptr<Aws::Http::HttpRequest> CreateHttpRequest(const Aws::String& Uri, Aws::Http::HttpMethod Method, const Aws::IOStreamFactory& StreamFactory) const override;
+	std::shared_ptr<Aws::Http::HttpRequest> CreateHttpRequest(const Aws::Http::URI& Uri, Aws::Http::HttpMethod Method, const Aws::IOStreamFactory& StreamFactory) const override;
+
+	void InitStaticState() override;
+	void CleanupStaticState() override;
+
+	/**
+	* public FCloudWatchHttpClientFactory::SetOptions
+	* Applies to curl clients created afterwards. Connection limits and the DNS cache TTL are fixed once the first curl client exists.
+	* @param InOptions [const FCloudWatchCurlOptions&] Settings of the next curl clients.
+	**/
+	void SetOptions(const FCloudWatchCurlOptions& InOptions);
+
+	/** Handle pool stats summed over the live curl clients. */
+	FCloudWatchCurlPoolStats GetHandlePoolStats() const;
+
+	/** DNS cache of the curl clients, null until a curl client is created with DnsCacheTtlSeconds set. */
+	std::shared_ptr<FCloudWatchDnsCache> GetDnsCache() const;
+
+	/**
+	* public FCloudWatchHttpClientFactory::SetSigner
+	* Http clients created afterwards inside an FSignedClientScope sign every request with it, see FCloudWatchSigningHttpClient.
+	* @param InSigner [const std::shared_ptr<FCloudWatchSigV4Signer>&] nullptr leaves signing to the SDK.
+	**/
+	void SetSigner(const std::shared_ptr<FCloudWatchSigV4Signer>& InSigner);
+
+	/**
+	* Marks the http clients created on the calling thread while it lives as the ones to sign. The factory serves every
+	* client of the process, including the EC2 and ECS metadata clients of credentials providers, which must stay unsigned.
+	**/
+	struct CLOUDWATCHSDK_API FSignedClientScope
+	{
+		FSignedClientScope();
+		~FSignedClientScope();
+	};
+
+	/** The signer set last, null if none. */
+	std::shared_ptr<FCloudWatchSigV4Signer> GetSigner() const;
+
+	/**
+	* public FCloudWatchHttpClientFactory::CreateCurlHttpClient
+	* Curl client on the shared I/O loop whatever httpLibOverride says, for plugin side traffic such as connection warming.
+	* It isn't counted in GetHandlePoolStats.
+	**/
+	std::shared_ptr<FCloudWatchCurlHttpClient> CreateCurlHttpClient(const Aws::Client::ClientConfiguration& ClientConfig) const;
+
+private:
+	std::shared_ptr<FCloudWatchCurlHttpClient> CreateCurlHttpClientLocked(const Aws::Client::ClientConfiguration& ClientConfig) const;
+
+	mutable std::mutex Lock;
+	FCloudWatchCurlOptions Options;
+	std::shared_ptr<FCloudWatchSigV4Signer> Signer;
+	mutable std::vector<std::weak_ptr<FCloudWatchCurlHttpClient>> Clients;
+	// shared by every curl client so both services run on the same I/O thread
+	mutable std::shared_ptr<FCloudWatchCurlMulti> Multi;
+	mutable std::shared_ptr<FCloudWatchDnsCache> DnsCache;
+};
@@ -0,0 +1,166 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <aws/core/utils/memory/stl/AWSString.h>
+#include <aws/core/utils/memory/stl/AWSMap.h>
+#include <aws/core/utils/memory/stl/AWSVector.h>
+#include <aws/core/utils/threading/Executor.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+/** Time spent waiting for an operation's rate limit, summed over its resources. */
+struct CLOUDWATCHSDK_API FCloudWatchOperationWaitStats
+{
+	uint64 Requests = 0;
+	uint64 DelayedRequests = 0;
+	double TotalWaitMs = 0.0;
+	double MaxWaitMs = 0.0;
+	/** Calls rejected because their slot was further away than the max wait, and attempts sent without a slot. */
+	uint64 OverLimitRequests = 0;
+};
+
+/**
+* Process-wide requests-per-second limiter keyed by service and API operation, e.g. ("CloudWatch Logs", "DescribeLogStreams"),
+* and for operations limited per resource also by that resource, like PutLogEvents per log group and stream.
+* The plugin's calls go through Submit. A call above the rate waits in a delay queue and is handed to its executor when
+* its slot comes, so the wait holds neither an executor thread nor a concurrency limiter slot, and calls leave in
+* arrival order. A call whose slot is further away than the max wait is rejected and its caller fails it as throttled.
+* Attempts the plugin didn't submit, retries among them, only go through TryAcquire from FCloudWatchRequestMonitor:
+* the monitoring callbacks can neither hold nor cancel a request, so those take a free slot or are sent without one.
+* Rates and buckets live in a sharded map, calls of different operations or streams rarely meet on a lock.
+**/
+class CLOUDWATCHSDK_API FCloudWatchOperationRateLimiter
+{
+public:
+	static FCloudWatchOperationRateLimiter& Get();
+	~FCloudWatchOperationRateLimiter();
+
+	/**
+	* public FCloudWatchOperationRateLimiter::SetOperationRate
+	* @param ServiceName [const Aws::String&] Service client name, as returned by GetServiceClientName().
+	* @param OperationName [const Aws::String&] API operation name, e.g. "PutLogEvents".
+	* @param RequestsPerSecond [double] Allowed rate. 0 or less removes the limit.
+	* @param Burst [int32] Requests allowed back to back after an idle period.
+	* @param bPerResource [bool] Apply the rate to each resource passed to Submit instead of the whole operation.
+	**/
+	void SetOperationRate(const Aws::String& ServiceName, const Aws::String& OperationName, double RequestsPerSecond, int32 Burst = 1, bool bPerResource = false);
+
+	/**
+	* public FCloudWatchOperationRateLimiter::SetMaxWait
+	* @param MaxWaitMs [int32] Longest time a submitted call is queued. Calls that would wait longer are rejected.
+	**/
+	void SetMaxWait(int32 MaxWaitMs);
+
+	/**
+	* public FCloudWatchOperationRateLimiter::Submit
+	* Submits Call to Executor once the operation may be dispatched. Never blocks the caller.
+	* @param Resource [const Aws::String&] Resource of operations limited per resource, e.g. "group/stream" for PutLogEvents. Ignored by the others.
+	* @param Executor [const std::shared_ptr<Executor>&] Executor the call is submitted to, right away or when its slot comes.
+	* @param Call [std::function<void()>&&] Makes one SDK call. Its first attempt isn't checked again by the request monitor.
+	* @param OnRejected [std::function<void()>&&] Runs instead of Call if the wait would exceed the max wait or Executor sheds the call. Queued calls are rejected on the delay thread.
+	**/
+	void Submit(const Aws::String& ServiceName, const Aws::String& OperationName, const Aws::String& Resource, const std::shared_ptr<Aws::Utils::Threading::Executor>& Executor,
+		std::function<void()>&& Call, std::function<void()>&& OnRejected);
+
+	/**
+	* public FCloudWatchOperationRateLimiter::TryAcquire
+	* Takes a slot if one is free now. Never waits. Operations limited per resource aren't checked, their resource is unknown here.
+	* @return [bool] False if the operation is over its rate.
+	**/
+	bool TryAcquire(const Aws::String& ServiceName, const Aws::String& OperationName);
+
+	/**
+	* public static FCloudWatchOperationRateLimiter::TakeSubmittedSlot
+	* @return [bool] True once on a thread running a call handed over by Submit: its first attempt already has its slot.
+	**/
+	static bool TakeSubmittedSlot();
+
+	/**
+	* public FCloudWatchOperationRateLimiter::Shutdown
+	* Removes every rate, drops the queued calls and stops the delay thread. Called by FCloudWatchSDKModule::ShutdownModule.
+	**/
+	void Shutdown();
+
+	FCloudWatchOperationWaitStats GetWaitStats(const Aws::String& ServiceName, const Aws::String& OperationName) const;
+
+private:
+	struct FOperation
+	{
+		std::atomic<int64> IntervalNs;
+		std::atomic<int64> BurstNs;
+		const bool bPerResource;
+
+		std::atomic<uint64> Requests;
+		std::atomic<uint64> DelayedRequests;
+		std::atomic<uint64> OverLimitRequests;
+		std::atomic<int64> TotalWaitNs;
+		std::atomic<int64> MaxWaitNs;
+
+		explicit FOperation(bool bInPerResource);
+	};
+
+	struct FShard
+	{
+		std::mutex Lock;
+		Aws::Map<Aws::String, std::shared_ptr<FOperation>> Operations;
+		/** Time in ns each bucket is drained at, including the calls already scheduled. */
+		Aws::Map<Aws::String, int64> Buckets;
+	};
+
+	struct FDelayedCall
+	{
+		std::chrono::steady_clock::time_point Due;
+		std::shared_ptr<Aws::Utils::Threading::Executor> Executor;
+		std::function<void()> Call;
+		std::function<void()> OnRejected;
+	};
+
+	static const int32 ShardCount = 16;
+
+	FShard& GetShard(const Aws::String& Key) const;
+	std::shared_ptr<FOperation> FindOperation(const Aws::String& OperationKey) const;
+
+	/** Reserves the next slot of the bucket. @return [int64] Wait in ns, -1 if it would exceed MaxAllowedWaitNs and no slot was taken. */
+	int64 Reserve(FOperation& Operation, const Aws::String& BucketKey, int64 MaxAllowedWaitNs);
+
+	static void Dispatch(FDelayedCall&& Delayed);
+	void DelayLoop();
+
+	mutable FShard Shards[ShardCount];
+	std::atomic<int64> MaxWaitNs{2000000000};
+
+	std::mutex DelayLock;
+	std::condition_variable DelaySignal;
+	// min-heap on Due
+	Aws::Vector<FDelayedCall> Delayed;
+	bool bStopDelayThread = false;
+	std::thread DelayThread;
+};
@@ -0,0 +1,103 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <aws/core/auth/AWSCredentials.h>
+#include <aws/core/auth/AWSCredentialsProvider.h>
+#include <aws/core/utils/memory/stl/AWSString.h>
+#include <aws/core/utils/memory/stl/AWSVector.h>
+
+#include <atomic>
+#include <mutex>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+/** What a profile file looked like when it was parsed. A change of any field means it was rewritten. */
+struct FCloudWatchProfileFileIdentity
+{
+	bool bExists = false;
+	/** Inode, 0 on Windows where a rewrite shows in the write time. */
+	uint64 FileId = 0;
+	int64 ModifiedTime = 0;
+	uint64 Size = 0;
+
+	bool operator==(const FCloudWatchProfileFileIdentity& Other) const
+	{
+		return bExists == Other.bExists && FileId == Other.FileId && ModifiedTime == Other.ModifiedTime && Size == Other.Size;
+	}
+	bool operator!=(const FCloudWatchProfileFileIdentity& Other) const { return !(*this == Other); }
+};
+
+/**
+* Credentials of one profile from ~/.aws/credentials and ~/.aws/config, in place of ProfileConfigFileAWSCredentialsProvider.
+* The SDK's provider reads both files into a map of every profile each time its refresh interval runs out. This one
+* reads the files into a stack buffer, tokenizes them in place and keeps only the active profile's keys in an immutable
+* snapshot. The files are stat'ed at most once per check interval and reparsed only when one of them was rewritten.
+* Readers load the snapshot through an atomic pointer and never lock.
+**/
+class CLOUDWATCHSDK_API FCloudWatchProfileCredentialsProvider : public Aws::Auth::AWSCredentialsProvider
+{
+public:
+	/**
+	* public FCloudWatchProfileCredentialsProvider::FCloudWatchProfileCredentialsProvider
+	* Parses the files before returning.
+	* @param Profile [const char*] Profile to read. nullptr takes AWS_DEFAULT_PROFILE or AWS_PROFILE, then "default".
+	* @param CheckIntervalSeconds [int32] How often the files are checked for a rewrite. 0 checks on every call.
+	**/
+	explicit FCloudWatchProfileCredentialsProvider(const char* Profile = nullptr, int32 CheckIntervalSeconds = 5);
+	~FCloudWatchProfileCredentialsProvider();
+
+	/** The profile's credentials, empty if neither file has them. */
+	Aws::Auth::AWSCredentials GetAWSCredentials() override;
+
+	/** Times the files were parsed, the first time included. */
+	uint64 GetParseCount() const { return Parses.load(std::memory_order_relaxed); }
+
+private:
+	// one parse of both files, replaced as a whole
+	struct FSnapshot
+	{
+		Aws::Auth::AWSCredentials Credentials;
+		FCloudWatchProfileFileIdentity CredentialsFile;
+		FCloudWatchProfileFileIdentity ConfigFile;
+	};
+
+	/** Reparses when a file changed since the current snapshot. Skipped while another thread is at it. */
+	void CheckFiles(bool bForce);
+	void Publish(FSnapshot* Next);
+
+	Aws::String ProfileName;
+	Aws::String CredentialsPath;
+	Aws::String ConfigPath;
+	const int64 CheckIntervalMillis;
+
+	std::atomic<const FSnapshot*> Current;
+	// readers inside GetAWSCredentials; replaced snapshots are freed once a publisher sees none
+	mutable std::atomic<int32> Readers;
+	std::atomic<int64> NextCheckMillis;
+
+	// held by the one thread checking the files, guards Retired
+	std::mutex CheckLock;
+	Aws::Vector<const FSnapshot*> Retired;
+
+	std::atomic<uint64> Parses;
+};
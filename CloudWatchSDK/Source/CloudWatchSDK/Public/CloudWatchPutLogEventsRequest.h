@@ -0,0 +1,52 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CloudWatchBufferPool.h"
+#include "CloudWatchSha256.h"
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <aws/logs/model/PutLogEventsRequest.h>
+
+#include <memory>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+/**
+* PutLogEventsRequest whose body is written once, straight into a buffer from FCloudWatchBufferPool.
+* The SDK's request builds a cJSON tree, prints it into an Aws::String and copies that into an Aws::StringStream;
+* here the http client reads the JSON from the pooled buffer directly. Retries reuse the same payload, and the
+* buffer goes back to the pool with the last copy of the request. The payload's SHA-256 is computed while it is
+* written, event by event while the bytes are still in cache, and handed to the signer with the body stream.
+* Send it with the synchronous PutLogEvents: the Async and Callable variants copy it as a plain PutLogEventsRequest.
+**/
+class CLOUDWATCHSDK_API FCloudWatchPutLogEventsRequest : public Aws::CloudWatchLogs::Model::PutLogEventsRequest
+{
+public:
+	/** Serializes on the first call. Don't modify the request afterwards. */
+	std::shared_ptr<Aws::IOStream> GetBody() const override;
+
+private:
+	size_t EstimatePayloadSize() const;
+	void WritePayload(Aws::String& Out, FCloudWatchSha256& PayloadSha) const;
+
+	mutable std::shared_ptr<Aws::String> Payload;
+	mutable char PayloadHash[2 * FCloudWatchSha256::DigestSize];
+};
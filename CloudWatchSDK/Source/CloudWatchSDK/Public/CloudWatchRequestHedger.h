@@ -0,0 +1,240 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <aws/core/http/HttpRequest.h>
+#include <aws/core/utils/memory/stl/AWSMap.h>
+#include <aws/core/utils/memory/stl/AWSString.h>
+#include <aws/core/utils/memory/stl/AWSVector.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+/** How often requests were hedged and how often the hedge won. */
+struct CLOUDWATCHSDK_API FCloudWatchHedgeStats
+{
+	uint64 Requests = 0;
+	uint64 Hedges = 0;
+	/** Hedges that completed before the first attempt. */
+	uint64 HedgeWins = 0;
+	/** Hedges skipped because the extra load budget was spent or the client was being throttled. */
+	uint64 HedgesDenied = 0;
+};
+
+/**
+* ContinueRequestHandler of a hedged attempt. Returns false once another attempt of the same call won, which makes
+* the http client abort the loser. FCloudWatchCurlHttpClient also sends hedges on a fresh connection, so a stalled
+* connection can't hold both attempts.
+**/
+struct CLOUDWATCHSDK_API FCloudWatchHedgeContinue
+{
+	std::shared_ptr<std::atomic<bool>> bCancelled;
+	bool bFreshConnection = false;
+
+	bool operator()(const Aws::Http::HttpRequest*) const { return !bCancelled->load(std::memory_order_relaxed); }
+};
+
+/**
+* Latency windows, hedge budget and stats of an FCloudWatchRequestHedger. Shared with the hedged calls in flight,
+* which can complete after the hedger that started them was destroyed by another SetupClient or ShutdownModule.
+**/
+class CLOUDWATCHSDK_API FCloudWatchHedgeState
+{
+public:
+	FCloudWatchHedgeState(float MaxHedgeRatio, int32 MinDelayMs);
+
+	void AddBudget();
+	std::chrono::milliseconds GetHedgeDelay(const Aws::String& OperationName);
+	void RecordLatency(const Aws::String& OperationName, double LatencyMs);
+	bool TryAcquireHedge(const Aws::String& ServiceName);
+
+	std::atomic<uint64> Requests;
+	std::atomic<uint64> Hedges;
+	std::atomic<uint64> HedgeWins;
+	std::atomic<uint64> HedgesDenied;
+
+private:
+	struct FLatencyWindow
+	{
+		Aws::Vector<double> Samples;
+		size_t Next = 0;
+		uint32 SinceUpdate = 0;
+		double P95Ms = 0.0;
+	};
+
+	const double MaxHedgeRatio;
+	const std::chrono::milliseconds MinDelay;
+
+	std::mutex LatencyLock;
+	Aws::Map<Aws::String, FLatencyWindow> Latencies;
+
+	std::mutex BudgetLock;
+	double Budget;
+};
+
+/**
+* Sends a second attempt of a slow idempotent call and completes with whichever attempt finishes first.
+* The hedge is sent once the first attempt has run longer than the operation's recent p95 latency, so it only
+* fires for the slowest few percent of calls. Hedges are paid for from a budget refilled by every call, which caps
+* the extra load at MaxHedgeRatio of the traffic, and are skipped while the service throttles the client.
+**/
+class CLOUDWATCHSDK_API FCloudWatchRequestHedger
+{
+public:
+	/**
+	* public FCloudWatchRequestHedger::FCloudWatchRequestHedger
+	* @param MaxHedgeRatio [float] Hedges allowed per call on average, e.g. 0.05 for at most 5% extra requests.
+	* @param MinDelayMs [int32] Smallest hedge delay. Also used until an operation has enough latency samples.
+	**/
+	FCloudWatchRequestHedger(float MaxHedgeRatio, int32 MinDelayMs);
+	~FCloudWatchRequestHedger();
+
+	/**
+	* public FCloudWatchRequestHedger::Send
+	* Only pass operations that are safe to run twice. Done may run after the hedger was destroyed; a hedge that wasn't sent by then is dropped.
+	* @param ServiceName [const Aws::String&] Service client name, used to skip hedging while the client is throttled.
+	* @param OperationName [const Aws::String&] Latency statistics are kept per operation.
+	* @param Request [const RequestType&] Copied for every attempt.
+	* @param Start [std::function] Queues one attempt, e.g. a sync client call on the client's executor, which then calls the given function with its outcome. Returns false if the attempt couldn't be queued.
+	* @param Done [std::function] Called once, with the first successful outcome or with the last failure.
+	* @return [bool] False if the first attempt couldn't be queued. Done isn't called then.
+	**/
+	template <typename RequestType, typename OutcomeType>
+	bool Send(const Aws::String& ServiceName, const Aws::String& OperationName, const RequestType& Request,
+		const std::function<bool(const RequestType&, const std::function<void(const OutcomeType&)>&)>& Start,
+		const std::function<void(const OutcomeType&)>& Done);
+
+	FCloudWatchHedgeStats GetStats() const;
+
+private:
+	template <typename OutcomeType>
+	struct THedgedCall
+	{
+		std::mutex Lock;
+		std::function<void(const OutcomeType&)> Done;
+		std::shared_ptr<std::atomic<bool>> bCancelled;
+		std::chrono::steady_clock::time_point StartedAt;
+		// held while the other attempt may still succeed
+		std::shared_ptr<OutcomeType> Failure;
+		int32 InFlight = 0;
+		bool bDone = false;
+	};
+
+	void Schedule(std::chrono::milliseconds Delay, std::function<void()>&& Task);
+	void TimerLoop();
+
+	// captured by the attempt callbacks and timers instead of this
+	std::shared_ptr<FCloudWatchHedgeState> State;
+
+	std::mutex TimerLock;
+	std::condition_variable TimerSignal;
+	Aws::MultiMap<std::chrono::steady_clock::time_point, std::function<void()>> Timers;
+	bool bStop;
+	std::thread TimerThread;
+};
+
+template <typename RequestType, typename OutcomeType>
+bool FCloudWatchRequestHedger::Send(const Aws::String& ServiceName, const Aws::String& OperationName, const RequestType& Request,
+	const std::function<bool(const RequestType&, const std::function<void(const OutcomeType&)>&)>& Start,
+	const std::function<void(const OutcomeType&)>& Done)
+{
+	const std::shared_ptr<FCloudWatchHedgeState> SharedState = State;
+	SharedState->Requests.fetch_add(1, std::memory_order_relaxed);
+	SharedState->AddBudget();
+
+	auto Call = std::make_shared<THedgedCall<OutcomeType>>();
+	Call->Done = Done;
+	Call->bCancelled = std::make_shared<std::atomic<bool>>(false);
+	Call->StartedAt = std::chrono::steady_clock::now();
+	Call->InFlight = 1;
+
+	auto Launch = [SharedState, Call, Request, Start, OperationName](bool bHedge)
+	{
+		RequestType Attempt = Request;
+		FCloudWatchHedgeContinue Continue;
+		Continue.bCancelled = Call->bCancelled;
+		Continue.bFreshConnection = bHedge;
+		Attempt.SetContinueRequestHandler(Continue);
+
+		const auto AttemptStartedAt = std::chrono::steady_clock::now();
+		return Start(Attempt, [SharedState, Call, bHedge, AttemptStartedAt, OperationName](const OutcomeType& Outcome)
+		{
+			std::unique_lock<std::mutex> Guard(Call->Lock);
+			--Call->InFlight;
+			if (Call->bDone) return;
+
+			// a failure is only final once the other attempt can't succeed anymore. A hedge that wasn't sent yet
+			// doesn't count, the SDK already retried what was retryable
+			if (!Outcome.IsSuccess() && Call->InFlight > 0)
+			{
+				Call->Failure = std::make_shared<OutcomeType>(Outcome);
+				return;
+			}
+
+			Call->bDone = true;
+			Call->bCancelled->store(true, std::memory_order_relaxed);
+			Guard.unlock();
+
+			if (Outcome.IsSuccess())
+			{
+				const auto Now = std::chrono::steady_clock::now();
+				SharedState->RecordLatency(OperationName, std::chrono::duration<double, std::milli>(Now - AttemptStartedAt).count());
+				if (bHedge)
+				{
+					SharedState->HedgeWins.fetch_add(1, std::memory_order_relaxed);
+					// the first attempt took at least this long, recorded so a slow endpoint raises the delay
+					SharedState->RecordLatency(OperationName, std::chrono::duration<double, std::milli>(Now - Call->StartedAt).count());
+				}
+			}
+			Call->Done(Outcome);
+		});
+	};
+
+	if (!Launch(false)) return false;
+
+	Schedule(SharedState->GetHedgeDelay(OperationName), [SharedState, Call, Launch, ServiceName]()
+	{
+		{
+			std::lock_guard<std::mutex> Guard(Call->Lock);
+			if (Call->bDone || !SharedState->TryAcquireHedge(ServiceName)) return;
+			++Call->InFlight;
+		}
+		SharedState->Hedges.fetch_add(1, std::memory_order_relaxed);
+		if (Launch(true)) return;
+
+		// the hedge was shed, a failure of the first attempt held for it is final now
+		std::unique_lock<std::mutex> Guard(Call->Lock);
+		--Call->InFlight;
+		if (Call->bDone || Call->InFlight > 0 || !Call->Failure) return;
+		Call->bDone = true;
+		Guard.unlock();
+		Call->Done(*Call->Failure);
+	});
+	return true;
+}
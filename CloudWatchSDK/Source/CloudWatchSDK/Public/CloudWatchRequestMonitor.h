@@ -0,0 +1,58 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <aws/core/monitoring/MonitoringInterface.h>
+#include <aws/core/monitoring/MonitoringFactory.h>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+/**
+* Monitoring listener installed by FCloudWatchSDKModule at Aws::InitAPI.
+* It is called on the worker thread right before a request is signed and sent. It charges the attempts the plugin
+* didn't submit through FCloudWatchOperationRateLimiter, retries among them, to their operation's rate without
+* holding them back. It also times every http attempt for the client's FCloudWatchConcurrencyLimiter.
+**/
+class CLOUDWATCHSDK_API FCloudWatchRequestMonitor : public Aws::Monitoring::MonitoringInterface
+{
+public:
+	void* OnRequestStarted(const Aws::String& ServiceName, const Aws::String& RequestName,
+		const std::shared_ptr<const Aws::Http::HttpRequest>& Request) const override;
+
+	void OnRequestSucceeded(const Aws::String& ServiceName, const Aws::String& RequestName, const std::shared_ptr<const Aws::Http::HttpRequest>& Request,
+		const Aws::Client::HttpResponseOutcome& Outcome, const Aws::Monitoring::CoreMetricsCollection& MetricsFromCore, void* Context) const override;
+
+	void OnRequestFailed(const Aws::String& ServiceName, const Aws::String& RequestName, const std::shared_ptr<const Aws::Http::HttpRequest>& Request,
+		const Aws::Client::HttpResponseOutcome& Outcome, const Aws::Monitoring::CoreMetricsCollection& MetricsFromCore, void* Context) const override;
+
+	void OnRequestRetry(const Aws::String& ServiceName, const Aws::String& RequestName,
+		const std::shared_ptr<const Aws::Http::HttpRequest>& Request, void* Context) const override;
+
+	void OnFinish(const Aws::String& ServiceName, const Aws::String& RequestName,
+		const std::shared_ptr<const Aws::Http::HttpRequest>& Request, void* Context) const override;
+};
+
+class CLOUDWATCHSDK_API FCloudWatchRequestMonitorFactory : public Aws::Monitoring::MonitoringFactory
+{
+public:
+	Aws::UniquePtr<Aws::Monitoring::MonitoringInterface> CreateMonitoringInstance() const override;
+};
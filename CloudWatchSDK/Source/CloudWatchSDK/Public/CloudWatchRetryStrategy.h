@@ -0,0 +1,119 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CloudWatchTokenBucketRateLimiter.h"
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <aws/core/client/RetryStrategy.h>
+#include <aws/core/utils/memory/stl/AWSString.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+/** Retry budget and client side rate state of one client. */
+struct CLOUDWATCHSDK_API FCloudWatchRetryStats
+{
+	uint64 Retries = 0;
+	/** Retryable errors not retried because the budget was empty. */
+	uint64 RetriesDenied = 0;
+	uint64 Throttles = 0;
+	int32 AvailableTokens = 0;
+	/** Attempts delayed by the client side rate. */
+	uint64 DelayedAttempts = 0;
+	/** Attempts per second allowed after throttling. 0 while the client isn't rate limited. */
+	double SendRate = 0.0;
+};
+
+/**
+* Retry strategy shared by every request of one client.
+* Each retry spends tokens from a bucket that successful requests refill, so a regional outage drains it and the
+* client falls back to single attempts instead of multiplying its load. Delays use decorrelated jitter so servers
+* that failed together don't retry together. A throttling response also turns on a client side send rate, cut
+* multiplicatively on every throttle and raised additively while requests succeed; FCloudWatchRequestMonitor
+* applies it before each attempt.
+**/
+class CLOUDWATCHSDK_API FCloudWatchRetryStrategy : public Aws::Client::RetryStrategy
+{
+public:
+	/**
+	* public FCloudWatchRetryStrategy::FCloudWatchRetryStrategy
+	* @param MaxRetries [int32] Retries per request, budget permitting.
+	* @param BudgetTokens [int32] Size of the retry budget. A retry costs 5 tokens, 10 after a timeout, a success refunds 1.
+	* @param BaseDelayMs [int32] Smallest delay before a retry. Throttling errors start from ten times this.
+	* @param MaxDelayMs [int32] Largest delay before a retry.
+	**/
+	FCloudWatchRetryStrategy(int32 MaxRetries, int32 BudgetTokens, int32 BaseDelayMs, int32 MaxDelayMs);
+
+	bool ShouldRetry(const Aws::Client::AWSError<Aws::Client::CoreErrors>& Error, long AttemptedRetries) const override;
+	long CalculateDelayBeforeNextRetry(const Aws::Client::AWSError<Aws::Client::CoreErrors>& Error, long AttemptedRetries) const override;
+
+	/** Called before every attempt. Blocks the worker thread while the client is over its throttled send rate. */
+	void OnAttemptStarting();
+
+	/** Called for every successful attempt. Refills the budget and raises the send rate. */
+	void OnAttemptSucceeded();
+
+	/** True while a throttle has the client on a reduced send rate. */
+	bool IsRateLimited() const { return bRateLimited.load(std::memory_order_relaxed); }
+
+	FCloudWatchRetryStats GetStats() const;
+
+	/**
+	* public static FCloudWatchRetryStrategy::Register
+	* Makes the strategy reachable from the monitoring callbacks, which only know the service name.
+	* @param ServiceName [const Aws::String&] Service client name, as returned by GetServiceClientName().
+	* @param Strategy [const std::shared_ptr<FCloudWatchRetryStrategy>&] Strategy of that client. nullptr unregisters.
+	**/
+	static void Register(const Aws::String& ServiceName, const std::shared_ptr<FCloudWatchRetryStrategy>& Strategy);
+	static std::shared_ptr<FCloudWatchRetryStrategy> Find(const Aws::String& ServiceName);
+
+private:
+	bool TrySpendTokens(int32 Cost) const;
+	void OnThrottled() const;
+	void UpdateMeasuredRate();
+
+	const int32 MaxRetries;
+	const int32 BudgetTokens;
+	const int32 BaseDelayMs;
+	const int32 MaxDelayMs;
+
+	mutable std::atomic<int32> Tokens;
+	mutable std::atomic<uint64> Retries;
+	mutable std::atomic<uint64> RetriesDenied;
+	mutable std::atomic<uint64> Throttles;
+	std::atomic<uint64> DelayedAttempts;
+
+	// client side rate, only applied after a throttle
+	mutable std::mutex RateLock;
+	mutable FCloudWatchTokenBucketRateLimiter SendLimiter;
+	mutable std::atomic<bool> bRateLimited;
+	mutable double SendRate;
+	mutable std::chrono::steady_clock::time_point LastThrottle;
+	mutable std::chrono::steady_clock::time_point LastIncrease;
+	// attempts per second, smoothed over half second windows. Counted without RateLock, every attempt updates it
+	mutable std::atomic<double> MeasuredRate;
+	std::atomic<int64> WindowStartNs;
+	std::atomic<uint32> WindowAttempts;
+};
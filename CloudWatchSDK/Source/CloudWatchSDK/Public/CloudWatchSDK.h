@@ -17,6 +17,25 @@
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
 #include "DelegateCombinations.h"
+#include "CloudWatchClientSettings.h"
+#include "CloudWatchConcurrencyLimiter.h"
+#include "CloudWatchTokenBucketRateLimiter.h"
+#include "CloudWatchOperationRateLimiter.h"
+#include "CloudWatchRetryStrategy.h"
+#include "CloudWatchSigningKeyCache.h"
+#include "CloudWatchClockSkew.h"
+#include "CloudWatchCredentialsProvider.h"
+#include "CloudWatchProfileConfig.h"
+#include "CloudWatchSha256.h"
+#include "CloudWatchCryptoFactory.h"
+#include "CloudWatchRequestHedger.h"
+#include "CloudWatchRequestMonitor.h"
+#include "CloudWatchAsyncLogSystem.h"
+#include "CloudWatchUELogSystem.h"
+#include "CloudWatchHttpClient.h"
+#include "CloudWatchConnectionWarmer.h"
+#include "CloudWatchBufferPool.h"
+#include "CloudWatchPutLogEventsRequest.h"
 
 #if PLATFORM_WINDOWS
 	#include "AllowWindowsPlatformTypes.h"
@@ -26,6 +45,7 @@
 
 #include <aws/monitoring/CloudWatchClient.h>
 #include <aws/monitoring/model/PutMetricDataRequest.h>
+#include <aws/monitoring/model/GetMetricDataRequest.h>
 
 #include <aws/logs/CloudWatchLogsClient.h>
 #include <aws/logs/model/InputLogEvent.h>
@@ -42,9 +62,15 @@
 class CLOUDWATCHSDK_API ULogsCustomEventObject
 {
 	friend class FCloudWatchSDKModule;
+	// checks the backlog of forwarded SDK log lines
+	friend class FCloudWatchUELogSystem;
 
 private:
 	Aws::CloudWatchLogs::CloudWatchLogsClient* LogsClient;
+	// shared with the module, so the proxy keeps working on the old limiter after another SetupClient
+	std::shared_ptr<FCloudWatchConcurrencyLimiter> Limiter;
+	// runs PutLogEvents, which can't go through PutLogEventsAsync (see FCloudWatchPutLogEventsRequest)
+	std::shared_ptr<Aws::Utils::Threading::Executor> Executor;
 	FString GroupName;
 	FString StreamName;
 	
@@ -57,6 +83,9 @@ private:
 
 	static ULogsCustomEventObject* CreateLogsCustomEvent(const FString& GroupName, const FString& StreamName);
 public:
+	/** Stops SDK log forwarding to this object, see FCloudWatchSDKModule::ForwardSdkLogs. */
+	~ULogsCustomEventObject();
+
 	void Call(const FString& Message, int stackLimit = 1);
 
 private:
@@ -75,6 +104,12 @@ private:
 	void OnCreateLogStream(const Aws::CloudWatchLogs::CloudWatchLogsClient* Client, const Aws::CloudWatchLogs::Model::CreateLogStreamRequest& Request, const Aws::CloudWatchLogs::Model::CreateLogStreamOutcome& Outcome, const std::shared_ptr<const Aws::Client::AsyncCallerContext>& Context);
 
 	void PutLogs();
+	/**
+	* Runs Call on Executor once the operation's rate allows it. A call shed by the concurrency limiter or over its rate
+	* ends the running chain, it may be rejected after returning from the delay queue.
+	* @param DroppedEvents [int32] Log events lost if the call is rejected, reported in the warning.
+	**/
+	void SubmitLogsCall(const char* OperationName, std::function<void()>&& Call, int32 DroppedEvents = 0);
 	void PutLogEvent(const Aws::CloudWatchLogs::CloudWatchLogsClient* Client, const Aws::CloudWatchLogs::Model::PutLogEventsRequest& Request, const Aws::CloudWatchLogs::Model::PutLogEventsOutcome& Outcome, const std::shared_ptr<const Aws::Client::AsyncCallerContext>& Context);
 };
 
@@ -88,6 +123,8 @@ public:
 	FOnCloudWatchCustomMetricsFailed OnCloudWatchCustomMetricsFailed;
 private:
 	Aws::CloudWatch::CloudWatchClient* CloudWatchClient;
+	std::shared_ptr<FCloudWatchConcurrencyLimiter> Limiter;
+	std::shared_ptr<Aws::Utils::Threading::Executor> Executor;
 	FString NameSpace;
 	FString GroupName;
 
@@ -98,6 +135,8 @@ private:
 public:
 	void Call(const FString& KeyName, const FString& ValueName, const float Value );
 private:
+	/** Ends a call refused by the concurrency limiter or the operation rate limit, reported through OnCloudWatchCustomMetricsFailed. */
+	void OnCustomMetricsShed();
 	void OnCustomMetricsCall(const Aws::CloudWatch::CloudWatchClient* Client, const Aws::CloudWatch::Model::PutMetricDataRequest& Request, const Aws::CloudWatch::Model::PutMetricDataOutcome& Outcome, const std::shared_ptr<const Aws::Client::AsyncCallerContext>& Context);
 };
 
@@ -115,6 +154,34 @@ public:
 	* @param Region [const FString&] Default is set to us-east-1 (North Virginia).
 	**/
 	void SetupClient(const FString& AccessKey, const FString& Secret, const FString& Region = "us-east-1");
+
+	/**
+	* public FCloudWatchSDKModule::SetupClient
+	* Creates a CloudWatch Client with User credentials and custom client settings.
+	* @param AccessKey [const FString&] AccessKey of your AWS user.
+	* @param Secret [const FString&] SecretKey of your AWS user.
+	* @param Region [const FString&] AWS Region of the endpoints.
+	* @param Settings [const FCloudWatchClientSettings&] Timeouts, connection and concurrency settings of both clients.
+	**/
+	void SetupClient(const FString& AccessKey, const FString& Secret, const FString& Region, const FCloudWatchClientSettings& Settings);
+
+	/**
+	* public FCloudWatchSDKModule::SetupClient
+	* Creates a CloudWatch Client with credentials from a provider, e.g. InstanceProfileCredentialsProvider on EC2.
+	* Unless CredentialsRefreshIntervalSeconds is 0 the provider is refreshed from a background thread, so requests
+	* never wait on its reload.
+	* @param CredentialsProvider [const std::shared_ptr<Aws::Auth::AWSCredentialsProvider>&] Source of the credentials.
+	* @param Region [const FString&] AWS Region of the endpoints.
+	* @param Settings [const FCloudWatchClientSettings&] Timeouts, connection and concurrency settings of both clients.
+	**/
+	void SetupClient(const std::shared_ptr<Aws::Auth::AWSCredentialsProvider>& CredentialsProvider, const FString& Region, const FCloudWatchClientSettings& Settings = FCloudWatchClientSettings());
+
+	/**
+	* public FCloudWatchSDKModule::GetDefaultCredentialsProvider
+	* The default credentials chain, resolved in the background since the module started. Pass it to SetupClient.
+	* @return [std::shared_ptr<Aws::Auth::AWSCredentialsProvider>] The chain. nullptr before StartupModule and after ShutdownModule.
+	**/
+	std::shared_ptr<Aws::Auth::AWSCredentialsProvider> GetDefaultCredentialsProvider() const;
 	
 	/**
 	* public FCloudWatchSDKModule::CreateCloudWatchCustomMetricsObject
@@ -131,9 +198,84 @@ public:
 	* @return [ULogsCustomEventObject*] Returns ULogsCustomEventObject*. Use this to Send Custom Logs.
 	**/
 	ULogsCustomEventObject* CreateLogsCustomEventObject(const FString& GroupName, const FString& StreamName);
+
+	/**
+	* public FCloudWatchSDKModule::ForwardSdkLogs
+	* Sends the SDK's own log lines to CloudWatch Logs as well. Requires SetupClient with SdkLogLevel set and no SdkLogFilePrefix.
+	* Call it on the game thread. Lines are dropped while the target has 10000 events waiting, e.g. when its stream is throttled.
+	* @param Target [ULogsCustomEventObject*] Stream receiving the lines. nullptr stops forwarding, so does deleting the target.
+	* @param MinLevel [LogLevel] Only lines at this level or more severe are forwarded.
+	**/
+	void ForwardSdkLogs(ULogsCustomEventObject* Target, Aws::Utils::Logging::LogLevel MinLevel = Aws::Utils::Logging::LogLevel::Warn);
+
+	/**
+	* public FCloudWatchSDKModule::GetCurlHandlePoolStats
+	* @return [FCloudWatchCurlPoolStats] Curl handle occupancy and wait times of both clients. Empty unless bUseCurlHttpClient is set.
+	**/
+	FCloudWatchCurlPoolStats GetCurlHandlePoolStats() const;
+
+	/**
+	* public FCloudWatchSDKModule::GetDnsCacheStats
+	* @return [FCloudWatchDnsCacheStats] Hit rate and refreshes of the endpoint DNS cache. Empty unless DnsCacheTtlSeconds is set.
+	**/
+	FCloudWatchDnsCacheStats GetDnsCacheStats() const;
+
+	/**
+	* public FCloudWatchSDKModule::GetSigningKeyCacheStats
+	* @return [FCloudWatchSigningKeyCacheStats] Shared lookups and derivations of the SigV4 signing key cache. Empty unless bUseCachedSigner is set.
+	**/
+	FCloudWatchSigningKeyCacheStats GetSigningKeyCacheStats() const;
+
+	/**
+	* public FCloudWatchSDKModule::GetClockSkewStats
+	* @return [FCloudWatchClockSkewStats] Clock skew estimated from responses and the offset signing applies. Empty unless bUseCachedSigner and bCorrectClockSkew are set.
+	**/
+	FCloudWatchClockSkewStats GetClockSkewStats() const;
+
+	/**
+	* public FCloudWatchSDKModule::GetCredentialsRefreshStats
+	* @return [FCloudWatchCredentialsRefreshStats] Background refreshes and time to expiration. Empty unless SetupClient was given a provider.
+	**/
+	FCloudWatchCredentialsRefreshStats GetCredentialsRefreshStats() const;
+
+	/**
+	* public FCloudWatchSDKModule::GetRetryStats
+	* @param bLogs [bool] Stats of the Logs client when true, of the CloudWatch client otherwise.
+	* @return [FCloudWatchRetryStats] Retries, denied retries and throttled send rate. Empty unless bEnableAdaptiveRetry is set.
+	**/
+	FCloudWatchRetryStats GetRetryStats(bool bLogs) const;
+
+	/**
+	* public FCloudWatchSDKModule::GetMetricDataAsync
+	* GetMetricData on the CloudWatch client, hedged when bEnableRequestHedging is set.
+	* @param Request [const GetMetricDataRequest&] Metric queries.
+	* @param Handler [const GetMetricDataResponseReceivedHandler&] Called with the outcome on a worker thread, or right away with a SERVICE_UNAVAILABLE error if the concurrency limiter sheds the call.
+	**/
+	void GetMetricDataAsync(const Aws::CloudWatch::Model::GetMetricDataRequest& Request, const Aws::CloudWatch::GetMetricDataResponseReceivedHandler& Handler);
+
+	/**
+	* public FCloudWatchSDKModule::GetHedgeStats
+	* @return [FCloudWatchHedgeStats] Hedged calls and how often the hedge won. Empty unless bEnableRequestHedging is set.
+	**/
+	FCloudWatchHedgeStats GetHedgeStats() const;
+private:
+	/** Body of both SetupClient overloads, signs with CredentialsProvider as given. */
+	void SetupClients(const std::shared_ptr<Aws::Auth::AWSCredentialsProvider>& CredentialsProvider, const FString& Region, const FCloudWatchClientSettings& Settings);
 private:
 	Aws::CloudWatch::CloudWatchClient* CloudWatchClient;
 	Aws::CloudWatchLogs::CloudWatchLogsClient* LogsClient;
+	std::shared_ptr<FCloudWatchConcurrencyLimiter> CloudWatchLimiter;
+	std::shared_ptr<FCloudWatchConcurrencyLimiter> LogsLimiter;
+	std::shared_ptr<Aws::Utils::Threading::Executor> LogsExecutor;
+	std::shared_ptr<Aws::Utils::Threading::Executor> CloudWatchExecutor;
+	std::shared_ptr<FCloudWatchRequestHedger> RequestHedger;
+	std::shared_ptr<FCloudWatchRefreshingCredentialsProvider> CredentialsRefresher;
+	std::shared_ptr<FCloudWatchCachedCredentialsChain> DefaultCredentials;
+	std::shared_ptr<FCloudWatchRetryStrategy> CloudWatchRetryStrategy;
+	std::shared_ptr<FCloudWatchRetryStrategy> LogsRetryStrategy;
+	std::shared_ptr<FCloudWatchUELogSystem> SdkLogSystem;
+	std::shared_ptr<FCloudWatchHttpClientFactory> HttpClientFactory;
+	std::shared_ptr<FCloudWatchConnectionWarmer> ConnectionWarmer;
 private:
 	Aws::SDKOptions options;
     /** Handle to the dll we will load */
@@ -0,0 +1,63 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include <cstddef>
+#include <cstring>
+
+/**
+* Incremental SHA-256 on the stack.
+* The SDK's hash only takes a whole string or stream, so the signer would have to build the canonical request
+* before hashing it. This one is fed piece by piece and never allocates. Blocks go through the SHA-NI instructions
+* on CPUs that have them.
+**/
+class CLOUDWATCHSDK_API FCloudWatchSha256
+{
+public:
+	static const size_t DigestSize = 32;
+	static const size_t BlockSize = 64;
+
+	FCloudWatchSha256() { Reset(); }
+
+	void Reset();
+	void Update(const void* Data, size_t Length);
+	void Update(const char* Text) { Update(Text, std::strlen(Text)); }
+
+	/**
+	* public FCloudWatchSha256::Final
+	* Finishes the digest. Reset before reusing the object.
+	* @param OutDigest [uint8*] DigestSize bytes.
+	**/
+	void Final(uint8* OutDigest);
+
+	/**
+	* public static FCloudWatchSha256::Hmac
+	* HMAC-SHA256 of Data under Key.
+	* @param OutDigest [uint8*] DigestSize bytes.
+	**/
+	static void Hmac(const uint8* Key, size_t KeyLength, const void* Data, size_t Length, uint8* OutDigest);
+
+	/** "sha-ni" or "scalar", the block transform this CPU runs. */
+	static const char* GetImplementationName();
+
+private:
+	void Transform(const uint8* Blocks, size_t Count);
+
+	uint32 State[8];
+	uint64 TotalLength;
+	uint8 Buffer[BlockSize];
+	size_t Buffered;
+};
@@ -0,0 +1,131 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CloudWatchSigningKeyCache.h"
+#include "CloudWatchClockSkew.h"
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <aws/core/auth/AWSAuthSigner.h>
+#include <aws/core/auth/AWSCredentialsProvider.h>
+#include <aws/core/http/HttpClient.h>
+#include <aws/core/http/HttpRequest.h>
+#include <aws/core/http/HttpResponse.h>
+#include <aws/core/utils/memory/stl/AWSString.h>
+#include <aws/core/utils/memory/stl/AWSVector.h>
+
+#include <atomic>
+#include <memory>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+/**
+* SigV4 signer for the Logs and Monitoring clients. Signing keys come from FCloudWatchSigningKeyCache, so both
+* clients and every worker thread share one derivation per day instead of serializing on the lock inside each
+* client's AWSAuthV4Signer. The signing name is taken from the endpoint, so one signer serves both services.
+* The canonical request is fed straight into an incremental SHA-256 and the remaining strings live in per-thread
+* scratch buffers, so signing doesn't allocate beyond what HttpRequest's own interface requires. The credentials and
+* the formatted time are fetched once per second and thread. The time is corrected by the clock skew estimated from
+* the responses' Date headers.
+**/
+class CLOUDWATCHSDK_API FCloudWatchSigV4Signer : public Aws::Client::AWSAuthSigner
+{
+public:
+	/**
+	* public FCloudWatchSigV4Signer::FCloudWatchSigV4Signer
+	* @param InCredentialsProvider [const std::shared_ptr<AWSCredentialsProvider>&] Credentials requests are signed with.
+	* @param InRegion [const Aws::String&] Signing region.
+	* @param bInCorrectClockSkew [bool] Sign with the service's time as estimated from responses instead of the local clock.
+	**/
+	FCloudWatchSigV4Signer(const std::shared_ptr<Aws::Auth::AWSCredentialsProvider>& InCredentialsProvider, const Aws::String& InRegion, bool bInCorrectClockSkew = true);
+
+	using Aws::Client::AWSAuthSigner::SignRequest;
+	bool SignRequest(Aws::Http::HttpRequest& Request) const override;
+
+	// presigned urls aren't used by the plugin
+	bool PresignRequest(Aws::Http::HttpRequest& Request, long long ExpirationInSeconds) const override { return false; }
+	bool PresignRequest(Aws::Http::HttpRequest& Request, const char* InRegion, long long ExpirationInSeconds = 0) const override { return false; }
+	bool PresignRequest(Aws::Http::HttpRequest& Request, const char* InRegion, const char* ServiceName, long long ExpirationInSeconds = 0) const override { return false; }
+
+	const char* GetName() const override { return Aws::Auth::SIGV4_SIGNER; }
+
+	/** Local time plus the estimated clock skew. */
+	Aws::Utils::DateTime GetSigningTimestamp() const override { return Aws::Utils::DateTime(GetSigningMillis()); }
+
+	/**
+	* public FCloudWatchSigV4Signer::ObserveResponse
+	* Feeds the response's Date header to the clock skew estimate, if a sample is due. Cheap otherwise.
+	**/
+	void ObserveResponse(const Aws::Http::HttpResponse& Response);
+
+	FCloudWatchClockSkewStats GetClockSkewStats() const { return ClockSkew.GetStats(); }
+
+private:
+	// what every request signed in the same second shares
+	struct FSigningContext
+	{
+		Aws::Auth::AWSCredentials Credentials;
+		int64 Second = -1;
+		char Timestamp[17];
+		Aws::String Date;
+	};
+
+	int64 GetSigningMillis() const;
+
+	/** Fetches the credentials and formats the time. False if there are no credentials. */
+	bool BeginSigning(FSigningContext& Context) const;
+	void SignWithContext(Aws::Http::HttpRequest& Request, const FSigningContext& Context) const;
+
+	/** "logs" for CloudWatch Logs, "monitoring" for CloudWatch. */
+	static const Aws::String& GetServiceName(const Aws::Http::HttpRequest& Request);
+
+	std::shared_ptr<Aws::Auth::AWSCredentialsProvider> CredentialsProvider;
+	const Aws::String Region;
+	// tells the per-thread contexts of different signers apart
+	const uint64 SignerId;
+	const bool bCorrectClockSkew;
+	FCloudWatchClockSkewEstimator ClockSkew;
+};
+
+/**
+* Signs every request right before handing it to the wrapped http client. Installed by FCloudWatchHttpClientFactory
+* once a signer is set, with the service clients themselves on anonymous credentials so the SDK skips its own signing.
+* Request processing disabled on the wrapper reaches the wrapped client with its next request, and a wrapped curl
+* client checks the wrapper for its transfers in flight.
+**/
+class CLOUDWATCHSDK_API FCloudWatchSigningHttpClient : public Aws::Http::HttpClient
+{
+public:
+	FCloudWatchSigningHttpClient(const std::shared_ptr<Aws::Http::HttpClient>& InClient, const std::shared_ptr<FCloudWatchSigV4Signer>& InSigner);
+
+	std::shared_ptr<Aws::Http::HttpResponse> MakeRequest(Aws::Http::HttpRequest& Request, Aws::Utils::RateLimits::RateLimiterInterface* ReadLimiter = nullptr,
+		Aws::Utils::RateLimits::RateLimiterInterface* WriteLimiter = nullptr) const override;
+
+	std::shared_ptr<Aws::Http::HttpResponse> MakeRequest(const std::shared_ptr<Aws::Http::HttpRequest>& Request, Aws::Utils::RateLimits::RateLimiterInterface* ReadLimiter = nullptr,
+		Aws::Utils::RateLimits::RateLimiterInterface* WriteLimiter = nullptr) const override;
+
+	bool SupportsChunkedTransferEncoding() const override { return Client->SupportsChunkedTransferEncoding(); }
+
+private:
+	std::shared_ptr<Aws::Http::HttpResponse> CreateSigningFailure(const std::shared_ptr<const Aws::Http::HttpRequest>& Request) const;
+
+	std::shared_ptr<Aws::Http::HttpClient> Client;
+	std::shared_ptr<FCloudWatchSigV4Signer> Signer;
+};
@@ -0,0 +1,131 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <aws/core/utils/memory/stl/AWSString.h>
+#include <aws/core/utils/memory/stl/AWSVector.h>
+
+#include <atomic>
+#include <mutex>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+/** SigV4 signing key, HMAC-SHA256 of the scope under the secret key. */
+struct CLOUDWATCHSDK_API FCloudWatchSigningKey
+{
+	uint8 Bytes[32];
+};
+
+/** Lookups of the signing key cache that got past the calling thread's own entries. */
+struct CLOUDWATCHSDK_API FCloudWatchSigningKeyCacheStats
+{
+	/** Keys found in the shared snapshot. */
+	uint64 SharedHits = 0;
+	/** Keys derived because no thread had them yet. */
+	uint64 Derivations = 0;
+	int32 Keys = 0;
+};
+
+/**
+* Process wide cache of SigV4 signing keys keyed by secret, date, region and service.
+* A key only changes when the date or the credentials do, yet deriving it takes four HMACs. Every thread keeps its
+* last few keys in thread local slots, so the common lookup touches no shared memory at all. Past that, threads
+* read an immutable snapshot published through an atomic pointer, read-copy-update style: readers never lock and
+* announce the snapshot they read in a hazard pointer of their own, and the rare writer copies the snapshot, adds
+* its key, swaps the pointer and frees the replaced snapshots no hazard points at.
+* Every publish starts a new generation, threads wipe the secrets in their slots when they see one.
+**/
+class CLOUDWATCHSDK_API FCloudWatchSigningKeyCache
+{
+public:
+	static FCloudWatchSigningKeyCache& Get();
+	~FCloudWatchSigningKeyCache();
+
+	/**
+	* public FCloudWatchSigningKeyCache::GetKey
+	* @param SecretKey [const Aws::String&] Secret access key.
+	* @param Date [const Aws::String&] Signing date as YYYYMMDD.
+	* @param Region [const Aws::String&] Signing region.
+	* @param Service [const Aws::String&] Signing name of the service, e.g. "logs" or "monitoring".
+	* @return [FCloudWatchSigningKey] The key, derived on the first lookup of the scope.
+	**/
+	FCloudWatchSigningKey GetKey(const Aws::String& SecretKey, const Aws::String& Date, const Aws::String& Region, const Aws::String& Service);
+
+	FCloudWatchSigningKeyCacheStats GetStats() const;
+
+	/** Derives the key without the cache. */
+	static FCloudWatchSigningKey DeriveKey(const Aws::String& SecretKey, const Aws::String& Date, const Aws::String& Region, const Aws::String& Service);
+
+private:
+	struct FEntry
+	{
+		Aws::String SecretKey;
+		Aws::String Date;
+		Aws::String Region;
+		Aws::String Service;
+		FCloudWatchSigningKey Key;
+
+		bool Matches(const Aws::String& InSecretKey, const Aws::String& InDate, const Aws::String& InRegion, const Aws::String& InService) const
+		{
+			// the date changes first, the secret is the longest compare
+			return Date == InDate && Service == InService && Region == InRegion && SecretKey == InSecretKey;
+		}
+	};
+
+	struct FSnapshot
+	{
+		Aws::Vector<FEntry> Entries;
+	};
+
+	/** A thread's hazard pointer, padded so two threads' readers never share a cache line. Never freed while the cache lives, reused once its thread exits. */
+	struct FReader
+	{
+		std::atomic<const FSnapshot*> Hazard;
+		std::atomic<bool> bInUse;
+		std::atomic<uint64> SharedHits;
+		FReader* Next = nullptr;
+		uint8 Padding[64];
+
+		FReader() : Hazard(nullptr), bInUse(true), SharedHits(0) {}
+	};
+
+	struct FThreadState;
+
+	FCloudWatchSigningKeyCache();
+	FThreadState& GetThreadState() const;
+	FReader* AcquireReader() const;
+	const FSnapshot* Protect(FReader& Reader) const;
+	bool FindShared(FReader& Reader, const Aws::String& SecretKey, const Aws::String& Date, const Aws::String& Region, const Aws::String& Service, FCloudWatchSigningKey& OutKey) const;
+	void Publish(FEntry&& Entry);
+	static void Wipe(FEntry& Entry);
+
+	std::atomic<const FSnapshot*> Current;
+	// bumped by every publish
+	std::atomic<uint32> Generation;
+	// every thread's reader, the list only grows
+	mutable std::atomic<FReader*> Readers;
+
+	std::mutex WriteLock;
+	Aws::Vector<const FSnapshot*> Retired;
+
+	std::atomic<uint64> Derivations;
+};
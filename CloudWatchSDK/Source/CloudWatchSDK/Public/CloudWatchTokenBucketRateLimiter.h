@@ -0,0 +1,56 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+#endif
+
+#include <aws/core/utils/ratelimiter/RateLimiterInterface.h>
+
+#include <atomic>
+
+#if PLATFORM_WINDOWS
+	#include "HideWindowsPlatformTypes.h"
+#endif
+
+/**
+* Lock-free token bucket with the same semantics as Aws::Utils::RateLimits::DefaultRateLimiter:
+* the bucket holds at most one second worth of rate, a call is delayed only by the debt of previous calls
+* and then pays for its own cost.
+* The bucket is kept as a single "theoretical arrival time" (GCRA) so every call is one compare-and-swap.
+**/
+class CLOUDWATCHSDK_API FCloudWatchTokenBucketRateLimiter : public Aws::Utils::RateLimits::RateLimiterInterface
+{
+public:
+	/**
+	* public FCloudWatchTokenBucketRateLimiter::FCloudWatchTokenBucketRateLimiter
+	* @param MaxRate [int64] Units (usually bytes) allowed per second.
+	**/
+	explicit FCloudWatchTokenBucketRateLimiter(int64 MaxRate);
+
+	DelayType ApplyCost(int64_t Cost) override;
+	void ApplyAndPayForCost(int64_t Cost) override;
+	void SetRate(int64_t Rate, bool bResetAccumulator = false) override;
+
+private:
+	static int64 NowNs();
+
+	/** Time in ns at which the bucket is back to zero; a bucket full at "now" has this one second in the past. */
+	std::atomic<int64> TheoreticalArrivalNs;
+	/** Current rate in units per second. */
+	std::atomic<int64> Rate;
+};
@@ -0,0 +1,69 @@
+// AMAZON CONFIDENTIAL
+
+/*
+* All or portions of this file Copyright (c) Amazon.com, Inc. or its affiliates or
+* its licensors.
+*
+* For complete copyright and license terms please see the LICENSE at the root of this
+* distribution (the "License"). All use of this software is governed by the License,
+* or, if provided, by the license below or the license accompanying this file. Do not
+* remove or modify any license notices. This file is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*
+*/
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CloudWatchAsyncLogSystem.h"
+
+#include <atomic>
+#include <memory>
+
+class ULogsCustomEventObject;
+
+/**
+* Routes the SDK's internal logging into the plugin's LogCloudWatchSDK category and, optionally, into a ULogsCustomEventObject.
+* Worker threads only write into the ring of FCloudWatchAsyncLogSystem; UE_LOG is called from the writer thread alone
+* and forwarded lines are handed to the game thread once per batch.
+**/
+class CLOUDWATCHSDK_API FCloudWatchUELogSystem : public FCloudWatchAsyncLogSystem
+{
+public:
+	FCloudWatchUELogSystem(Aws::Utils::Logging::LogLevel InLevel, int32 Capacity = 8192);
+	virtual ~FCloudWatchUELogSystem();
+
+	/**
+	* public FCloudWatchUELogSystem::SetForwardTarget
+	* Call it on the game thread, where the forwarded lines are delivered.
+	* @param Target [ULogsCustomEventObject*] Object receiving SDK log lines. nullptr stops forwarding.
+	* @param MinLevel [LogLevel] Only records at this level or more severe are forwarded. Keep it above Info, the upload itself logs at Info and below.
+	**/
+	void SetForwardTarget(ULogsCustomEventObject* Target, Aws::Utils::Logging::LogLevel MinLevel);
+
+	/**
+	* public static FCloudWatchUELogSystem::ClearForwardTarget
+	* Stops forwarding to Target in every log system, lines already handed to the game thread included. Called by ~ULogsCustomEventObject.
+	**/
+	static void ClearForwardTarget(ULogsCustomEventObject* Target);
+
+protected:
+	void WriteRecord(const FCloudWatchLogRecord& Record) override;
+	void EndBatch() override;
+
+private:
+	/** Shared with the game thread tasks delivering forwarded lines, which may run after the log system is gone. */
+	struct FForwardState
+	{
+		std::atomic<ULogsCustomEventObject*> Target;
+		std::atomic<Aws::Utils::Logging::LogLevel> Level;
+		/** Forwarded lines dropped because the target's backlog was full. */
+		std::atomic<uint64> Dropped;
+	};
+
+	std::shared_ptr<FForwardState> Forward;
+
+	/** Lines collected on the writer thread during the current batch. */
+	TArray<FString> PendingForward;
+	uint64 ReportedDropped = 0;
+	uint64 ReportedForwardDropped = 0;
+};